@@ -0,0 +1,71 @@
+#ifndef __bench_support_hpp__
+#define __bench_support_hpp__
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+#include "frame_corpus.hpp"
+#include "nlohmann/json.hpp"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+constexpr const char *DataPath = "./data/";
+constexpr const char *ConfigFile = "bench_config.yml";
+// checked in, refresh from a datasource.capture_file recording
+constexpr const char *FrameCorpus = "firehose_frames.bin";
+constexpr const char *RuleFile = "synthetic_filters";
+
+// Count of global operator new calls, process-wide
+uint64_t allocations();
+
+// Publishes allocations per iteration as a benchmark counter. Construct
+// before the timing loop, destroy after it.
+class allocation_counter {
+public:
+  explicit allocation_counter(benchmark::State &state);
+  ~allocation_counter();
+
+private:
+  benchmark::State &_state;
+  uint64_t _start;
+};
+
+// Load config, rules and metrics once, in the shape the live client uses
+// but without starting any worker threads. Downstream sinks are stubbed, see
+// sink_stubs.cpp.
+void prepare_environment();
+
+// Raw frames as read from the websocket
+corpus::frames const &frames();
+// "blocks" CAR field from #commit frames
+std::vector<nlohmann::json::binary_t> const &commit_blocks();
+// Decoded records from commit CARs that would be presented to the matcher
+std::vector<nlohmann::json> const &matchable_records();
+// Text fields from matchable records, for canonical form and matching
+std::vector<std::string> const &candidate_text();
+// "time" field from every frame
+std::vector<std::string> const &message_times();
+// ops[].cid from #commit frames, binary with the leading zero
+std::vector<nlohmann::json::binary_t> const &op_cids();
+
+} // namespace bench
+#endif
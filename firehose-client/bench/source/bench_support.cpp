@@ -0,0 +1,162 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "bench_support.hpp"
+#include "common/config.hpp"
+#include "common/log_wrapper.hpp"
+#include "common/metrics_factory.hpp"
+#include "datasource.hpp"
+#include "matcher.hpp"
+#include "parser.hpp"
+#include "payload.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <spdlog/sinks/null_sink.h>
+
+namespace {
+std::atomic<uint64_t> allocation_count(0);
+}
+
+// Count every heap allocation in the process. Array forms route through these
+// in the standard library default implementations, over-aligned forms do not.
+void *operator new(std::size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void *allocated = std::malloc(size == 0 ? 1 : size))
+    return allocated;
+  throw std::bad_alloc();
+}
+void operator delete(void *allocated) noexcept { std::free(allocated); }
+void operator delete(void *allocated, std::size_t) noexcept {
+  std::free(allocated);
+}
+
+namespace bench {
+
+uint64_t allocations() {
+  return allocation_count.load(std::memory_order_relaxed);
+}
+
+allocation_counter::allocation_counter(benchmark::State &state)
+    : _state(state), _start(allocations()) {}
+
+allocation_counter::~allocation_counter() {
+  _state.counters["allocs/op"] =
+      benchmark::Counter(static_cast<double>(allocations() - _start),
+                         benchmark::Counter::kAvgIterations);
+}
+
+namespace {
+struct decoded_corpus {
+  corpus::frames _frames;
+  std::vector<nlohmann::json::binary_t> _commit_blocks;
+  std::vector<nlohmann::json> _matchable_records;
+  std::vector<std::string> _candidate_text;
+  std::vector<std::string> _message_times;
+  std::vector<nlohmann::json::binary_t> _op_cids;
+};
+
+decoded_corpus &decoded() {
+  static decoded_corpus corpus_data;
+  return corpus_data;
+}
+
+void decode_corpus() {
+  decoded_corpus &result(decoded());
+  result._frames = corpus::load_frames(std::string(DataPath) + FrameCorpus);
+  for (auto const &frame : result._frames) {
+    parser frame_parser;
+    if (!frame_parser.json_from_cbor(frame.cbegin(), frame.cend()) ||
+        frame_parser.other_cbors().size() != 2) {
+      throw std::runtime_error("Malformed frame in benchmark corpus");
+    }
+    auto const &header(frame_parser.other_cbors().front().second);
+    auto const &message(frame_parser.other_cbors().back().second);
+    if (message.contains("time")) {
+      result._message_times.emplace_back(
+          message["time"].template get<std::string>());
+    }
+    if (header["t"].template get<std::string>() != firehose::OpTypeCommit)
+      continue;
+    for (auto const &oper : message["ops"]) {
+      if (oper.contains("cid") && !oper["cid"].is_null()) {
+        result._op_cids.emplace_back(
+            oper["cid"].template get<nlohmann::json::binary_t>());
+      }
+    }
+    if (!message.contains("blocks"))
+      continue;
+    auto blocks(message["blocks"].template get<nlohmann::json::binary_t>());
+    parser block_parser;
+    if (block_parser.json_from_car(blocks.cbegin(), blocks.cend())) {
+      for (auto const &matchable : block_parser.matchable_cbors()) {
+        result._matchable_records.push_back(matchable.second);
+        for (auto const &next :
+             parser::get_candidates_from_record(matchable.second)) {
+          result._candidate_text.push_back(next._value);
+        }
+      }
+    }
+    result._commit_blocks.emplace_back(std::move(blocks));
+  }
+}
+} // namespace
+
+void prepare_environment() {
+  static std::once_flag prepared;
+  std::call_once(prepared, [] {
+    // library code in common logs unconditionally, give it somewhere to go
+    logger = spdlog::null_logger_mt("firehose_client_bench");
+    std::shared_ptr<config> settings(
+        std::make_shared<config>(std::string(DataPath) + ConfigFile));
+    parser::set_config(settings);
+
+    datasource<firehose_payload>::register_metrics();
+    metrics_factory::instance().add_gauge("process_operation",
+                                          "Statistics about process internals");
+    metrics_factory::instance().add_counter(
+        "realtime_alerts", "Alerts generated for possibly suspect activity");
+    matcher::shared().load_filter_file(std::string(DataPath) + RuleFile);
+
+    decode_corpus();
+  });
+}
+
+corpus::frames const &frames() { return decoded()._frames; }
+std::vector<nlohmann::json::binary_t> const &commit_blocks() {
+  return decoded()._commit_blocks;
+}
+std::vector<nlohmann::json> const &matchable_records() {
+  return decoded()._matchable_records;
+}
+std::vector<std::string> const &candidate_text() {
+  return decoded()._candidate_text;
+}
+std::vector<std::string> const &message_times() {
+  return decoded()._message_times;
+}
+std::vector<nlohmann::json::binary_t> const &op_cids() {
+  return decoded()._op_cids;
+}
+
+} // namespace bench
+
+BENCHMARK_MAIN();
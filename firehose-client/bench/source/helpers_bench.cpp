@@ -0,0 +1,96 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "bench_support.hpp"
+#include "common/bluesky/platform.hpp"
+#include "common/helpers.hpp"
+
+static void BM_ToCanonical(benchmark::State &state) {
+  bench::prepare_environment();
+  auto const &text(bench::candidate_text());
+  size_t next(0);
+  size_t bytes(0);
+  {
+    bench::allocation_counter allocs(state);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(to_canonical(text[next]));
+      bytes += text[next].size();
+      next = (next + 1) % text.size();
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_ToCanonical);
+
+static void BM_TimeStampFromIso8601(benchmark::State &state) {
+  bench::prepare_environment();
+  auto const &times(bench::message_times());
+  size_t next(0);
+  bench::allocation_counter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bsky::time_stamp_from_iso_8601(times[next]));
+    next = (next + 1) % times.size();
+  }
+}
+BENCHMARK(BM_TimeStampFromIso8601);
+
+// std::chrono::parse fallback, the baseline for the fixed-format fast path
+static void BM_TimeStampFromIso8601Permissive(benchmark::State &state) {
+  bench::prepare_environment();
+  auto const &times(bench::message_times());
+  size_t next(0);
+  bench::allocation_counter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        bsky::time_stamp_from_iso_8601_permissive(times[next]));
+    next = (next + 1) % times.size();
+  }
+}
+BENCHMARK(BM_TimeStampFromIso8601Permissive);
+
+static void BM_CidDecoder(benchmark::State &state) {
+  bench::prepare_environment();
+  auto const &cids(bench::op_cids());
+  size_t next(0);
+  bench::allocation_counter allocs(state);
+  for (auto _ : state) {
+    auto const &cid(cids[next]);
+    // nlohmann parser gives us a leading zero
+    atproto::cid_decoder decoder(cid.cbegin() + 1, cid.cend());
+    benchmark::DoNotOptimize(decoder.as_string());
+    next = (next + 1) % cids.size();
+  }
+}
+BENCHMARK(BM_CidDecoder);
+
+// binary form as used for path lookup on the hot path, no string conversion
+static void BM_BinaryCid(benchmark::State &state) {
+  bench::prepare_environment();
+  auto const &cids(bench::op_cids());
+  size_t next(0);
+  bench::allocation_counter allocs(state);
+  for (auto _ : state) {
+    auto const &cid(cids[next]);
+    atproto::binary_cid decoded(cid.cbegin() + 1, cid.cend());
+    benchmark::DoNotOptimize(atproto::binary_cid_hash()(decoded));
+    next = (next + 1) % cids.size();
+  }
+}
+BENCHMARK(BM_BinaryCid);
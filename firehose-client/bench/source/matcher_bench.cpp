@@ -0,0 +1,51 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "bench_support.hpp"
+#include "matcher.hpp"
+#include "parser.hpp"
+
+// Candidate lists as the post-processor builds them from commit records,
+// matched against the full synthetic rule set
+static void BM_AllMatchesForPathCandidates(benchmark::State &state) {
+  bench::prepare_environment();
+  std::vector<path_candidate_list> inputs;
+  size_t index(0);
+  for (auto const &record : bench::matchable_records()) {
+    std::string path("app.bsky.feed.post/" + std::to_string(index++));
+    inputs.push_back(
+        {{path, "bafy", parser::get_candidates_from_record(record)}});
+  }
+  size_t next(0);
+  size_t matched(0);
+  {
+    bench::allocation_counter allocs(state);
+    for (auto _ : state) {
+      auto results(matcher::shared().all_matches_for_path_candidates(
+          inputs[next]));
+      matched += results.size();
+      benchmark::DoNotOptimize(results);
+      next = (next + 1) % inputs.size();
+    }
+  }
+  state.counters["match_rate"] = benchmark::Counter(
+      static_cast<double>(matched), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_AllMatchesForPathCandidates);
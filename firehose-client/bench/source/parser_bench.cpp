@@ -0,0 +1,138 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "bench_support.hpp"
+#include "parser.hpp"
+
+// Outer frame decode: header and message CBORs, as done on the websocket
+// thread for every frame
+static void BM_JsonFromCbor(benchmark::State &state) {
+  bench::prepare_environment();
+  auto const &frames(bench::frames());
+  size_t next(0);
+  size_t bytes(0);
+  {
+    bench::allocation_counter allocs(state);
+    for (auto _ : state) {
+      auto const &frame(frames[next]);
+      parser frame_parser;
+      benchmark::DoNotOptimize(
+          frame_parser.json_from_cbor(frame.cbegin(), frame.cend()));
+      bytes += frame.size();
+      next = (next + 1) % frames.size();
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_JsonFromCbor);
+
+// Nested CAR decode of commit blocks, on the post-processor thread
+static void BM_JsonFromCar(benchmark::State &state) {
+  bench::prepare_environment();
+  auto const &blocks(bench::commit_blocks());
+  size_t next(0);
+  size_t bytes(0);
+  {
+    bench::allocation_counter allocs(state);
+    for (auto _ : state) {
+      auto const &car(blocks[next]);
+      parser block_parser;
+      benchmark::DoNotOptimize(
+          block_parser.json_from_car(car.cbegin(), car.cend()));
+      bytes += car.size();
+      next = (next + 1) % blocks.size();
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_JsonFromCar);
+
+static void BM_CandidatesFromRecord(benchmark::State &state) {
+  bench::prepare_environment();
+  auto const &records(bench::matchable_records());
+  size_t next(0);
+  bench::allocation_counter allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        parser::get_candidates_from_record(records[next]));
+    next = (next + 1) % records.size();
+  }
+}
+BENCHMARK(BM_CandidatesFromRecord);
+
+// Jetstream frames equivalent to the corpus records, on-demand extraction
+// versus the full DOM
+static std::vector<std::string> const &jetstream_frames() {
+  static const std::vector<std::string> frames([]() {
+    std::vector<std::string> result;
+    for (auto const &record : bench::matchable_records()) {
+      nlohmann::json frame(
+          {{"did", "did:plc:bench"},
+           {"time_us", 0},
+           {"kind", "commit"},
+           {"commit",
+            {{"rev", "bench"},
+             {"operation", "create"},
+             {"collection", record["$type"]},
+             {"rkey", "bench"},
+             {"record", record}}}});
+      result.push_back(frame.dump());
+    }
+    return result;
+  }());
+  return frames;
+}
+
+static void BM_CandidatesFromJetstream(benchmark::State &state) {
+  bench::prepare_environment();
+  auto const &frames(jetstream_frames());
+  size_t next(0);
+  size_t bytes(0);
+  {
+    bench::allocation_counter allocs(state);
+    for (auto _ : state) {
+      auto const &frame(frames[next]);
+      benchmark::DoNotOptimize(
+          parser::get_candidates_from_jetstream(frame.data(), frame.size()));
+      bytes += frame.size();
+      next = (next + 1) % frames.size();
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_CandidatesFromJetstream);
+
+static void BM_CandidatesFromJetstreamDom(benchmark::State &state) {
+  bench::prepare_environment();
+  auto const &frames(jetstream_frames());
+  size_t next(0);
+  size_t bytes(0);
+  {
+    bench::allocation_counter allocs(state);
+    for (auto _ : state) {
+      auto const &frame(frames[next]);
+      benchmark::DoNotOptimize(parser().get_candidates_from_string(frame));
+      bytes += frame.size();
+      next = (next + 1) % frames.size();
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_CandidatesFromJetstreamDom);
@@ -0,0 +1,53 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "bench_support.hpp"
+#include "parser.hpp"
+#include "payload.hpp"
+#include "post_processor.hpp"
+
+// Full per-frame path: outer decode on the websocket thread, then
+// firehose_payload::handle as run on the post-processor thread. Downstream
+// sinks are stubbed, so their hand-off call is included but their queueing
+// and processing are not.
+static void BM_FirehosePayloadHandle(benchmark::State &state) {
+  bench::prepare_environment();
+  // thread exits at once, controller is not active. Never destroyed, like
+  // the live client's.
+  static post_processor<firehose_payload> *processor(
+      new post_processor<firehose_payload>);
+  auto const &frames(bench::frames());
+  beast::flat_buffer buffer;
+  size_t next(0);
+  bench::allocation_counter allocs(state);
+  for (auto _ : state) {
+    state.PauseTiming();
+    corpus::to_flat_buffer(frames[next], buffer);
+    state.ResumeTiming();
+    message_arena::handle arena(message_arena_pool::instance().acquire());
+    parser frame_parser(arena->resource());
+    frame_parser.get_candidates_from_flat_buffer(buffer);
+    firehose_payload payload(std::move(arena), frame_parser,
+                             pipeline::stage_timer::now());
+    payload.handle(*processor);
+    next = (next + 1) % frames.size();
+  }
+}
+BENCHMARK(BM_FirehosePayloadHandle);
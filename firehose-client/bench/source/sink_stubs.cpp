@@ -0,0 +1,83 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+// Downstream sinks for the benchmarks, linked in place of the real
+// action_router, embed_checker and event_recorder definitions. What
+// firehose_payload::handle hands off is dropped at once, so the hand-off
+// call is measured but queueing and processing are not, and nothing builds
+// up across iterations. async_loader is only reached through these.
+
+#include "common/activity/event_recorder.hpp"
+#include "moderation/action_router.hpp"
+#include "moderation/embed_checker.hpp"
+
+action_router &action_router::instance() {
+  static action_router my_instance;
+  return my_instance;
+}
+
+action_router::action_router() : _queue(QueueLimit) {}
+
+void action_router::wait_enqueue(account_filter_matches &&) {}
+
+namespace bsky {
+namespace moderation {
+
+embed_checker &embed_checker::instance() {
+  static embed_checker my_instance;
+  return my_instance;
+}
+
+embed_checker::embed_checker()
+    : _queue(QueueLimit), _observed_hosts(MaxHosts) {}
+
+void embed_checker::wait_enqueue(embed::embed_info_list &&) {}
+
+void embed_checker::refresh_hosts(std::unordered_set<std::string> &&) {}
+
+} // namespace moderation
+} // namespace bsky
+
+namespace activity {
+
+// no recording thread
+event_recorder::event_recorder() : _queue(MaxBacklog) {}
+
+void event_recorder::wait_enqueue(timed_event &&) {}
+
+std::string event_recorder::ensure_loaded(std::string const &did) {
+  return get_handle(did);
+}
+
+caches::WrappedValue<account>
+event_recorder::add_if_needed(std::string const &did) {
+  return _events.get_account(did);
+}
+
+void event_recorder::update_handle(std::string const &did,
+                                   std::string const &handle) {
+  add_if_needed(did)->get_statistics()._handle = handle;
+}
+
+std::string event_recorder::get_handle(std::string const &did) {
+  return add_if_needed(did)->get_statistics()._handle;
+}
+
+} // namespace activity
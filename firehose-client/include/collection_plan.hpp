@@ -0,0 +1,63 @@
+#ifndef __collection_plan_hpp__
+#define __collection_plan_hpp__
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "yaml-cpp/yaml.h"
+#include <map>
+#include <string>
+#include <string_view>
+
+namespace firehose {
+
+// How much of a CAR block to decode for an op, by collection.
+//   skip    - block bytes are stepped over, nothing is decoded
+//   minimal - only the top-level fields needed for activity recording
+//   full    - the whole record, required for string matching and embeds
+enum class decode_plan { skip, minimal, full };
+
+decode_plan decode_plan_from_string(std::string const &plan);
+std::string_view to_string(const decode_plan plan);
+
+// Decode plan per collection in commit op paths. Built-in defaults cover the
+// collections handle_content uses, optional config overrides them:
+//   collection_plan:
+//     default: skip
+//     collections:
+//       app.bsky.feed.like: skip
+class collection_plan {
+public:
+  static collection_plan &instance();
+  void set_config(YAML::Node const &settings);
+
+  decode_plan plan_for(std::string_view collection) const;
+  // top-level record fields retained for a minimal decode
+  static bool is_minimal_field(std::string_view field);
+
+private:
+  collection_plan();
+  ~collection_plan() = default;
+
+  std::map<std::string, decode_plan, std::less<>> _plans;
+  decode_plan _default = decode_plan::skip;
+};
+
+} // namespace firehose
+#endif
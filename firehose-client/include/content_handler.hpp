@@ -20,38 +20,90 @@ http://www.fsf.org/licensing/licenses
 >>> END OF LICENSE >>>
 *************************************************************************/
 
+#include "common/alloc_stats.hpp"
 #include "common/log_wrapper.hpp"
+#include "common/pipeline_timing.hpp"
+#include "frame_dedup.hpp"
 #include "matcher.hpp"
 #include "moderation/action_router.hpp"
 #include "moderation/embed_checker.hpp"
 #include "post_processor.hpp"
 #include <boost/beast/core.hpp>
+#include <charconv>
+#include <cstdint>
+#include <memory>
+#include <string_view>
 
 namespace beast = boost::beast; // from <boost/beast.hpp>
 
+// time_us of a Jetstream event, 0 if there is none. Jetstream writes did and
+// time_us ahead of the commit, so the first occurrence is the event's own.
+inline int64_t jetstream_time_us(beast::flat_buffer const &frame) {
+  constexpr std::string_view Field("\"time_us\":");
+  const std::string_view content(
+      static_cast<char const *>(frame.data().data()), frame.size());
+  const size_t found(content.find(Field));
+  if (found == std::string_view::npos)
+    return 0;
+  int64_t time_us(0);
+  std::from_chars(content.data() + found + Field.length(),
+                  content.data() + content.length(), time_us);
+  return time_us;
+}
+
 template <typename PAYLOAD> class content_handler {
 public:
   content_handler() = default;
   ~content_handler() = default;
 
-  void handle(beast::flat_buffer const &beast_data) {
+  // frames from more than one relay, drop repeats of the same event
+  void enable_dedup(const size_t window, prometheus::Counter &duplicates) {
+    _dedup = std::make_unique<frame_dedup>(window);
+    _duplicates = &duplicates;
+  }
+
+  // reads from the source pause while true, see post_processor::saturated
+  inline bool saturated() { return _post_processor.saturated(); }
+
+  // relay position of the last frame handled, firehose seq or Jetstream
+  // time_us, 0 if that frame had none
+  inline int64_t cursor() const { return _cursor; }
+  // position of a frame that was not handled
+  int64_t cursor_of(beast::flat_buffer const &beast_data) {
+    return jetstream_time_us(beast_data);
+  }
+
+  // False if the frame repeats one already handled. Only frames from the
+  // primary relay move the restart point.
+  bool handle(beast::flat_buffer const &beast_data,
+              [[maybe_unused]] const bool primary = true) {
+    alloc_stats::scope allocations(alloc_stats::stage::content_handler);
+    pipeline::ingest_time ingested(pipeline::stage_timer::now());
+    _cursor = jetstream_time_us(beast_data);
     auto matches(matcher::shared().find_all_matches(beast_data));
     // No match, or all eliminated by contingent match processing
     if (matches.empty()) {
-      return;
+      return true;
     }
     std::string json_msg(boost::beast::buffers_to_string(beast_data.data()));
 
-    _post_processor.wait_enqueue(PAYLOAD(json_msg, matches));
+    _post_processor.wait_enqueue(PAYLOAD(json_msg, matches, ingested));
+    return true;
   }
 
 private:
   post_processor<PAYLOAD> _post_processor;
+  std::unique_ptr<frame_dedup> _dedup;
+  prometheus::Counter *_duplicates = nullptr;
+  int64_t _cursor = 0;
 };
 
 class firehose_payload;
 template <>
-void content_handler<firehose_payload>::handle(
+int64_t content_handler<firehose_payload>::cursor_of(
     beast::flat_buffer const &beast_data);
+template <>
+bool content_handler<firehose_payload>::handle(
+    beast::flat_buffer const &beast_data, const bool primary);
 
 #endif
\ No newline at end of file
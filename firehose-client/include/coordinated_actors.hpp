@@ -0,0 +1,342 @@
+#ifndef __coordinated_actors_hpp__
+#define __coordinated_actors_hpp__
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "common/bluesky/platform.hpp"
+#include "common/pipeline_timing.hpp"
+#include "concurrentqueue.h"
+#include "near_duplicates.hpp"
+#include "readerwriterqueue.h"
+#include "yaml-cpp/yaml.h"
+#include <prometheus/counter.h>
+#include <prometheus/gauge.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace firehose {
+
+// a set of accounts that interacted with the same targets within the window
+struct coordinated_group {
+  size_t _targets = 0;
+  // accounts in the group, flagged or not
+  size_t _accounts = 0;
+  // one of the targets, for the log
+  std::string _sample_target;
+  // accounts not flagged before
+  std::vector<std::string> _flag;
+};
+
+// Rolling index from interaction target (post URI or followed account) to
+// the accounts that interacted with it, in time buckets. Whole buckets
+// expire once older than the window, and each bucket holds a fixed share of
+// max_interactions, so memory is bounded by the configuration.
+//
+// Mining groups targets whose actor sets are similar. Each target with at
+// least min_actors actors gets a MinHash signature of its actor set, and
+// LSH over Bands of Rows values finds candidate pairs. Pairs with at least
+// MinAgreement values in common are joined. A group of at least min_targets
+// targets is coordinated if at least min_actors accounts interacted with
+// min_targets of its targets.
+class interaction_index {
+public:
+  static constexpr size_t Rows = 2;
+  static constexpr size_t Bands = text_signature::Hashes / Rows;
+  // estimated Jaccard similarity of one half
+  static constexpr size_t MinAgreement = text_signature::Hashes / 2;
+  // bounds the comparisons per LSH bucket
+  static constexpr size_t MaxBucketTargets = 32;
+
+  interaction_index(const std::chrono::milliseconds window,
+                    const std::chrono::milliseconds bucket,
+                    const size_t max_interactions, const size_t min_actors,
+                    const size_t min_targets)
+      : _window(window), _bucket(bucket),
+        _max_buckets(std::max<size_t>(
+            1, static_cast<size_t>((window + bucket -
+                                    std::chrono::milliseconds(1)) /
+                                   bucket))),
+        _bucket_limit(std::max<size_t>(1, max_interactions / _max_buckets)),
+        _min_actors(min_actors), _min_targets(min_targets) {}
+
+  // Records an interaction. Returns true when it opened a new time bucket,
+  // the cue to mine the completed ones.
+  bool add(std::string const &actor, std::string const &target,
+           const bsky::time_stamp when) {
+    bool rolled(false);
+    if (_buckets.empty() || _buckets.back()._start + _bucket <= when) {
+      rolled = !_buckets.empty();
+      _buckets.emplace_back();
+      _buckets.back()._start = when;
+    }
+    while (_buckets.size() > _max_buckets ||
+           _buckets.front()._start + _bucket + _window <= when) {
+      _buckets.pop_front();
+    }
+    bucket &current(_buckets.back());
+    if (current._interactions >= _bucket_limit) {
+      ++_dropped;
+      return rolled;
+    }
+    ++current._interactions;
+    const uint64_t actor_id(std::hash<std::string>()(actor));
+    auto found(current._targets.find(std::hash<std::string>()(target)));
+    if (found == current._targets.end()) {
+      found = current._targets
+                  .emplace(std::hash<std::string>()(target),
+                           target_actors{target, {}})
+                  .first;
+    }
+    found->second._actors.push_back(actor_id);
+    current._actors.try_emplace(actor_id, actor);
+    return rolled;
+  }
+
+  // Groups of coordinated accounts with at least one account not flagged
+  // within the last window. Work is proportional to the interactions held.
+  std::vector<coordinated_group> mine(const bsky::time_stamp now) {
+    std::erase_if(_flagged_until,
+                  [now](auto const &entry) { return entry.second <= now; });
+
+    // actor set for each target over the window
+    std::unordered_map<uint64_t, merged_target> merged;
+    for (auto const &bucket : _buckets) {
+      for (auto const &target : bucket._targets) {
+        merged_target &entry(merged[target.first]);
+        entry._name = &target.second._target;
+        entry._actors.insert(entry._actors.end(),
+                             target.second._actors.cbegin(),
+                             target.second._actors.cend());
+      }
+    }
+    std::vector<merged_target *> busy;
+    for (auto &target : merged) {
+      auto &actors(target.second._actors);
+      std::sort(actors.begin(), actors.end());
+      actors.erase(std::unique(actors.begin(), actors.end()), actors.end());
+      if (actors.size() >= _min_actors) {
+        target.second._minhashes = signature(actors);
+        busy.push_back(&target.second);
+      }
+    }
+
+    // join targets with similar actor sets
+    std::vector<size_t> parent(busy.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    auto root = [&parent](size_t index) {
+      while (parent[index] != index) {
+        parent[index] = parent[parent[index]];
+        index = parent[index];
+      }
+      return index;
+    };
+    for (size_t band = 0; band < Bands; ++band) {
+      std::unordered_map<uint64_t, std::vector<size_t>> lsh_buckets;
+      for (size_t index = 0; index < busy.size(); ++index) {
+        auto const &hashes(busy[index]->_minhashes);
+        uint64_t key(band);
+        for (size_t row = 0; row < Rows; ++row) {
+          key = text_signature::mix(key ^ hashes[band * Rows + row]);
+        }
+        auto &members(lsh_buckets[key]);
+        for (auto const other : members) {
+          if (text_signature::agreement(hashes, busy[other]->_minhashes) >=
+              MinAgreement) {
+            parent[root(index)] = root(other);
+          }
+        }
+        if (members.size() < MaxBucketTargets)
+          members.push_back(index);
+      }
+    }
+    std::unordered_map<size_t, std::vector<size_t>> groups;
+    for (size_t index = 0; index < busy.size(); ++index) {
+      groups[root(index)].push_back(index);
+    }
+
+    std::vector<coordinated_group> result;
+    for (auto const &group : groups) {
+      if (group.second.size() < _min_targets)
+        continue;
+      std::unordered_map<uint64_t, size_t> hits;
+      for (auto const index : group.second) {
+        for (auto const actor : busy[index]->_actors) {
+          ++hits[actor];
+        }
+      }
+      coordinated_group found;
+      found._targets = group.second.size();
+      found._sample_target = *busy[group.second.front()]->_name;
+      std::vector<uint64_t> to_flag;
+      for (auto const &actor : hits) {
+        if (actor.second < _min_targets)
+          continue;
+        ++found._accounts;
+        if (!_flagged_until.contains(actor.first))
+          to_flag.push_back(actor.first);
+      }
+      if (found._accounts < _min_actors || to_flag.empty())
+        continue;
+      for (auto const actor : to_flag) {
+        _flagged_until[actor] = now + _window;
+        found._flag.push_back(name_of(actor));
+      }
+      result.push_back(std::move(found));
+    }
+    return result;
+  }
+
+  inline size_t buckets() const { return _buckets.size(); }
+  size_t interactions() const {
+    size_t total(0);
+    for (auto const &bucket : _buckets) {
+      total += bucket._interactions;
+    }
+    return total;
+  }
+  // interactions not recorded because their bucket was full
+  inline size_t dropped() const { return _dropped; }
+  inline size_t flagged() const { return _flagged_until.size(); }
+
+private:
+  struct target_actors {
+    std::string _target;
+    std::vector<uint64_t> _actors;
+  };
+  struct bucket {
+    bsky::time_stamp _start;
+    size_t _interactions = 0;
+    std::unordered_map<uint64_t, target_actors> _targets;
+    std::unordered_map<uint64_t, std::string> _actors;
+  };
+  struct merged_target {
+    std::string const *_name = nullptr;
+    std::vector<uint64_t> _actors;
+    text_signature::minhashes _minhashes;
+  };
+
+  static text_signature::minhashes
+  signature(std::vector<uint64_t> const &actors) {
+    text_signature::minhashes result;
+    result.fill(std::numeric_limits<uint32_t>::max());
+    for (auto const actor : actors) {
+      for (size_t index = 0; index < text_signature::Hashes; ++index) {
+        const uint32_t value(static_cast<uint32_t>(
+            text_signature::mix(actor + index * 0x9e3779b97f4a7c15ULL) >> 32));
+        result[index] = std::min(result[index], value);
+      }
+    }
+    return result;
+  }
+
+  std::string name_of(const uint64_t actor) const {
+    for (auto bucket = _buckets.crbegin(); bucket != _buckets.crend();
+         ++bucket) {
+      auto found(bucket->_actors.find(actor));
+      if (found != bucket->_actors.cend())
+        return found->second;
+    }
+    return {};
+  }
+
+  std::chrono::milliseconds _window;
+  std::chrono::milliseconds _bucket;
+  size_t _max_buckets;
+  size_t _bucket_limit;
+  size_t _min_actors;
+  size_t _min_targets;
+  std::deque<bucket> _buckets;
+  size_t _dropped = 0;
+  // accounts already flagged, not flagged again until the window passes
+  std::unordered_map<uint64_t, bsky::time_stamp> _flagged_until;
+};
+
+// Many accounts liking, reposting or following the same set of targets
+// within a short window, the shape of a brigade or engagement farm that
+// per-target counts in augment_account_event cannot see. Off until the
+// coordinated_actors config section sets it up.
+// Interactions are bucketed by the time of the frame that carried them, so
+// a backlog replayed after a restart keeps its original spacing. The index
+// is kept and mined on the detector's own thread, interactions that arrive
+// while its queue is full are dropped. Flagged accounts are recorded as
+// account alerts, and added to block_list if one is configured.
+// A partition worker sees only interactions by the accounts it owns, so
+// every account flagged is local. A group is found only if min_actors of
+// its members share one worker, see partition::router.
+class coordination_detector {
+public:
+  static constexpr size_t QueueLimit = 100000;
+
+  static coordination_detector &instance();
+  void set_config(YAML::Node const &settings);
+  void register_metrics();
+
+  // Called on the post-processor thread for each like, repost or follow.
+  // Returns the groups mined since the previous call.
+  std::vector<coordinated_group> interaction(std::string const &actor,
+                                             std::string const &target,
+                                             const bsky::time_stamp emitted_at,
+                                             pipeline::ingest_time ingested);
+
+private:
+  struct recorded_interaction {
+    std::string _actor;
+    std::string _target;
+    bsky::time_stamp _emitted_at;
+    pipeline::ingest_time _ingested;
+  };
+
+  coordination_detector() : _queue(QueueLimit) {}
+  ~coordination_detector();
+
+  // detector thread only
+  void record(recorded_interaction const &item);
+
+  std::unique_ptr<interaction_index> _index;
+  std::string _block_list;
+  moodycamel::BlockingReaderWriterQueue<recorded_interaction> _queue;
+  moodycamel::ConcurrentQueue<coordinated_group> _found;
+  std::thread _thread;
+  std::atomic<bool> _stopping = false;
+
+  prometheus::Counter *_recorded = nullptr;
+  prometheus::Counter *_dropped = nullptr;
+  prometheus::Counter *_groups = nullptr;
+  prometheus::Counter *_flagged = nullptr;
+  prometheus::Gauge *_interactions = nullptr;
+  prometheus::Gauge *_mine_ms = nullptr;
+  size_t _dropped_reported = 0;
+};
+
+} // namespace firehose
+
+#endif
@@ -21,22 +21,35 @@ http://www.fsf.org/licensing/licenses
 *************************************************************************/
 #include <boost/asio/spawn.hpp>
 #include <boost/asio/ssl.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/beast/websocket/ssl.hpp>
+#include <algorithm>
 #include <cstdlib>
 #include <functional>
 #include <iostream>
+#include <memory>
 #include <prometheus/counter.h>
+#include <prometheus/gauge.h>
+#include <prometheus/histogram.h>
+#include <random>
+#include <set>
 #include <string>
+#include <vector>
 
 #include "common/config.hpp"
 #include "common/controller.hpp"
 #include "common/log_wrapper.hpp"
 #include "common/metrics_factory.hpp"
 #include "content_handler.hpp"
+#include "fanout_server.hpp"
+#include "frame_corpus.hpp"
+#include "frame_dedup.hpp"
 #include "matcher.hpp"
+#include "partition.hpp"
 #include "project_defs.hpp"
+#include "zstd_decompressor.hpp"
 
 namespace beast = boost::beast;         // from <boost/beast.hpp>
 namespace http = beast::http;           // from <boost/beast/http.hpp>
@@ -45,11 +58,29 @@ namespace net = boost::asio;            // from <boost/asio.hpp>
 namespace ssl = boost::asio::ssl;       // from <boost/asio/ssl.hpp>
 using tcp = boost::asio::ip::tcp;       // from <boost/asio/ip/tcp.hpp>
 
+// one host, or a list of relays
+inline std::vector<std::string> datasource_hosts(config const &settings) {
+  auto const hosts(settings.get_config()[PROJECT_NAME]["datasource"]["hosts"]);
+  if (hosts.IsSequence())
+    return hosts.as<std::vector<std::string>>();
+  return {hosts.as<std::string>()};
+}
+
 inline bool is_full(config const &settings) {
   constexpr std::string_view jetstream = "jetstream";
-  return !settings.get_config()[PROJECT_NAME]["datasource"]["hosts"]
-              .as<std::string>()
-              .contains(jetstream);
+  return !datasource_hosts(settings).front().contains(jetstream);
+}
+
+// Jetstream subscriber-sourced message that replaces the collection filter
+// https://github.com/bluesky-social/jetstream#subscriber-sourced-messages
+inline std::string
+jetstream_options_update(std::set<std::string> const &collections) {
+  nlohmann::json update({{"type", "options_update"},
+                         {"payload",
+                          {{"wantedCollections", collections},
+                           {"wantedDids", nlohmann::json::array()},
+                           {"maxMessageSizeBytes", 0}}}});
+  return update.dump();
 }
 
 template <typename PAYLOAD> class datasource {
@@ -58,24 +89,91 @@ public:
     static datasource my_source;
     return my_source;
   }
-  datasource() {}
+  // With more than one relay, every relay is read concurrently:
+  //   concurrent - all frames are handled, repeats of an event are dropped
+  //   standby    - frames from the active relay only. A standby relay takes
+  //                over if the active one goes idle or the pipeline lags, and
+  //                replays its recent frames to fill the gap.
+  // Each relay resumes at its own last frame. The first relay is the primary,
+  // its seq is the restart point.
+  enum class relay_mode { concurrent, standby };
+
+  datasource() : _random(std::random_device()()) {}
   ~datasource() = default;
 
   void set_config(std::shared_ptr<config> &settings, const int64_t cursor) {
     _settings = settings;
-    _host = _settings->get_config()[PROJECT_NAME]["datasource"]["hosts"]
-                .as<std::string>();
+    for (auto const &host : datasource_hosts(*_settings)) {
+      _relays.emplace_back(std::make_unique<relay>(host));
+    }
+    if (_relays.size() > 1) {
+      if (!is_full(*_settings)) {
+        // Jetstream frames have no common identity across instances
+        REL_WARNING("Multiple relays not supported for Jetstream, using {}",
+                    _relays.front()->_host);
+        _relays.resize(1);
+      } else {
+        auto mode(_settings->get_config()[PROJECT_NAME]["datasource"]
+                                         ["relay_mode"]);
+        if (mode && mode.as<std::string>() == "standby") {
+          _relay_mode = relay_mode::standby;
+        } else if (mode && mode.as<std::string>() != "concurrent") {
+          throw std::invalid_argument("Invalid relay_mode " +
+                                      mode.as<std::string>());
+        }
+        auto window(_settings->get_config()[PROJECT_NAME]["datasource"]
+                                           ["dedup_window"]);
+        _dedup_window = window ? window.as<size_t>() : DefaultDedupWindow;
+        if (_relay_mode == relay_mode::standby) {
+          // replayed frames are only recognized while still in the window
+          for (auto &source : _relays) {
+            source->_held =
+                std::make_unique<held_frames>(StandbyHold, _dedup_window);
+          }
+        }
+        REL_INFO("{} relays, {} mode", _relays.size(),
+                 _relay_mode == relay_mode::standby ? "standby"
+                                                    : "concurrent");
+      }
+    }
     _port = _settings->get_config()[PROJECT_NAME]["datasource"]["port"]
                 .as<std::string>();
     _subscription =
         _settings->get_config()[PROJECT_NAME]["datasource"]["subscription"]
             .as<std::string>();
-    if (cursor != 0) {
-      _subscription.append(std::format("?cursor={}", cursor));
+    _initial_cursor = cursor;
+    // Jetstream only: wantedCollections follows the active rules
+    auto derive(_settings->get_config()[PROJECT_NAME]["datasource"]
+                                       ["derive_collections"]);
+    _derive_collections = derive && derive.as<bool>() && !is_full(*_settings);
+    // Jetstream only: zstd frames using the published dictionary
+    auto dictionary(_settings->get_config()[PROJECT_NAME]["datasource"]
+                                           ["compression_dictionary"]);
+    if (dictionary && !is_full(*_settings)) {
+      zstd_decompressor::register_metrics();
+      _decompressor = std::make_unique<zstd_decompressor>(
+          dictionary.as<std::string>(), _relays.front()->_host);
+      append_query("compress=true");
+      REL_INFO("Compressed subscription {}", _subscription);
+    }
+    // optional raw frame capture, for benchmark and replay corpus
+    auto capture(
+        _settings->get_config()[PROJECT_NAME]["datasource"]["capture_file"]);
+    if (capture) {
+      std::string capture_file(capture.as<std::string>());
+      _capture = std::make_unique<corpus::frame_writer>(capture_file);
+      REL_INFO("Capturing raw frames to {}", capture_file);
+    }
+    // optional local re-serving of frames to other consumers
+    auto fanout(_settings->get_config()[PROJECT_NAME]["fanout"]);
+    if (fanout) {
+      fanout_server::register_metrics();
+      _fanout = std::make_unique<fanout_server>(fanout);
     }
   }
 
-  void start() {
+  // once before start(), and by offline tools that drive the handlers
+  static void register_metrics() {
     metrics_factory::instance().add_counter("websocket_inbound_messages",
                                             "Number of inbound messages");
     metrics_factory::instance().add_counter("websocket_inbound_bytes",
@@ -108,20 +206,82 @@ public:
     metrics_factory::instance()
         .get_histogram("firehose_facets")
         .Add({{"facet", "total"}}, boundaries);
+    metrics_factory::instance().add_counter(
+        "websocket_reconnects", "Websocket reconnects after a disconnect");
+    metrics_factory::instance().add_counter(
+        "websocket_tls_handshakes", "TLS handshakes, full or resumed session");
+    metrics_factory::instance().add_histogram(
+        "websocket_gap", "Seconds without messages across a reconnect");
+    metrics_factory::instance().add_gauge(
+        "websocket_catch_up",
+        "Messages per second while catching up after a reconnect");
+    metrics_factory::instance().add_counter(
+        "websocket_relay_swaps", "Active relay changes in standby mode");
+    metrics_factory::instance().add_counter(
+        "websocket_read_paused",
+        "Milliseconds reads were paused for post-processor backlog");
+    metrics_factory::instance().add_counter(
+        "websocket_duplicate_messages",
+        "Repeats of an event already received from another relay");
+  }
+
+  void start() {
+    if (_dedup_window > 0) {
+      _handler.enable_dedup(_dedup_window,
+                            metrics_factory::instance()
+                                .get_counter("websocket_duplicate_messages")
+                                .Add({}));
+    }
+    if (partition::router::instance().get_role() == partition::role::worker) {
+      // frames for this partition arrive from the ingest process
+      _thread = std::thread([&, this] {
+        try {
+          partition::router::instance().serve(
+              [this](beast::flat_buffer const &frame) {
+                _handler.handle(frame);
+              },
+              [this]() { return _handler.saturated(); });
+        } catch (std::exception const &exc) {
+          REL_CRITICAL("partition worker exception {}", exc.what());
+        }
+        REL_INFO("datasource stopping");
+      });
+      return;
+    }
+    if (_fanout) {
+      _fanout->start();
+    }
+    for (auto &source : _relays) {
+      source->_reconnects = &metrics_factory::instance()
+                                 .get_counter("websocket_reconnects")
+                                 .Add({{"host", source->_host}});
+      source->_gap = &metrics_factory::instance()
+                          .get_histogram("websocket_gap")
+                          .Add({{"host", source->_host}}, GapBuckets);
+      source->_catch_up_rate = &metrics_factory::instance()
+                                    .get_gauge("websocket_catch_up")
+                                    .Add({{"host", source->_host}});
+      source->_paused = &metrics_factory::instance()
+                             .get_counter("websocket_read_paused")
+                             .Add({{"host", source->_host}});
+    }
     _thread = std::thread([&, this] {
-      REL_INFO("client startup for {}:{} at {}", _host, _port, _subscription);
       try {
-        while (controller::instance().is_active()) {
-          // The io_context is required for all I/O
-          net::io_context ioc;
+        // The io_context is required for all I/O. One thread serves all
+        // relays, so frames reach the handler in arrival order.
+        net::io_context ioc;
 
-          // The SSL context is required, and holds certificates
-          ssl::context ctx{ssl::context::tlsv12_client};
+        // The SSL context is required, and holds certificates. Kept across
+        // connections so that TLS sessions can be resumed.
+        ssl::context ctx{ssl::context::tlsv12_client};
 
+        for (size_t index = 0; index < _relays.size(); ++index) {
+          REL_INFO("client startup for {}:{} at {}", _relays[index]->_host,
+                   _port, _subscription);
           // Launch the asynchronous operation
           boost::asio::spawn(ioc,
-                             std::bind(&datasource::do_work, this,
-                                       std::ref(ioc), std::ref(ctx),
+                             std::bind(&datasource::run_relay, this,
+                                       std::ref(ioc), std::ref(ctx), index,
                                        std::placeholders::_1),
                              // on completion, spawn will call this function
                              [](std::exception_ptr ex) {
@@ -133,15 +293,11 @@ public:
                                if (ex)
                                  std::rethrow_exception(ex);
                              });
-
-          // Run the I/O service. The call will return when
-          // the socket is closed.
-          ioc.run();
-
-          // we should run forever unless killed. Try to reconnect in a little
-          // while.
-          std::this_thread::sleep_for(std::chrono::seconds(10));
         }
+
+        // Run the I/O service. The call will return when every relay
+        // connection has stopped.
+        ioc.run();
       } catch (std::exception const &exc) {
         REL_CRITICAL("datasource exception {}", exc.what());
       }
@@ -152,17 +308,315 @@ public:
   void wait_for_end_thread() { _thread.join(); }
 
 private:
-  // TODO support round robin if needed
-  std::string _host;
+  // connection to one relay, and its state across reconnects. Only touched
+  // on the datasource thread.
+  struct relay {
+    explicit relay(std::string const &host) : _host(host) {}
+    ~relay() {
+      if (_tls_session)
+        SSL_SESSION_free(_tls_session);
+    }
+    relay(relay const &) = delete;
+    relay &operator=(relay const &) = delete;
+
+    std::string _host;
+    size_t _attempt = 0;
+    SSL_SESSION *_tls_session = nullptr;
+    bool _received = false;
+    std::chrono::steady_clock::time_point _last_received;
+    // position of the last frame handled from this relay, where a reconnect
+    // resumes. Frames queued for the post-processor are not asked for again.
+    int64_t _cursor = 0;
+    // standby mode only, frames received while not the active relay
+    std::unique_ptr<held_frames> _held;
+    bool _catching_up = false;
+    std::chrono::steady_clock::time_point _catch_up_started;
+    size_t _catch_up_messages = 0;
+    prometheus::Counter *_reconnects = nullptr;
+    prometheus::Histogram *_gap = nullptr;
+    prometheus::Gauge *_catch_up_rate = nullptr;
+    prometheus::Counter *_paused = nullptr;
+  };
+
+  std::vector<std::unique_ptr<relay>> _relays;
+  relay_mode _relay_mode = relay_mode::concurrent;
+  size_t _active = 0;
+  std::chrono::steady_clock::time_point _last_swap;
   std::string _port;
   std::string _subscription;
   content_handler<PAYLOAD> _handler;
   std::shared_ptr<config> _settings;
   std::thread _thread;
   std::unique_ptr<datasource> _instance;
+  std::unique_ptr<corpus::frame_writer> _capture;
+  std::unique_ptr<zstd_decompressor> _decompressor;
+  std::unique_ptr<fanout_server> _fanout;
+  bool _derive_collections = false;
+  // frames from more than one relay are deduplicated, 0 if not
+  size_t _dedup_window = 0;
+
+  // reconnect backoff window doubles per failed attempt, up to the cap
+  static constexpr std::chrono::milliseconds ReconnectBaseDelay =
+      std::chrono::milliseconds(50);
+  static constexpr std::chrono::milliseconds ReconnectMaxDelay =
+      std::chrono::milliseconds(30000);
+  // catch-up is complete when firehose lag drops below this
+  static constexpr std::chrono::milliseconds CatchUpLag =
+      std::chrono::milliseconds(5000);
+  static inline const prometheus::Histogram::BucketBoundaries GapBuckets = {
+      0.1, 0.5, 1.0, 2.0, 5.0, 10.0, 30.0, 60.0, 300.0, 900.0};
+  // relay skew is seconds, commit rate is low thousands per second
+  static constexpr size_t DefaultDedupWindow = 65536;
+  // standby takes over from an active relay that is silent this long, well
+  // inside the websocket idle timeout
+  static constexpr std::chrono::milliseconds StandbyIdle =
+      std::chrono::milliseconds(10000);
+  // or when the pipeline falls this far behind
+  static constexpr std::chrono::milliseconds StandbyLag =
+      std::chrono::milliseconds(30000);
+  // lag takes a while to recover after a swap, do not flap
+  static constexpr std::chrono::milliseconds SwapHoldOff =
+      std::chrono::milliseconds(60000);
+  // standby frames kept for replay, covering the idle time before a swap
+  static constexpr std::chrono::milliseconds StandbyHold = StandbyIdle * 2;
+  // A paused read lets TCP flow control push back on the relay. Should the
+  // relay drop the connection meanwhile, the reconnect resumes at the last
+  // frame received.
+  static constexpr std::chrono::milliseconds LongReadPause =
+      std::chrono::milliseconds(20000);
+  static constexpr std::chrono::milliseconds ReadPausePoll =
+      std::chrono::milliseconds(10);
+  // filter file and rule generation checks for the Jetstream subscription
+  static constexpr std::chrono::milliseconds RulesCheckInterval =
+      std::chrono::milliseconds(10000);
+
+  int64_t _initial_cursor = 0;
+  std::mt19937_64 _random;
+
+  // random delay in the upper half of the backoff window, so that clients
+  // dropped together do not reconnect together
+  std::chrono::milliseconds reconnect_delay(const size_t attempt) {
+    const int64_t window(
+        std::min(ReconnectMaxDelay.count(),
+                 ReconnectBaseDelay.count() << std::min<size_t>(attempt, 20)));
+    std::uniform_int_distribution<int64_t> jitter(window / 2, window);
+    return std::chrono::milliseconds(jitter(_random));
+  }
+
+  // Relays number events independently, so each resumes at its own last
+  // frame. The initial cursor is a position in the primary relay's sequence,
+  // other relays start live.
+  int64_t resume_cursor(const size_t index) {
+    relay &source(*_relays[index]);
+    if (source._held && !source._held->empty()) {
+      // the newest frame held while standby is past the last one handled
+      const int64_t held(_handler.cursor_of(source._held->newest()));
+      if (held != 0) {
+        source._cursor = held;
+      }
+    }
+    if (source._cursor != 0)
+      return source._cursor;
+    return index == 0 ? _initial_cursor : 0;
+  }
+
+  // session tickets arrive after the handshake, so this is called once data
+  // is flowing
+  void remember_tls_session(relay &source, SSL *ssl) {
+    SSL_SESSION *session(SSL_get1_session(ssl));
+    if (!session)
+      return;
+    if (source._tls_session)
+      SSL_SESSION_free(source._tls_session);
+    source._tls_session = session;
+  }
+
+  // gap and catch-up metrics, on each message received
+  void on_received(relay &source) {
+    auto now(std::chrono::steady_clock::now());
+    if (!source._received) {
+      source._received = true;
+      if (source._last_received != std::chrono::steady_clock::time_point()) {
+        source._gap->Observe(
+            std::chrono::duration<double>(now - source._last_received)
+                .count());
+        source._catching_up = true;
+        source._catch_up_started = now;
+        source._catch_up_messages = 0;
+      }
+    }
+    source._last_received = now;
+    if (source._catching_up) {
+      ++source._catch_up_messages;
+      if (pipeline::stage_timer::instance().lag() < CatchUpLag) {
+        source._catching_up = false;
+        double elapsed(
+            std::chrono::duration<double>(now - source._catch_up_started)
+                .count());
+        if (elapsed > 0.0) {
+          source._catch_up_rate->Set(
+              static_cast<double>(source._catch_up_messages) / elapsed);
+        }
+        REL_INFO("{} caught up after {} messages in {:.3f}s", source._host,
+                 source._catch_up_messages, elapsed);
+      }
+    }
+  }
+
+  // standby mode: whether to handle a frame from this relay, taking over
+  // from the active relay if it has stalled
+  bool accept_from(const size_t index) {
+    if (_relay_mode != relay_mode::standby || index == _active)
+      return true;
+    auto now(std::chrono::steady_clock::now());
+    relay const &active(*_relays[_active]);
+    const bool idle(now - active._last_received > StandbyIdle);
+    const bool lagging(pipeline::stage_timer::instance().lag() > StandbyLag);
+    if (!(idle || lagging) || now - _last_swap < SwapHoldOff)
+      return false;
+    REL_WARNING("relay {} {}, switching to {}", active._host,
+                idle ? "idle" : "lagging", _relays[index]->_host);
+    metrics_factory::instance()
+        .get_counter("websocket_relay_swaps")
+        .Get({{"from", active._host}, {"to", _relays[index]->_host}})
+        .Increment();
+    _active = index;
+    _last_swap = now;
+    return true;
+  }
 
-  void do_work(net::io_context &ioc, ssl::context &ctx,
+  // hold off the next read until the post-processor backlog has drained
+  void pause_reads(net::io_context &ioc, relay &source,
+                   net::yield_context yield) {
+    auto started(std::chrono::steady_clock::now());
+    net::steady_timer poll(ioc);
+    beast::error_code ec;
+    bool warned(false);
+    while (_handler.saturated() && controller::instance().is_active()) {
+      if (!warned &&
+          std::chrono::steady_clock::now() - started >= LongReadPause) {
+        REL_WARNING("{} backlog not draining, reads still paused",
+                    source._host);
+        warned = true;
+      }
+      poll.expires_after(ReadPausePoll);
+      poll.async_wait(yield[ec]);
+    }
+    source._paused->Increment(static_cast<double>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - started)
+            .count()));
+  }
+
+  // connect, and reconnect with backoff, until stopped
+  void run_relay(net::io_context &ioc, ssl::context &ctx, const size_t index,
+                 net::yield_context yield) {
+    relay &source(*_relays[index]);
+    net::steady_timer backoff(ioc);
+    beast::error_code ec;
+    while (controller::instance().is_active()) {
+      source._received = false;
+      do_work(ioc, ctx, index, yield);
+
+      // we should run forever unless killed. Reconnect promptly at first,
+      // backing off if the host keeps failing.
+      if (!controller::instance().is_active())
+        break;
+      if (source._received)
+        source._attempt = 0;
+      std::chrono::milliseconds delay(reconnect_delay(source._attempt++));
+      REL_WARNING("{} reconnect attempt {} in {} ms", source._host,
+                  source._attempt, delay.count());
+      source._reconnects->Increment();
+      backoff.expires_after(delay);
+      backoff.async_wait(yield[ec]);
+    }
+  }
+
+  void append_query(std::string const &parameter) {
+    _subscription.append(_subscription.contains('?') ? "&" : "?");
+    _subscription.append(parameter);
+  }
+
+  // initial subscription, later changes go via options_update
+  std::string subscription_for(std::set<std::string> const &collections,
+                               const int64_t cursor) {
+    std::string target(_subscription);
+    if (cursor != 0) {
+      target.append(target.contains('?') ? "&" : "?");
+      target.append(std::format("cursor={}", cursor));
+    }
+    for (auto const &collection : collections) {
+      target.append(target.contains('?') ? "&" : "?");
+      target.append("wantedCollections=").append(collection);
+    }
+    return target;
+  }
+
+  // Rules can change while the server-side filter lets nothing through, so
+  // they are checked on a timer instead of per frame
+  struct collections_watch {
+    explicit collections_watch(net::io_context &ioc) : _timer(ioc) {}
+    net::steady_timer _timer;
+    bool _running = false;
+    bool _stopping = false;
+  };
+
+  // reload rules from file, and narrow or widen the subscription to match
+  template <typename STREAM>
+  void watch_collections(STREAM &ws, collections_watch &watch,
+                         std::set<std::string> collections,
+                         uint64_t rules_generation, net::yield_context yield) {
+    beast::error_code ec;
+    while (!watch._stopping && controller::instance().is_active()) {
+      watch._timer.expires_after(RulesCheckInterval);
+      watch._timer.async_wait(yield[ec]);
+      if (watch._stopping)
+        break;
+      matcher::shared().reload_if_changed();
+      if (rules_generation == matcher::shared().generation())
+        continue;
+      rules_generation = matcher::shared().generation();
+      std::set<std::string> latest(wanted_collections());
+      if (latest.empty() || latest == collections)
+        continue;
+      collections.swap(latest);
+      std::string update(jetstream_options_update(collections));
+      REL_INFO("options_update {}", update);
+      ws.text(true);
+      ws.async_write(net::buffer(update), yield[ec]);
+      if (ec) {
+        fail(ec, "options_update");
+        break;
+      }
+    }
+    watch._running = false;
+  }
+
+  void stop_watch(collections_watch &watch, net::io_context &ioc,
+                  net::yield_context yield) {
+    watch._stopping = true;
+    watch._timer.cancel();
+    net::steady_timer poll(ioc);
+    beast::error_code ec;
+    while (watch._running) {
+      poll.expires_after(ReadPausePoll);
+      poll.async_wait(yield[ec]);
+    }
+  }
+
+  // empty set would subscribe to everything, keep what we have instead
+  std::set<std::string> wanted_collections() const {
+    std::set<std::string> collections(matcher::shared().wanted_collections());
+    if (collections.empty()) {
+      REL_WARNING("No collections wanted by rules, subscription unchanged");
+    }
+    return collections;
+  }
+
+  void do_work(net::io_context &ioc, ssl::context &ctx, const size_t index,
                net::yield_context yield) {
+    relay &source(*_relays[index]);
     beast::error_code ec;
 
     // These objects perform our I/O
@@ -170,7 +624,7 @@ private:
     websocket::stream<ssl::stream<beast::tcp_stream>> ws(ioc, ctx);
 
     // Look up the domain name
-    auto const results = resolver.async_resolve(_host, _port, yield[ec]);
+    auto const results = resolver.async_resolve(source._host, _port, yield[ec]);
     if (ec)
       return fail(ec, "resolve");
 
@@ -184,7 +638,7 @@ private:
 
     // Set SNI Hostname (many hosts need this to handshake successfully)
     if (!SSL_set_tlsext_host_name(ws.next_layer().native_handle(),
-                                  _host.c_str())) {
+                                  source._host.c_str())) {
       ec = beast::error_code(static_cast<int>(::ERR_get_error()),
                              net::error::get_ssl_category());
       return fail(ec, "connect");
@@ -193,7 +647,7 @@ private:
     // Update the host string. This will provide the value of the
     // Host HTTP header during the WebSocket handshake.
     // See https://tools.ietf.org/html/rfc7230#section-5.4
-    auto host = _host + ':' + std::to_string(ep.port());
+    auto host = source._host + ':' + std::to_string(ep.port());
 
     // Set a timeout on the operation
     beast::get_lowest_layer(ws).expires_after(std::chrono::seconds(30));
@@ -206,10 +660,23 @@ private:
                       " websocket-client-coro");
         }));
 
+    // Offer the previous session to skip the full handshake
+    if (source._tls_session) {
+      SSL_set_session(ws.next_layer().native_handle(), source._tls_session);
+    }
+
     // Perform the SSL handshake
     ws.next_layer().async_handshake(ssl::stream_base::client, yield[ec]);
     if (ec)
       return fail(ec, "ssl_handshake");
+    metrics_factory::instance()
+        .get_counter("websocket_tls_handshakes")
+        .Get({{"host", source._host},
+              {"session",
+               SSL_session_reused(ws.next_layer().native_handle())
+                   ? "resumed"
+                   : "full"}})
+        .Increment();
 
     // Turn off the timeout on the tcp_stream, because
     // the websocket stream has its own timeout system.
@@ -225,31 +692,75 @@ private:
     ws.set_option(opt);
 
     // Perform the websocket handshake
-    ws.async_handshake(_host, _subscription, yield[ec]);
+    uint64_t rules_generation(matcher::shared().generation());
+    std::set<std::string> collections;
+    if (_derive_collections) {
+      collections = wanted_collections();
+    }
+    std::string subscription(
+        subscription_for(collections, resume_cursor(index)));
+    REL_INFO("subscribing at {}", subscription);
+    ws.async_handshake(source._host, subscription, yield[ec]);
     if (ec)
       return fail(ec, "handshake");
+    // runs alongside the reads and uses the stream, stop it before return
+    collections_watch watch(ioc);
+    if (_derive_collections) {
+      watch._running = true;
+      boost::asio::spawn(
+          ioc,
+          [&, collections, rules_generation](net::yield_context watch_yield) {
+            watch_collections(ws, watch, collections, rules_generation,
+                              watch_yield);
+          },
+          [](std::exception_ptr ex) {
+            if (ex)
+              std::rethrow_exception(ex);
+          });
+    }
     // main processing loop
     while (controller::instance().is_active()) {
+      if (_handler.saturated()) {
+        pause_reads(ioc, source, yield);
+      }
+
       // This buffer will hold the incoming message
       beast::flat_buffer buffer;
 
       // Read a message into our buffer
       ws.async_read(buffer, yield[ec]);
-      if (ec)
+      if (ec) {
+        stop_watch(watch, ioc, yield);
         return fail(ec, "read");
+      }
+
+      if (!source._received) {
+        remember_tls_session(source, ws.next_layer().native_handle());
+      }
+      on_received(source);
 
       // update stats
       metrics_factory::instance()
           .get_counter("websocket_inbound_messages")
-          .Get({{"host", _host}})
+          .Get({{"host", source._host}})
           .Increment();
       metrics_factory::instance()
           .get_counter("websocket_inbound_bytes")
-          .Get({{"host", _host}})
+          .Get({{"host", source._host}})
           .Increment(static_cast<double>(buffer.size()));
-
-      _handler.handle(buffer);
+      if (!accept_from(index)) {
+        source._held->hold(std::move(buffer), source._last_received);
+        continue;
+      }
+      if (source._held && !source._held->empty()) {
+        // just took over, the previous active relay may have missed some
+        for (auto const &held : source._held->release()) {
+          handle_frame(source, index, held.second);
+        }
+      }
+      handle_frame(source, index, buffer);
     }
+    stop_watch(watch, ioc, yield);
 
     // Close the WebSocket connection
     ws.async_close(websocket::close_code::normal, yield[ec]);
@@ -260,6 +771,26 @@ private:
     REL_INFO("websocket stopping");
   }
 
+  void handle_frame(relay &source, const size_t index,
+                    beast::flat_buffer const &buffer) {
+    beast::flat_buffer const *content(&buffer);
+    if (_decompressor) {
+      if (!_decompressor->decompress(buffer))
+        return;
+      content = &_decompressor->output();
+    }
+    if (_capture) {
+      _capture->append(*content);
+    }
+    // subscribers see each event once, as the handler does
+    if (_handler.handle(*content, index == 0) && _fanout) {
+      _fanout->publish(*content);
+    }
+    if (_handler.cursor() != 0) {
+      source._cursor = _handler.cursor();
+    }
+  }
+
   // Report a failure
   void fail(beast::error_code ec, char const *what) {
     std::ostringstream oss;
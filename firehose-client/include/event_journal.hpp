@@ -0,0 +1,108 @@
+#ifndef __event_journal_hpp__
+#define __event_journal_hpp__
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+#include "common/bluesky/platform.hpp"
+#include "readerwriterqueue.h"
+#include "yaml-cpp/yaml.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Structured binary record of moderation-relevant firehose events. Replaces
+// text logging of full message JSON on the post-processor thread. Records are
+// handed off through a lock-free queue and serialized by a background writer.
+namespace journal {
+
+// File layout: Magic, then a sequence of length-prefixed records. All integers
+// are little-endian.
+constexpr std::string_view Magic = "PEFJRNL1";
+
+enum class event_kind : uint8_t {
+  invalid = 0,
+  identity,
+  account,
+  tombstone,
+  match
+};
+
+std::string_view to_string(event_kind kind);
+
+struct record {
+  int64_t _seq = 0;
+  bsky::time_stamp _emitted_at;
+  event_kind _kind = event_kind::invalid;
+  std::string _did;
+  // at-uri path for content matches, "handle" sentinel for handle matches
+  std::string _path;
+  std::string _cid;
+  // kind-specific: new handle, account status
+  std::string _detail;
+  // matched filter strings
+  std::vector<std::string> _rules;
+};
+
+// encode/decode a single record, shared by writer and offline decoder
+void write_record(std::ostream &os, record const &value);
+bool read_record(std::istream &is, record &value);
+void write_header(std::ostream &os);
+bool read_header(std::istream &is);
+
+std::string as_text(record const &value);
+std::string as_json(record const &value);
+
+class event_journal {
+public:
+  // Single producer (post-processor thread), bounded so that a slow disk costs
+  // dropped records rather than pipeline stalls
+  static constexpr size_t QueueLimit = 100000;
+  static constexpr std::chrono::milliseconds FlushInterval =
+      std::chrono::milliseconds(3000);
+
+  static event_journal &instance();
+
+  void start(YAML::Node const &settings);
+  // writes out queued records, then stops the writer
+  void stop();
+  inline bool is_enabled() const { return _enabled; }
+  // non-blocking, safe to call when journal is disabled
+  void record(journal::record &&value);
+
+private:
+  event_journal();
+  ~event_journal() = default;
+
+  bool _enabled = false;
+  std::atomic<bool> _stopping = false;
+  std::string _filename;
+  std::ofstream _file;
+  std::thread _thread;
+  moodycamel::BlockingReaderWriterQueue<journal::record> _queue;
+};
+
+} // namespace journal
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef __fanout_server_hpp__
+#define __fanout_server_hpp__
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "yaml-cpp/yaml.h"
+#include <boost/asio/spawn.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/beast/core.hpp>
+#include <prometheus/counter.h>
+#include <prometheus/gauge.h>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace beast = boost::beast; // from <boost/beast.hpp>
+namespace net = boost::asio;    // from <boost/asio.hpp>
+
+// Re-serves frames from the upstream websocket to local subscribers, so that
+// experiments and tools share one upstream connection. Frames are held in a
+// bounded in-memory ring and numbered locally from 1. A subscriber connects
+// over plain websocket, optionally with ?cursor=<local seq>, and is told the
+// seq of its first frame in the X-Fanout-Cursor handshake header. Without a
+// cursor it starts live. A subscriber that falls behind the ring is dropped.
+//
+// Frames are published from the datasource thread, subscribers are served on
+// the server's own thread.
+class fanout_server {
+public:
+  static constexpr size_t DefaultRingFrames = 100000;
+  static constexpr size_t DefaultRingBytes = 256 * 1024 * 1024;
+  // accept errors such as running out of descriptors tend to persist
+  static constexpr std::chrono::milliseconds AcceptHoldOff =
+      std::chrono::milliseconds(1000);
+
+  //   fanout:
+  //     address: "127.0.0.1"
+  //     port: 8400
+  //     ring_frames: 100000
+  //     ring_bytes: 268435456
+  explicit fanout_server(YAML::Node const &settings);
+  ~fanout_server();
+  fanout_server(fanout_server const &) = delete;
+  fanout_server &operator=(fanout_server const &) = delete;
+
+  static void register_metrics();
+
+  void start();
+  void publish(beast::flat_buffer const &frame);
+
+private:
+  typedef std::shared_ptr<const std::string> frame_ptr;
+  enum class fetch_result { frame, caught_up, evicted };
+
+  // frame at cursor, if still in the ring
+  fetch_result fetch(const uint64_t cursor, frame_ptr &frame);
+  uint64_t start_cursor(std::string_view target);
+  void accept(net::yield_context yield);
+  void session(std::shared_ptr<net::ip::tcp::socket> socket,
+               net::yield_context yield);
+
+  std::string _address;
+  unsigned short _port;
+  size_t _max_frames;
+  size_t _max_bytes;
+
+  std::mutex _lock;
+  std::deque<frame_ptr> _ring;
+  // seq of the oldest frame in the ring, and total bytes held
+  uint64_t _first_seq = 1;
+  size_t _bytes = 0;
+
+  net::io_context _ioc;
+  std::thread _thread;
+  // caught-up subscribers, woken when a frame arrives. Server thread only.
+  std::list<net::steady_timer *> _waiting;
+
+  prometheus::Gauge *_subscribers = nullptr;
+  prometheus::Gauge *_ring_frames = nullptr;
+  prometheus::Gauge *_ring_bytes = nullptr;
+  prometheus::Counter *_sent = nullptr;
+  prometheus::Counter *_lagging = nullptr;
+};
+
+#endif
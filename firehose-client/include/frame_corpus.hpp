@@ -0,0 +1,102 @@
+#ifndef __frame_corpus_hpp__
+#define __frame_corpus_hpp__
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+#include <boost/beast/core.hpp>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Raw websocket frames as received from the firehose, for offline benchmarks,
+// replay and rule simulation. File is a sequence of frames each prefixed by
+// its length as little-endian uint32.
+namespace corpus {
+
+typedef std::vector<std::string> frames;
+
+class frame_writer {
+public:
+  frame_writer() = default;
+  explicit frame_writer(std::string const &filename)
+      : _file(filename, std::ios::binary | std::ios::out | std::ios::app) {
+    if (!_file.is_open()) {
+      throw std::invalid_argument("Cannot open frame capture " + filename);
+    }
+  }
+
+  inline void append(std::string_view frame) {
+    const uint32_t length(static_cast<uint32_t>(frame.length()));
+    for (size_t byte = 0; byte < sizeof(length); ++byte) {
+      _file.put(static_cast<char>((length >> (8 * byte)) & 0xFF));
+    }
+    _file.write(frame.data(), frame.length());
+  }
+  inline void append(boost::beast::flat_buffer const &buffer) {
+    auto data(buffer.data());
+    append(std::string_view(static_cast<const char *>(data.data()),
+                            data.size()));
+  }
+  inline void flush() { _file.flush(); }
+
+private:
+  std::ofstream _file;
+};
+
+inline frames load_frames(std::string const &filename) {
+  std::ifstream file(filename, std::ios::binary);
+  if (!file.is_open()) {
+    throw std::invalid_argument("Cannot open frame corpus " + filename);
+  }
+  frames result;
+  while (true) {
+    uint32_t length(0);
+    for (size_t byte = 0; byte < sizeof(length); ++byte) {
+      int next(file.get());
+      if (next == std::char_traits<char>::eof()) {
+        if (byte == 0)
+          return result;
+        throw std::runtime_error("Truncated frame length in " + filename);
+      }
+      length |= static_cast<uint32_t>(next & 0xFF) << (8 * byte);
+    }
+    std::string frame(length, '\0');
+    if (!file.read(frame.data(), length)) {
+      throw std::runtime_error("Truncated frame in " + filename);
+    }
+    result.emplace_back(std::move(frame));
+  }
+}
+
+// copy into the buffer type the websocket read produces
+inline void to_flat_buffer(std::string_view frame,
+                           boost::beast::flat_buffer &buffer) {
+  buffer.clear();
+  auto target(buffer.prepare(frame.length()));
+  std::memcpy(target.data(), frame.data(), frame.length());
+  buffer.commit(frame.length());
+}
+
+} // namespace corpus
+
+#endif
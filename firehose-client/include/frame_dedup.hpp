@@ -0,0 +1,121 @@
+#ifndef __frame_dedup_hpp__
+#define __frame_dedup_hpp__
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include <boost/beast/core.hpp>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Bounded window of recently seen frame identities, so that the same event
+// arriving from more than one relay is handled once. Relays number events
+// independently, so identity comes from the event content, e.g. (repo, rev)
+// for a commit. The window only has to span the skew between relays.
+// Used from a single thread.
+class frame_dedup {
+public:
+  explicit frame_dedup(const size_t window) : _ring(window, 0) {
+    _seen.reserve(window);
+  }
+
+  // 64-bit hash of the identifying fields, collision within the window is
+  // negligible
+  static uint64_t key_for(std::string_view first, std::string_view second,
+                          std::string_view third = {}) {
+    uint64_t key(std::hash<std::string_view>()(first));
+    for (auto const field : {second, third}) {
+      key ^= std::hash<std::string_view>()(field) + 0x9e3779b97f4a7c15ULL +
+             (key << 6) + (key >> 2);
+    }
+    return key;
+  }
+
+  // false if the key is still in the window
+  bool first_sighting(const uint64_t key) {
+    if (_seen.contains(key))
+      return false;
+    if (_filled == _ring.size()) {
+      _seen.erase(_ring[_next]);
+    } else {
+      ++_filled;
+    }
+    _ring[_next] = key;
+    _next = (_next + 1) % _ring.size();
+    _seen.insert(key);
+    return true;
+  }
+
+  inline size_t size() const { return _filled; }
+
+private:
+  // oldest key is evicted first
+  std::vector<uint64_t> _ring;
+  size_t _next = 0;
+  size_t _filled = 0;
+  std::unordered_set<uint64_t> _seen;
+};
+
+// Frames from a standby relay that were not handled, kept for long enough to
+// cover a swap. When the standby relay takes over, they are replayed through
+// frame_dedup ahead of its new frames. Events the previous active relay
+// delivered are dropped as repeats, and the rest fill its gap. The oldest
+// frames go first, by age or when the limit is reached. Used from a single
+// thread.
+class held_frames {
+public:
+  typedef std::chrono::steady_clock clock;
+
+  held_frames(const std::chrono::milliseconds span, const size_t limit)
+      : _span(span), _limit(limit) {}
+
+  void hold(boost::beast::flat_buffer &&frame, const clock::time_point now) {
+    while (!_frames.empty() && (_frames.size() >= _limit ||
+                                now - _frames.front().first > _span)) {
+      _frames.pop_front();
+    }
+    _frames.emplace_back(now, std::move(frame));
+  }
+
+  // oldest first, none are held afterwards
+  std::deque<std::pair<clock::time_point, boost::beast::flat_buffer>>
+  release() {
+    return std::exchange(_frames, {});
+  }
+
+  // last frame received, valid while held
+  inline boost::beast::flat_buffer const &newest() const {
+    return _frames.back().second;
+  }
+  inline bool empty() const { return _frames.empty(); }
+  inline size_t size() const { return _frames.size(); }
+
+private:
+  std::chrono::milliseconds _span;
+  size_t _limit;
+  std::deque<std::pair<clock::time_point, boost::beast::flat_buffer>> _frames;
+};
+
+#endif
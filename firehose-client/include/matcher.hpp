@@ -20,16 +20,26 @@ http://www.fsf.org/licensing/licenses
 >>> END OF LICENSE >>>
 *************************************************************************/
 #include "common/helpers.hpp"
+#include "common/pipeline_timing.hpp"
 #include "common/rest_utils.hpp"
 #include <aho_corasick/aho_corasick.hpp>
+#include <atomic>
 #include <boost/beast/core.hpp>
+#include <filesystem>
 #include <mutex>
+#include <set>
 #include <string>
 #include <string_view>
 #include <tuple>
 #include <unordered_map>
 #include <yaml-cpp/yaml.h>
 
+namespace bsky {
+namespace moderation {
+struct filter_matches;
+}
+} // namespace bsky
+
 namespace beast = boost::beast; // from <boost/beast.hpp>
 
 // filter match candidate
@@ -65,6 +75,8 @@ typedef std::vector<content_match> path_match_results;
 struct account_filter_matches {
   std::string _did;
   path_match_results _matches;
+  // receipt time of the originating firehose frame, if any
+  pipeline::ingest_time _ingested;
 };
 
 inline bool candidate::operator==(candidate const &rhs) const {
@@ -85,6 +97,16 @@ public:
   void set_config(const YAML::Node &filter_config);
   void load_filter_file(std::string const &filename);
   void refresh_rules(matcher &&replacement);
+  // Re-reads the filter file if it was modified since it was loaded. Rules
+  // from DB are refreshed by auxiliary_data instead.
+  bool reload_if_changed();
+  // changes whenever the rule set is replaced
+  inline uint64_t generation() const {
+    return _generation.load(std::memory_order_acquire);
+  }
+  // record collections that the current rules can match, for server-side
+  // filtering
+  std::set<std::string> wanted_collections() const;
 
   bool matches_any(std::string const &candidate) const;
   bool matches_any(beast::flat_buffer const &beast_data) const;
@@ -99,6 +121,11 @@ public:
   path_match_results all_matches_for_path_candidates(
       path_candidate_list const &path_candidates) const;
 
+  // Reports and list additions for the given matches, without acting on
+  // them. report_if_needed acts on the result, offline tools print it.
+  bsky::moderation::filter_matches
+  decide_report(account_filter_matches const &matches,
+                std::set<std::string> &block_lists) const;
   void report_if_needed(account_filter_matches &matches);
   inline bool use_db_for_rules() const { return _use_db_for_rules; }
 
@@ -194,6 +221,9 @@ private:
   mutable std::mutex _lock;
   bool _is_ready = false;
   bool _use_db_for_rules = false;
+  std::string _filter_file;
+  std::filesystem::file_time_type _filter_file_time;
+  std::atomic<uint64_t> _generation = 0;
   mutable aho_corasick::wtrie _substring_trie;
   mutable aho_corasick::wtrie _whole_word_trie;
   std::unordered_map<std::wstring, rule> _rule_lookup;
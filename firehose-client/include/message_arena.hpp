@@ -0,0 +1,86 @@
+#ifndef __message_arena_hpp__
+#define __message_arena_hpp__
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "concurrentqueue.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+// Monotonic arena for the transient state of one firehose message. Parse
+// state allocates from the arena with std::pmr containers and the whole lot
+// is dropped at once when the payload is done, instead of piecemeal. Arenas
+// are recycled through a pool so that the initial buffer is reused across
+// messages.
+//
+// An arena is used by one thread at a time. It is handed from the websocket
+// thread to the post-processor thread with the payload, and the queue
+// provides the ordering.
+class message_arena {
+public:
+  // covers the containers for a typical commit without going upstream
+  static constexpr size_t InitialSize = 16 * 1024;
+
+  struct releaser {
+    void operator()(message_arena *arena) const;
+  };
+  typedef std::unique_ptr<message_arena, releaser> handle;
+
+  message_arena()
+      : _resource(_buffer.data(), _buffer.size(),
+                  std::pmr::new_delete_resource()) {}
+  message_arena(message_arena const &) = delete;
+  message_arena &operator=(message_arena const &) = delete;
+
+  inline std::pmr::memory_resource *resource() { return &_resource; }
+  // returns to the initial buffer, overflow chunks are freed
+  inline void reset() { _resource.release(); }
+
+private:
+  alignas(std::max_align_t) std::array<std::byte, InitialSize> _buffer;
+  std::pmr::monotonic_buffer_resource _resource;
+};
+
+class message_arena_pool {
+public:
+  // bounds idle memory, more than this in flight are allocated and freed
+  static constexpr size_t MaxPooled = 256;
+
+  static message_arena_pool &instance();
+
+  message_arena::handle acquire();
+  void release(message_arena *arena);
+
+private:
+  message_arena_pool() = default;
+  ~message_arena_pool() = default;
+
+  moodycamel::ConcurrentQueue<message_arena *> _pool;
+  std::atomic<size_t> _pooled = 0;
+};
+
+inline void message_arena::releaser::operator()(message_arena *arena) const {
+  message_arena_pool::instance().release(arena);
+}
+
+#endif
@@ -43,6 +43,11 @@ public:
   void set_rewind_point();
   // this returns 0 by design, if handling is disabled
   inline int64_t get_rewind_point() const { return _cursor.load(); };
+  // tracked regardless of rewind setting. Reconnects resume from the
+  // datasource's own position, frames queued past this are not re-requested.
+  inline int64_t last_processed() const {
+    return _last_processed.load(std::memory_order_relaxed);
+  }
   void update_rewind_point(const int64_t seq, const std::string &emitted_at);
 
   // Periodic refresh
@@ -70,7 +75,9 @@ private:
   std::thread _thread;
 
   bool _enable_rewind = false;
+  bool _refresh_moderation_data = true;
   std::atomic<int64_t> _cursor = 0;
+  std::atomic<int64_t> _last_processed = 0;
   std::array<char, UtcDateTimeMaxLength> _emitted_at;
   bsky::time_stamp _last_rewind_checkpoint;
   std::chrono::steady_clock::time_point _last_rewind_flush;
@@ -25,6 +25,7 @@ http://www.fsf.org/licensing/licenses
 #include "common/metrics_factory.hpp"
 #include "common/moderation/ozone_adapter.hpp"
 #include "common/moderation/session_manager.hpp"
+#include "common/pipeline_timing.hpp"
 #include "jwt-cpp/jwt.h"
 #include "matcher.hpp"
 #include "project_defs.hpp"
@@ -146,6 +147,8 @@ struct block_list_addition {
   // The dated ones are archived - we just load their members to avoid
   // reprocessing.
   std::string _list_group_name;
+  // receipt time of the originating firehose frame, if any
+  pipeline::ingest_time _ingested;
 };
 
 typedef std::unordered_map<std::string, atproto::at_uri> list_uris_by_name;
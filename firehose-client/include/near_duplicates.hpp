@@ -0,0 +1,316 @@
+#ifndef __near_duplicates_hpp__
+#define __near_duplicates_hpp__
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "common/bluesky/platform.hpp"
+#include "yaml-cpp/yaml.h"
+#include <prometheus/counter.h>
+#include <prometheus/gauge.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace firehose {
+
+// MinHash signature of a post's text over overlapping word pairs. The share
+// of matching signature values estimates the Jaccard similarity of the two
+// posts' word pair sets, so posts that differ in a few words keep most of
+// their values. Case is folded for ASCII, other UTF-8 bytes are word
+// characters.
+struct text_signature {
+  static constexpr size_t ShingleWords = 2;
+  static constexpr size_t Hashes = 24;
+  typedef std::array<uint32_t, Hashes> minhashes;
+
+  minhashes _minhashes;
+  size_t _shingles = 0;
+
+  static inline uint64_t mix(uint64_t value) {
+    // splitmix64 finalizer, spreads FNV-1a output over all 64 bits
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+  }
+
+  static text_signature of(std::string_view text) {
+    text_signature result;
+    result._minhashes.fill(std::numeric_limits<uint32_t>::max());
+    std::array<uint64_t, ShingleWords> words = {};
+    size_t word_count(0);
+    auto add_shingle = [&]() {
+      uint64_t shingle(0);
+      for (size_t offset = 0; offset < ShingleWords; ++offset) {
+        shingle ^= std::rotl(words[(word_count + offset) % ShingleWords],
+                             static_cast<int>(offset * 21));
+      }
+      // one hash function per signature value, by seed
+      for (size_t index = 0; index < Hashes; ++index) {
+        const uint32_t value(static_cast<uint32_t>(
+            mix(shingle + index * 0x9e3779b97f4a7c15ULL) >> 32));
+        result._minhashes[index] = std::min(result._minhashes[index], value);
+      }
+      ++result._shingles;
+    };
+
+    uint64_t word(0);
+    bool in_word(false);
+    for (size_t index = 0; index <= text.length(); ++index) {
+      unsigned char next(index < text.length()
+                             ? static_cast<unsigned char>(text[index])
+                             : ' ');
+      const bool word_char((next >= '0' && next <= '9') ||
+                           (next >= 'a' && next <= 'z') ||
+                           (next >= 'A' && next <= 'Z') || next >= 0x80);
+      if (word_char) {
+        if (!in_word) {
+          word = 0xcbf29ce484222325ULL;
+          in_word = true;
+        }
+        if (next >= 'A' && next <= 'Z')
+          next = static_cast<unsigned char>(next - 'A' + 'a');
+        word = (word ^ next) * 0x100000001b3ULL;
+      } else if (in_word) {
+        in_word = false;
+        words[word_count % ShingleWords] = word;
+        if (++word_count >= ShingleWords) {
+          add_shingle();
+        }
+      }
+    }
+    return result;
+  }
+
+  // signature values in common, out of Hashes
+  static inline size_t agreement(minhashes const &lhs, minhashes const &rhs) {
+    size_t same(0);
+    for (size_t index = 0; index < Hashes; ++index) {
+      same += lhs[index] == rhs[index] ? 1 : 0;
+    }
+    return same;
+  }
+};
+
+// LSH index of recent post signatures. Signatures are split into bands of
+// Rows values and a post is filed under each band. Posts with Jaccard
+// similarity 0.75 share a band with probability above 0.99, dissimilar
+// posts rarely do. Posts sharing a band are near-duplicates if at least
+// MinAgreement signature values match. Bucket length and posts held are
+// capped so work per post and memory are bounded, and posts older than the
+// window are dropped.
+class near_duplicate_index {
+public:
+  static constexpr size_t Rows = 3;
+  static constexpr size_t Bands = text_signature::Hashes / Rows;
+  // estimated Jaccard similarity of one half
+  static constexpr size_t MinAgreement = text_signature::Hashes / 2;
+  // bounds the scan, and so the work, per band
+  static constexpr size_t MaxBucketPosts = 32;
+
+  struct cluster {
+    // distinct accounts with a near-duplicate of the post, including its own
+    size_t _accounts = 0;
+    std::vector<std::string> _flag;
+  };
+
+  near_duplicate_index(const std::chrono::milliseconds window,
+                       const size_t max_posts, const size_t cluster_accounts)
+      : _window(window), _max_posts(max_posts),
+        _cluster_accounts(cluster_accounts) {}
+
+  // Records a post and returns its cluster. Accounts to flag are every
+  // account in the cluster when this post takes it to cluster_accounts
+  // distinct accounts, or just this one when it joins a cluster already
+  // flagged within the window.
+  cluster add(std::string const &did, text_signature::minhashes const &hashes,
+              const bsky::time_stamp when) {
+    expire(when);
+    const uint64_t account(std::hash<std::string>()(did));
+    // near-duplicates from other accounts, by account
+    std::vector<std::pair<uint64_t, std::string const *>> similar;
+    bool flagged(false);
+    bool seen_before(false);
+    const std::array<uint64_t, Bands> keys(keys_for(hashes));
+    for (auto const key : keys) {
+      auto found(_buckets.find(key));
+      if (found == _buckets.end())
+        continue;
+      bool matched(false);
+      for (auto const sequence : found->second._posts) {
+        post const &candidate(_posts[sequence - _first_sequence]);
+        if (text_signature::agreement(candidate._minhashes, hashes) <
+            MinAgreement)
+          continue;
+        matched = true;
+        if (candidate._account == account) {
+          seen_before = true;
+        } else {
+          similar.emplace_back(candidate._account, &candidate._did);
+        }
+      }
+      if (matched && found->second._flagged_until > when)
+        flagged = true;
+    }
+    std::sort(similar.begin(), similar.end());
+    similar.erase(std::unique(similar.begin(), similar.end(),
+                              [](auto const &lhs, auto const &rhs) {
+                                return lhs.first == rhs.first;
+                              }),
+                  similar.end());
+
+    cluster result;
+    result._accounts = similar.size() + 1;
+    if (result._accounts >= _cluster_accounts) {
+      if (flagged) {
+        if (!seen_before)
+          result._flag.push_back(did);
+      } else {
+        result._flag.reserve(result._accounts);
+        for (auto const &member : similar) {
+          result._flag.push_back(*member.second);
+        }
+        result._flag.push_back(did);
+      }
+    }
+
+    const uint64_t sequence(_first_sequence + _posts.size());
+    _posts.push_back({hashes, account, when, did});
+    for (auto const key : keys) {
+      bucket &target(_buckets[key]);
+      if (!result._flag.empty())
+        target._flagged_until = when + _window;
+      if (target._posts.size() >= MaxBucketPosts)
+        target._posts.pop_front();
+      target._posts.push_back(sequence);
+    }
+    return result;
+  }
+
+  inline size_t posts() const { return _posts.size(); }
+  inline size_t buckets() const { return _buckets.size(); }
+
+private:
+  struct post {
+    text_signature::minhashes _minhashes;
+    uint64_t _account;
+    bsky::time_stamp _when;
+    std::string _did;
+  };
+  struct bucket {
+    // sequence numbers of the posts filed here, oldest first
+    std::deque<uint64_t> _posts;
+    bsky::time_stamp _flagged_until;
+  };
+
+  static std::array<uint64_t, Bands>
+  keys_for(text_signature::minhashes const &hashes) {
+    std::array<uint64_t, Bands> keys;
+    for (size_t band = 0; band < Bands; ++band) {
+      uint64_t key(band);
+      for (size_t row = 0; row < Rows; ++row) {
+        key = text_signature::mix(key ^ hashes[band * Rows + row]);
+      }
+      keys[band] = key;
+    }
+    return keys;
+  }
+
+  // oldest first, by age and then by the overall cap. The oldest post is at
+  // the front of each of its buckets, unless the length cap took it already.
+  void expire(const bsky::time_stamp now) {
+    while (!_posts.empty() && (_posts.front()._when + _window < now ||
+                               _posts.size() >= _max_posts)) {
+      for (auto const key : keys_for(_posts.front()._minhashes)) {
+        auto found(_buckets.find(key));
+        if (found == _buckets.end())
+          continue;
+        auto &filed(found->second._posts);
+        if (!filed.empty() && filed.front() == _first_sequence)
+          filed.pop_front();
+        if (filed.empty())
+          _buckets.erase(found);
+      }
+      _posts.pop_front();
+      ++_first_sequence;
+    }
+  }
+
+  std::chrono::milliseconds _window;
+  size_t _max_posts;
+  size_t _cluster_accounts;
+  // posts in arrival order, the front has sequence number _first_sequence
+  std::deque<post> _posts;
+  uint64_t _first_sequence = 0;
+  std::unordered_map<uint64_t, bucket> _buckets;
+};
+
+// Near-duplicate posts from many accounts within a short window, the shape
+// of a spam campaign that varies a few words per post to evade exact
+// filters. Off until the near_duplicates config section sets it up.
+// Memory is fixed by max_posts. Posts with fewer than min_shingles word
+// pairs are too generic to compare and are skipped. Posts are windowed by
+// the time of the frame that carried them, so a replayed backlog keeps its
+// original spacing.
+// A partition worker indexes only posts by the accounts it owns, so every
+// account flagged is local. A cluster is found only if cluster_accounts of
+// its members share one worker, see partition::router.
+class near_duplicate_detector {
+public:
+  static near_duplicate_detector &instance();
+  void set_config(YAML::Node const &settings);
+  void register_metrics();
+
+  // Called on the post-processor thread for each post. Returns the post's
+  // cluster and the accounts to flag, see near_duplicate_index::add.
+  near_duplicate_index::cluster check(std::string const &did,
+                                      std::string_view text,
+                                      const bsky::time_stamp emitted_at);
+
+private:
+  near_duplicate_detector() = default;
+  ~near_duplicate_detector() = default;
+
+  std::unique_ptr<near_duplicate_index> _index;
+  size_t _min_shingles = 4;
+
+  prometheus::Counter *_checked = nullptr;
+  prometheus::Counter *_skipped = nullptr;
+  prometheus::Counter *_clusters = nullptr;
+  prometheus::Counter *_flagged = nullptr;
+  prometheus::Gauge *_posts = nullptr;
+  prometheus::Gauge *_buckets = nullptr;
+};
+
+} // namespace firehose
+
+#endif
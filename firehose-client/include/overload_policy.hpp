@@ -0,0 +1,80 @@
+#ifndef __overload_policy_hpp__
+#define __overload_policy_hpp__
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "yaml-cpp/yaml.h"
+#include <prometheus/counter.h>
+#include <prometheus/gauge.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string_view>
+
+namespace firehose {
+
+// Work that can be sampled while the pipeline is overloaded. Matchable
+// content, identity and handle changes and blocks are not listed here and
+// are always processed in full.
+enum class sheddable {
+  social_graph = 0, // like, repost and follow recording and subject tracking
+  coordination,     // coordinated_actors check on like, repost and follow
+  facet_metrics,    // facet histograms and activity
+  language_metrics, // language counters
+  max_sheddable
+};
+
+std::string_view to_string(const sheddable work);
+
+// Once firehose lag passes shed_lag_ms, only one in keep_one_in items of
+// sheddable work is processed. Full processing resumes when lag falls below
+// recover_lag_ms. Nothing is shed unless the overload_policy section is
+// present in config.
+class overload_policy {
+public:
+  static overload_policy &instance();
+  void set_config(YAML::Node const &settings);
+  void register_metrics();
+
+  // true if the work should be done. Called on the post-processor thread.
+  bool admit(const sheddable work);
+  inline bool overloaded() const { return _overloaded; }
+
+private:
+  overload_policy() = default;
+  ~overload_policy() = default;
+
+  bool _enabled = false;
+  std::chrono::milliseconds _shed_lag = std::chrono::milliseconds(60000);
+  std::chrono::milliseconds _recover_lag = std::chrono::milliseconds(15000);
+  size_t _keep_one_in = 10;
+  bool _overloaded = false;
+
+  std::array<size_t, static_cast<size_t>(sheddable::max_sheddable)> _seen =
+      {};
+  std::array<prometheus::Counter *,
+             static_cast<size_t>(sheddable::max_sheddable)>
+      _shed = {};
+  prometheus::Counter *_transitions = nullptr;
+  prometheus::Gauge *_state = nullptr;
+};
+
+} // namespace firehose
+#endif
@@ -20,6 +20,7 @@ http://www.fsf.org/licensing/licenses
 >>> END OF LICENSE >>>
 *************************************************************************/
 
+#include "collection_plan.hpp"
 #include "common/config.hpp"
 #include "common/helpers.hpp"
 #include "common/log_wrapper.hpp"
@@ -27,9 +28,11 @@ http://www.fsf.org/licensing/licenses
 #include "nlohmann/json.hpp"
 #include <algorithm>
 #include <boost/beast/core.hpp>
+#include <memory_resource>
 #include <multiformats/cid.hpp>
 #include <string_view>
 #include <tuple>
+#include <unordered_map>
 #include <unordered_set>
 
 
@@ -39,6 +42,10 @@ using namespace std::literals;
 class parser {
 public:
   parser() = default;
+  // per-message state allocated from the given arena, see message_arena.hpp
+  explicit parser(std::pmr::memory_resource *resource)
+      : _cids(resource), _other_cbors(resource), _content_cbors(resource),
+        _matchable_cbors(resource) {}
   ~parser() = default;
 
   // Extract UTF-8 string containing the material to be checked,  which is
@@ -48,6 +55,8 @@ public:
   candidate_list
   get_candidates_from_flat_buffer(beast::flat_buffer const &beast_data);
   candidate_list get_candidates_from_json(nlohmann::json &full_json) const;
+  static candidate_list get_candidates_from_jetstream(char const *data,
+                                                      const size_t length);
   static candidate_list
   get_candidates_from_record(nlohmann::json const &record);
 
@@ -96,10 +105,12 @@ public:
               nlohmann::detail::parser_callback_t<BasicJsonType> cb = nullptr,
               const bool allow_exceptions = true, const bool strict = true,
               const nlohmann::detail::cbor_tag_handler_t tag_handler =
-                  nlohmann::detail::cbor_tag_handler_t::error) {
+                  nlohmann::detail::cbor_tag_handler_t::error,
+              parser *owner = nullptr) {
       nlohmann::basic_json result;
       _tag_handler = tag_handler;
       _callback = cb;
+      _owner = owner;
       auto ia =
           nlohmann::detail::input_adapter(std::move(first), std::move(last));
       nlohmann::detail::json_sax_dom_callback_parser<BasicJsonType,
@@ -118,12 +129,11 @@ public:
         uchar = static_cast<unsigned char>((first && !get_char) ? this->current
                                                                 : this->get());
         first = false;
-        if (!(uchar & 0x80)) {
-          result |= (uchar << shift);
+        result |= (static_cast<uint64_t>(uchar & 0x7F) << shift);
+        if (!(uchar & 0x80) || shift >= 63) {
           return result;
-        } else {
-          result |= ((uchar & 0x7F) << shift);
         }
+        shift += 7;
       }
     }
 
@@ -141,36 +151,51 @@ public:
       return false;
     }
 
-    // decode CID
+    // decode CID in place, in binary form. Caller converts to string only
+    // if it needs one.
     bool parse_car_cid(const bool get_char = true) {
-      uint64_t version(read_u64_leb128(get_char));
-      uint64_t codec(read_u64_leb128());
-      uint64_t digest_length(0);
-      if (version == 0x12 && codec == 0x20) {
-        // handle v0 CID - digest is always 32 bytes
-        digest_length = 32;
-        version = 0;
-      } else {
-        // arcane knowledge - DAG-PB wrapper on the 32-byte digest
-        digest_length = 34;
+      bool first(true);
+      bool truncated(false);
+      atproto::binary_cid cid;
+      cid.read([&]() -> uint8_t {
+        auto next((first && !get_char) ? this->current : this->get());
+        first = false;
+        if (next == nlohmann::detail::char_traits<
+                        typename InputAdapterType::char_type>::eof()) {
+          truncated = true;
+          return 0;
+        }
+        return static_cast<uint8_t>(next);
+      });
+      if (truncated)
+        return false;
+      if (_owner) {
+        _owner->_block_cid = cid;
+        _owner->_block_plan = _owner->plan_for_block(cid);
       }
-      std::vector<uint8_t> digest(digest_length);
-      for (auto next = digest.begin(); next != digest.end(); ++next) {
-        *next = static_cast<uint8_t>(this->get());
+      return true;
+    }
+
+    // step over block content that the owner does not want decoded
+    bool skip_car_block_data(const uint64_t length) {
+      for (uint64_t count = 0; count < length; ++count) {
+        if (this->get() == nlohmann::detail::char_traits<
+                               typename InputAdapterType::char_type>::eof())
+          return false;
       }
-      // Caller needs to process according to context
-      Multiformats::Cid cid({version}, {codec},
-                            {digest.cbegin(), digest.cend()});
-      nlohmann::json result(
-          {{"__readable_cid__",
-            cid.to_string(Multiformats::Multibase::Protocol::Base32)}});
-      return _callback(0, nlohmann::detail::parse_event_t::result, result);
+      return true;
     }
 
     bool parse_car_block(const bool get_char) {
-      read_u64_leb128(get_char); // skip block length
+      const uint64_t block_length(read_u64_leb128(get_char));
       if (!parse_car_cid())
         return false;
+      if (_owner && _owner->_block_plan == firehose::decode_plan::skip) {
+        const size_t cid_length(_owner->_block_cid.length());
+        if (block_length < cid_length)
+          return false;
+        return skip_car_block_data(block_length - cid_length);
+      }
       // decode DAG-CBOR block
       nlohmann::basic_json result;
       SAX this_pass_sax(result, _callback, _allow_exceptions);
@@ -231,6 +256,8 @@ public:
     nlohmann::detail::cbor_tag_handler_t _tag_handler;
     // callback function
     nlohmann::detail::parser_callback_t<BasicJsonType> _callback = nullptr;
+    // receives the CID and decode plan of each block before it is decoded
+    parser *_owner = nullptr;
     bool _allow_exceptions;
   };
 
@@ -250,7 +277,7 @@ public:
                             typename ::nlohmann::json, decltype(ia)>>(
                  std::move(ia), nlohmann::detail::input_format_t::cbor)
           .parse_car(first, last, callback, true, true,
-                     nlohmann::detail::cbor_tag_handler_t::ignore);
+                     nlohmann::detail::cbor_tag_handler_t::ignore, this);
     } catch (std::exception const &exc) {
       REL_ERROR("CAR parse threw: {}", exc.what());
     }
@@ -270,7 +297,10 @@ public:
   static void set_config(std::shared_ptr<config> &settings);
 
   // CAR file in "blocks" contains atproto content indexed by CIDs
-  typedef std::vector<std::pair<std::string, nlohmann::json>> indexed_cbors;
+  // Only the vector storage is arena-backed, nlohmann::json uses the global
+  // allocator internally
+  typedef std::pmr::vector<std::pair<atproto::binary_cid, nlohmann::json>>
+      indexed_cbors;
   const indexed_cbors &other_cbors() const { return _other_cbors; }
   const indexed_cbors &content_cbors() const { return _content_cbors; }
   const indexed_cbors &matchable_cbors() const { return _matchable_cbors; }
@@ -278,15 +308,35 @@ public:
   std::string dump_parse_matched() const;
   std::string dump_parse_other() const;
 
-  inline std::string block_cid() const { return _block_cid; }
+  inline atproto::binary_cid const &block_cid() const { return _block_cid; }
+
+  // CAR blocks to decode, by CID, and how much of each. Blocks not listed are
+  // skipped. Without a plan every block is decoded in full.
+  typedef std::pmr::unordered_map<atproto::binary_cid, firehose::decode_plan,
+                                  atproto::binary_cid_hash>
+      block_plans;
+  inline void plan_blocks(block_plans const *plans) { _plans = plans; }
+  // partitioned ingest decodes only what it needs to dedup and route the
+  // frame, see partition::is_routing_field
+  inline void route_only() { _route_only = true; }
 
 private:
+  firehose::decode_plan plan_for_block(atproto::binary_cid const &cid) const {
+    if (!_plans)
+      return firehose::decode_plan::full;
+    auto plan(_plans->find(cid));
+    return plan == _plans->cend() ? firehose::decode_plan::skip : plan->second;
+  }
+
   bool cbor_callback(int depth, nlohmann::json::parse_event_t event,
                      nlohmann::json &parsed);
 
   // CAR file in "blocks" contains atproto content indexed by CIDs
-  std::string _block_cid;
-  std::unordered_set<std::string> _cids;
+  atproto::binary_cid _block_cid;
+  block_plans const *_plans = nullptr;
+  firehose::decode_plan _block_plan = firehose::decode_plan::full;
+  bool _route_only = false;
+  std::pmr::unordered_set<atproto::binary_cid, atproto::binary_cid_hash> _cids;
   indexed_cbors _other_cbors;
   indexed_cbors _content_cbors;
   indexed_cbors _matchable_cbors;
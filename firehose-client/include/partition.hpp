@@ -0,0 +1,186 @@
+#ifndef __partition_hpp__
+#define __partition_hpp__
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "common/activity/account_events.hpp"
+#include "concurrentqueue.h"
+#include "yaml-cpp/yaml.h"
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/beast/core.hpp>
+#include <prometheus/counter.h>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// DID-partitioned deployment. One ingest process reads the firehose and
+// forwards each frame to the worker process that owns the repo DID. Each
+// worker runs the usual pipeline for its share of accounts, and forwards
+// interactions with accounts owned by other workers to their owner.
+//
+// Transport is a Unix stream socket per worker. A message is a kind byte and
+// the body length as little-endian uint32, followed by the body.
+namespace partition {
+
+enum class role { single, ingest, worker };
+enum class message_kind : uint8_t { frame = 1, interaction };
+
+// FNV-1a, stable across processes and builds unlike std::hash
+inline uint64_t did_hash(std::string_view did) {
+  uint64_t hash(14695981039346656037ULL);
+  for (const char next : did) {
+    hash ^= static_cast<uint8_t>(next);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+// Jump consistent hash (Lamping and Veach). Going from N to N+1 workers moves
+// only 1/(N+1) of accounts, and no lookup table is needed.
+inline uint32_t owner_of(std::string_view did, const uint32_t partitions) {
+  uint64_t key(did_hash(did));
+  int64_t bucket(-1);
+  int64_t next(0);
+  while (next < static_cast<int64_t>(partitions)) {
+    bucket = next;
+    key = key * 2862933555777941757ULL + 1;
+    next = static_cast<int64_t>(static_cast<double>(bucket + 1) *
+                                (static_cast<double>(1LL << 31) /
+                                 static_cast<double>((key >> 33) + 1)));
+  }
+  return static_cast<uint32_t>(bucket);
+}
+
+// Header and message fields the ingest decodes to dedup and route a frame.
+// The rest of the frame is decoded only by the worker that owns the repo.
+inline bool is_routing_field(std::string_view name) {
+  return name == "t" || name == "op" || name == "repo" || name == "did" ||
+         name == "rev" || name == "seq" || name == "time";
+}
+
+// accounts on the receiving end of an interaction, empty for other events
+std::vector<std::string> targets_of(activity::event const &event);
+// low_history travels with the event, see activity::pile_on_detector
+std::string encode_interaction(activity::timed_event const &event,
+                               const bool low_history);
+bool decode_interaction(std::string_view data, activity::timed_event &event);
+
+class router {
+public:
+  // upper bound on a message body, larger means a corrupt stream
+  static constexpr uint32_t MaxMessage = 16 * 1024 * 1024;
+  // do not retry connection to a missing worker on every message
+  static constexpr std::chrono::milliseconds ReconnectHoldOff =
+      std::chrono::milliseconds(1000);
+  // backlog checks while frame reads are paused
+  static constexpr std::chrono::milliseconds ReadPausePoll =
+      std::chrono::milliseconds(10);
+  // accept errors such as running out of descriptors tend to persist
+  static constexpr std::chrono::milliseconds AcceptHoldOff =
+      std::chrono::milliseconds(1000);
+  // how soon a worker notices the process is stopping
+  static constexpr std::chrono::milliseconds StopCheckInterval =
+      std::chrono::milliseconds(250);
+
+  static router &instance();
+
+  // Optional, without it one process handles everything:
+  //   partition:
+  //     role: worker # or ingest
+  //     workers: 4
+  //     index: 0 # this worker
+  //     socket_path: "/tmp/firehose_client" # worker n listens on <path>.<n>
+  void set_config(YAML::Node const &settings);
+  void register_metrics();
+
+  inline role get_role() const { return _role; }
+  inline bool is_local(std::string const &did) const {
+    return _role != role::worker || owner_of(did, _workers) == _index;
+  }
+
+  // ingest: send a frame to the worker that owns the repo. Blocks while the
+  // worker is slow or down, which pauses reads from the relay. False only if
+  // the process stopped before the frame was sent.
+  bool route_frame(std::string_view did,
+                   boost::beast::flat_buffer const &frame);
+  // worker: send an interaction with accounts owned elsewhere to the owners,
+  // called on the event recorder thread once the actor's history is known
+  void forward_interaction(activity::timed_event const &event,
+                           const bool low_history);
+  // worker: a forwarded interaction alerted on a local target, send the
+  // actor's share of the alert to the actor's owner
+  void forward_alert(std::string const &actor);
+  // worker: accept ingest and peer connections until the process stops,
+  // then close them all. Frames are handled on the calling thread. Reads
+  // from the ingest pause while saturated() is true, interactions from peers
+  // are not held up.
+  void serve(
+      std::function<void(boost::beast::flat_buffer const &)> const &on_frame,
+      std::function<bool()> const &saturated);
+  // worker: interactions forwarded by peers, for the post-processor thread
+  template <typename CONSUMER> void drain_interactions(CONSUMER &&consumer) {
+    activity::timed_event event;
+    while (_inbox.try_dequeue(event)) {
+      consumer(std::move(event));
+    }
+  }
+
+private:
+  router() = default;
+  ~router() = default;
+
+  // outbound connection. Used by the datasource in the ingest process, by
+  // the post-processor and event recorder in a worker.
+  struct peer {
+    explicit peer(std::string const &path) : _path(path), _socket(_ioc) {}
+
+    std::string _path;
+    std::mutex _lock;
+    boost::asio::io_context _ioc;
+    boost::asio::local::stream_protocol::socket _socket;
+    std::chrono::steady_clock::time_point _retry_after;
+    prometheus::Counter *_frames = nullptr;
+    prometheus::Counter *_interactions = nullptr;
+    prometheus::Counter *_dropped = nullptr;
+    prometheus::Counter *_retried = nullptr;
+  };
+
+  std::string socket_for(const uint32_t index) const;
+  // false if the worker could not be reached, the caller decides whether to
+  // drop or retry
+  bool send(const uint32_t partition, const message_kind kind,
+            std::string_view body);
+
+  role _role = role::single;
+  uint32_t _workers = 1;
+  uint32_t _index = 0;
+  std::string _socket_path;
+  std::vector<std::unique_ptr<peer>> _peers;
+  moodycamel::ConcurrentQueue<activity::timed_event> _inbox;
+};
+
+} // namespace partition
+#endif
@@ -23,6 +23,7 @@ http://www.fsf.org/licensing/licenses
 #include "common/activity/event_recorder.hpp"
 #include "common/helpers.hpp"
 #include "matcher.hpp"
+#include "message_arena.hpp"
 #include "parser.hpp"
 #include "post_processor.hpp"
 #include <unordered_map>
@@ -30,22 +31,34 @@ http://www.fsf.org/licensing/licenses
 class jetstream_payload {
 public:
   jetstream_payload();
-  jetstream_payload(std::string json_msg, match_results matches);
+  jetstream_payload(std::string json_msg, match_results matches,
+                    pipeline::ingest_time ingested);
   void handle(post_processor<jetstream_payload> &processor);
   inline std::string to_string() const { return _json_msg; }
+  inline pipeline::ingest_time ingested() const { return _ingested; }
 
 private:
   std::string _json_msg;
   match_results _matches;
+  pipeline::ingest_time _ingested;
 };
 class firehose_payload {
 public:
+  // Relays number events independently, so the restart point follows the
+  // primary relay's seq only. A primary frame that repeats an event already
+  // handled from another relay moves the restart point and nothing else.
+  enum class relay_frame { primary, secondary, primary_repeat };
+
   firehose_payload();
-  firehose_payload(parser &my_parser);
+  // parser must have been constructed on the arena's resource
+  firehose_payload(message_arena::handle &&arena, parser &my_parser,
+                   pipeline::ingest_time ingested,
+                   const relay_frame source = relay_frame::primary);
   void handle(post_processor<firehose_payload> &processor);
+  inline pipeline::ingest_time ingested() const { return _ingested; }
   inline std::string to_string() const {
-    auto const &header(_parser.other_cbors().front().second);
-    auto const &message(_parser.other_cbors().back().second);
+    auto const &header(_state->_parser.other_cbors().front().second);
+    auto const &message(_state->_parser.other_cbors().back().second);
     std::ostringstream oss;
     oss << "header (" << dump_json(header) << ") message ("
         << dump_json(message) << ')';
@@ -55,8 +68,16 @@ public:
 private:
   struct context {
     inline context(post_processor<firehose_payload> &processor,
+                   atproto::binary_cid const &cid,
                    nlohmann::json const &content)
-        : _processor(processor), _content(content) {}
+        : _processor(processor), _cid(cid), _content(content) {}
+    // display form, converted at most once and only if needed
+    std::string const &cid_string() {
+      if (_cid_string.empty()) {
+        _cid_string = _cid.to_string();
+      }
+      return _cid_string;
+    }
     std::string _repo;
     std::string _this_path;
     std::string _embed_type_str;
@@ -71,19 +92,39 @@ private:
 
   private:
     post_processor<firehose_payload> &_processor;
+    atproto::binary_cid const &_cid;
+    std::string _cid_string;
     nlohmann::json const &_content;
     std::vector<embed::embed_info> _embeds;
   };
+  // emitted_at is the time of the frame that carried the content
   void handle_content(post_processor<firehose_payload> &processor,
-                      std::string const &repo, std::string const &cid,
+                      std::string const &repo,
+                      const bsky::time_stamp emitted_at,
+                      atproto::binary_cid const &cid,
                       nlohmann::json const &content);
   void handle_matchable_content(post_processor<firehose_payload> &processor,
-                                std::string const &repo, std::string const &cid,
+                                std::string const &repo,
+                                const bsky::time_stamp emitted_at,
+                                atproto::binary_cid const &cid,
                                 nlohmann::json const &content);
 
-  parser _parser;
-  path_candidate_list _path_candidates;
-  std::unordered_map<std::string, std::string> _path_by_cid;
+  // Per-message state lives behind a pointer so that moving the payload
+  // through the post-processor queue does not copy arena-backed containers
+  // into the default resource.
+  struct state {
+    state(message_arena::handle &&arena, parser &&my_parser);
+    // declared first so it is released after the containers that use it
+    message_arena::handle _arena;
+    parser _parser;
+    path_candidate_list _path_candidates;
+    std::pmr::unordered_map<atproto::binary_cid, std::pmr::string,
+                            atproto::binary_cid_hash>
+        _path_by_cid;
+  };
+  std::unique_ptr<state> _state;
+  pipeline::ingest_time _ingested;
+  relay_frame _source = relay_frame::primary;
 };
 
 #endif
\ No newline at end of file
@@ -25,10 +25,13 @@ http://www.fsf.org/licensing/licenses
 #include "common/helpers.hpp"
 #include "common/log_wrapper.hpp"
 #include "common/metrics_factory.hpp"
+#include "common/pipeline_timing.hpp"
 #include "matcher.hpp"
 #include "moderation/embed_checker.hpp"
 #include "parser.hpp"
+#include "partition.hpp"
 #include "readerwriterqueue.h"
+#include <atomic>
 #include <nlohmann/detail/exceptions.hpp>
 #include <prometheus/counter.h>
 #include <prometheus/gauge.h>
@@ -101,6 +104,11 @@ inline op_kind op_kind_from_string(std::string const &op_kind_str) {
 template <typename T> class post_processor {
 public:
   static constexpr size_t QueueLimit = 10000;
+  // Inbound reads pause from the high watermark until the backlog drains to
+  // the low one, see saturated(). The queue itself grows on demand, past the
+  // high watermark only by frames already read when the pause starts.
+  static constexpr size_t HighWatermark = QueueLimit * 8 / 10;
+  static constexpr size_t LowWatermark = QueueLimit / 2;
 
   post_processor() : _queue(QueueLimit) {
     _thread = std::thread([&, this] {
@@ -109,12 +117,23 @@ public:
           T my_payload;
           try {
             _queue.wait_dequeue(my_payload);
+            if (_stopping)
+              break;
             metrics_factory::instance()
                 .get_gauge("process_operation")
                 .Get({{"message", "backlog"}})
                 .Decrement();
+            _ingested = my_payload.ingested();
+            pipeline::stage_timer::instance().record(
+                pipeline::stage::post_processor, _ingested);
 
             my_payload.handle(*this);
+            // interactions with our accounts recorded by other partitions
+            partition::router::instance().drain_interactions(
+                [](activity::timed_event &&event) {
+                  activity::event_recorder::instance().wait_enqueue(
+                      std::move(event));
+                });
           } catch (nlohmann::detail::exception const &exc) {
             REL_ERROR("post_processor JSON error {} on payload {}", exc.what(),
                       my_payload.to_string());
@@ -127,21 +146,41 @@ public:
       REL_INFO("post_processor stopping");
     });
   }
-  ~post_processor() = default;
+  // wake the thread with an empty payload, it is not handled
+  ~post_processor() {
+    _stopping = true;
+    _queue.enqueue(T());
+    if (_thread.joinable())
+      _thread.join();
+  }
   void wait_enqueue(T &&value) {
-    _queue.enqueue(value);
+    _queue.enqueue(std::move(value));
     metrics_factory::instance()
         .get_gauge("process_operation")
         .Get({{"message", "backlog"}})
         .Increment();
   }
   inline void request_recording(activity::timed_event &&event) {
+    event._ingested = _ingested;
     activity::event_recorder::instance().wait_enqueue(std::move(event));
   }
+  inline size_t backlog() const { return _queue.size_approx(); }
+  // true from when the backlog reaches the high watermark until it drains to
+  // the low one. Called on the thread that enqueues.
+  bool saturated() {
+    const size_t pending(backlog());
+    _saturated = _saturated ? pending > LowWatermark : pending >= HighWatermark;
+    return _saturated;
+  }
+  // receipt time of the frame currently being processed
+  inline pipeline::ingest_time ingested() const { return _ingested; }
 
 private:
+  pipeline::ingest_time _ingested;
   // Declare queue between websocket and match post-processing
   moodycamel::BlockingReaderWriterQueue<T> _queue;
+  std::atomic<bool> _stopping = false;
+  bool _saturated = false;
   std::thread _thread;
 };
 
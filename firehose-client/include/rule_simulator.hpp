@@ -0,0 +1,142 @@
+#ifndef __rule_simulator_hpp__
+#define __rule_simulator_hpp__
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+
+#include "common/bluesky/platform.hpp"
+#include "frame_corpus.hpp"
+#include "matcher.hpp"
+#include "work_stealing_pool.hpp"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+// Offline comparison of a candidate rule file with the current rules over a
+// frame capture, for rule_sim. Record text fields and handles are checked,
+// as in firehose_payload. Nothing is reported.
+namespace rule_sim {
+
+// frames per task, small enough for an even spread across the pool
+constexpr size_t FramesPerTask = 512;
+// example matches kept for each rule
+constexpr size_t SamplesPerRule = 5;
+
+struct rule_tally {
+  size_t _hits = 0;
+  std::set<std::string> _accounts;
+  std::vector<std::string> _samples;
+
+  void add(std::string const &did, std::string const &sample) {
+    ++_hits;
+    _accounts.insert(did);
+    if (_samples.size() < SamplesPerRule)
+      _samples.push_back(sample);
+  }
+  void merge(rule_tally const &other) {
+    _hits += other._hits;
+    _accounts.insert(other._accounts.cbegin(), other._accounts.cend());
+    for (auto const &sample : other._samples) {
+      if (_samples.size() >= SamplesPerRule)
+        break;
+      _samples.push_back(sample);
+    }
+  }
+};
+// by rule filter string
+typedef std::map<std::string, rule_tally> rule_tallies;
+
+struct sim_results {
+  rule_tallies _current;
+  rule_tallies _candidate;
+  rule_tallies _added;
+  rule_tallies _removed;
+  size_t _frames = 0;
+  size_t _failed = 0;
+  size_t _current_reports = 0;
+  size_t _candidate_reports = 0;
+  std::optional<bsky::time_stamp> _first;
+  std::optional<bsky::time_stamp> _last;
+
+  void merge(sim_results const &other) {
+    for (auto const &[rule, tally] : other._current)
+      _current[rule].merge(tally);
+    for (auto const &[rule, tally] : other._candidate)
+      _candidate[rule].merge(tally);
+    for (auto const &[rule, tally] : other._added)
+      _added[rule].merge(tally);
+    for (auto const &[rule, tally] : other._removed)
+      _removed[rule].merge(tally);
+    _frames += other._frames;
+    _failed += other._failed;
+    _current_reports += other._current_reports;
+    _candidate_reports += other._candidate_reports;
+    saw(other._first);
+    saw(other._last);
+  }
+  void saw(std::optional<bsky::time_stamp> const &when) {
+    if (!when)
+      return;
+    if (!_first || *when < *_first)
+      _first = when;
+    if (!_last || *when > *_last)
+      _last = when;
+  }
+};
+
+// what one frame offers for matching
+struct frame_content {
+  std::string _did;
+  path_candidate_list _path_candidates;
+  std::optional<bsky::time_stamp> _time;
+};
+
+// Firehose frame: header and message, then records from the commit CAR
+bool decode_firehose(std::string const &frame, frame_content &content);
+// Jetstream frame: JSON, one event
+bool decode_jetstream(std::string const &frame, frame_content &content);
+
+class simulator {
+public:
+  simulator(std::string const &current_rules,
+            std::string const &candidate_rules, const bool is_full,
+            work_stealing_pool &pool);
+
+  void run(corpus::frames const &frames);
+  sim_results const &results() const { return _results; }
+
+private:
+  void simulate(corpus::frames const &frames, const size_t first,
+                const size_t last);
+
+  const bool _is_full;
+  work_stealing_pool &_pool;
+  std::vector<std::unique_ptr<matcher>> _current;
+  std::vector<std::unique_ptr<matcher>> _candidate;
+  std::mutex _lock;
+  sim_results _results;
+};
+
+} // namespace rule_sim
+#endif
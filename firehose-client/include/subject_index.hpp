@@ -0,0 +1,307 @@
+#ifndef __subject_index_hpp__
+#define __subject_index_hpp__
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "common/bluesky/platform.hpp"
+#include "yaml-cpp/yaml.h"
+#include <prometheus/counter.h>
+#include <prometheus/gauge.h>
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace firehose {
+
+// TID record key packed into 64 bits: 53-bit microsecond timestamp then a
+// 10-bit clock id, 13 characters of base32-sortable. Not every rkey is a
+// TID.
+// https://atproto.com/specs/tid
+inline std::optional<uint64_t> packed_tid(std::string_view rkey) {
+  constexpr size_t Length = 13;
+  if (rkey.length() != Length)
+    return {};
+  uint64_t result(0);
+  for (size_t index = 0; index < Length; ++index) {
+    const char next(rkey[index]);
+    uint64_t value;
+    if (next >= '2' && next <= '7') {
+      value = static_cast<uint64_t>(next - '2');
+    } else if (next >= 'a' && next <= 'z') {
+      value = static_cast<uint64_t>(next - 'a') + 6;
+    } else {
+      return {};
+    }
+    // 65 bits encoded, the top one must be clear
+    if (index == 0 && (value & 0x10) != 0)
+      return {};
+    result = (result << 5) | value;
+  }
+  // zero marks an empty index slot
+  if (result == 0)
+    return {};
+  return result;
+}
+
+// Subject of each recent like, repost, follow and block, by repo, collection
+// and TID rkey, so that a later delete of the record can be tied to what it
+// was about. The firehose delete carries only the path.
+//
+// Slots are 24 bytes in a fixed open-addressed table: the packed TID, a
+// 32-bit fingerprint of repo and collection, an interned subject id and the
+// time the create was seen. The TID is chosen by the client, so it only
+// identifies the record, age is taken from the time seen. Subjects are
+// shared by every slot that refers to them, popular posts and accounts are
+// stored once and looked up by a view of that copy. A record is looked for
+// in Probes slots from its home slot. Insertion takes an empty or expired
+// slot if there is one, and otherwise overwrites the oldest record, so
+// memory is fixed and records older than the retention period are never
+// returned.
+class subject_index {
+public:
+  static constexpr size_t Probes = 8;
+
+  struct found {
+    std::string _subject;
+    bsky::time_stamp _created;
+  };
+
+  subject_index(const size_t capacity,
+                const std::chrono::milliseconds retention)
+      : _slots(std::bit_ceil(std::max(capacity, Probes))),
+        _retention(retention) {}
+
+  // false if the path is not a tracked collection with a TID rkey
+  bool insert(std::string_view did, std::string_view path,
+              std::string const &subject, const bsky::time_stamp now) {
+    auto key(key_for(did, path));
+    if (!key)
+      return false;
+    const size_t home(key->_home);
+    slot *target(nullptr);
+    for (size_t probe = 0; probe < Probes; ++probe) {
+      slot &candidate(_slots[(home + probe) & (_slots.size() - 1)]);
+      if (candidate._tid == key->_tid && candidate._owner == key->_owner) {
+        target = &candidate;
+        break;
+      }
+      if (!target || rank(candidate, now) < rank(*target, now)) {
+        target = &candidate;
+      }
+    }
+    if (target->_tid != 0) {
+      if (!(target->_tid == key->_tid && target->_owner == key->_owner) &&
+          !expired(*target, now))
+        ++_overwritten;
+      release(target->_subject);
+    } else {
+      ++_entries;
+    }
+    target->_tid = key->_tid;
+    target->_owner = key->_owner;
+    target->_subject = acquire(subject);
+    target->_seen = now;
+    return true;
+  }
+
+  // Subject and creation time of a deleted record, which is forgotten.
+  std::optional<found> take(std::string_view did, std::string_view path,
+                            const bsky::time_stamp now) {
+    auto key(key_for(did, path));
+    if (!key)
+      return {};
+    for (size_t probe = 0; probe < Probes; ++probe) {
+      slot &candidate(_slots[(key->_home + probe) & (_slots.size() - 1)]);
+      if (candidate._tid != key->_tid || candidate._owner != key->_owner)
+        continue;
+      std::optional<found> result;
+      if (!expired(candidate, now)) {
+        result = found{_subjects[candidate._subject]._name, candidate._seen};
+      }
+      release(candidate._subject);
+      candidate = slot();
+      --_entries;
+      return result;
+    }
+    return {};
+  }
+
+  // collection of the path is one whose subjects are kept
+  static inline bool tracks(std::string_view path) {
+    return code_of(path.substr(0, path.find('/'))) != 0;
+  }
+
+  inline size_t capacity() const { return _slots.size(); }
+  // occupied slots, including expired records not yet overwritten
+  inline size_t entries() const { return _entries; }
+  inline size_t subjects() const { return _subject_ids.size(); }
+  // records lost to a newer one before their retention period
+  inline size_t overwritten() const { return _overwritten; }
+
+private:
+  struct slot {
+    // zero marks an empty slot
+    uint64_t _tid = 0;
+    uint32_t _owner = 0;
+    uint32_t _subject = 0;
+    bsky::time_stamp _seen;
+  };
+  struct subject {
+    std::string _name;
+    uint32_t _refs = 0;
+  };
+  struct key {
+    uint64_t _tid;
+    uint32_t _owner;
+    size_t _home;
+  };
+
+  static inline uint64_t mix(uint64_t value) {
+    // splitmix64 finalizer
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+  }
+
+  static inline uint64_t code_of(std::string_view collection) {
+    if (collection == bsky::AppBskyFeedLike)
+      return 1;
+    if (collection == bsky::AppBskyFeedRepost)
+      return 2;
+    if (collection == bsky::AppBskyGraphFollow)
+      return 3;
+    if (collection == bsky::AppBskyGraphBlock)
+      return 4;
+    return 0;
+  }
+
+  std::optional<key> key_for(std::string_view did,
+                             std::string_view path) const {
+    const size_t separator(path.find('/'));
+    if (separator == std::string_view::npos)
+      return {};
+    const uint64_t collection_code(code_of(path.substr(0, separator)));
+    if (collection_code == 0)
+      return {};
+    auto tid(packed_tid(path.substr(separator + 1)));
+    if (!tid)
+      return {};
+    const uint64_t owner(
+        mix(std::hash<std::string_view>()(did) ^ (collection_code << 56)));
+    return key{*tid, static_cast<uint32_t>(owner >> 32),
+               static_cast<size_t>(mix(owner ^ *tid))};
+  }
+
+  inline bool expired(slot const &entry, const bsky::time_stamp now) const {
+    return entry._seen + _retention < now;
+  }
+  // lower is the better slot to take: empty, then expired, then oldest
+  inline int64_t rank(slot const &entry, const bsky::time_stamp now) const {
+    if (entry._tid == 0)
+      return std::numeric_limits<int64_t>::min();
+    if (expired(entry, now))
+      return std::numeric_limits<int64_t>::min() + 1;
+    return entry._seen.time_since_epoch().count();
+  }
+
+  uint32_t acquire(std::string const &name) {
+    auto existing(_subject_ids.find(name));
+    if (existing != _subject_ids.end()) {
+      ++_subjects[existing->second]._refs;
+      return existing->second;
+    }
+    uint32_t id;
+    if (!_free_subjects.empty()) {
+      id = _free_subjects.back();
+      _free_subjects.pop_back();
+    } else {
+      id = static_cast<uint32_t>(_subjects.size());
+      _subjects.emplace_back();
+    }
+    _subjects[id] = {name, 1};
+    _subject_ids.emplace(_subjects[id]._name, id);
+    return id;
+  }
+  void release(const uint32_t id) {
+    subject &entry(_subjects[id]);
+    if (--entry._refs > 0)
+      return;
+    _subject_ids.erase(entry._name);
+    entry._name.clear();
+    entry._name.shrink_to_fit();
+    _free_subjects.push_back(id);
+  }
+
+  std::vector<slot> _slots;
+  std::chrono::milliseconds _retention;
+  size_t _entries = 0;
+  size_t _overwritten = 0;
+  // a deque, so that the names viewed by _subject_ids never move
+  std::deque<subject> _subjects;
+  std::vector<uint32_t> _free_subjects;
+  std::unordered_map<std::string_view, uint32_t> _subject_ids;
+};
+
+// Owns the subject_index for the post-processor thread, which both records
+// creates and attributes deletes, timed by the frame that carried them. Off
+// until the subject_index config section sets it up.
+class subject_tracker {
+public:
+  static subject_tracker &instance();
+  void set_config(YAML::Node const &settings);
+  void register_metrics();
+
+  void created(std::string const &did, std::string const &path,
+               std::string const &subject, const bsky::time_stamp emitted_at);
+  std::optional<subject_index::found>
+  deleted(std::string const &did, std::string const &path,
+          const bsky::time_stamp emitted_at);
+
+private:
+  subject_tracker() = default;
+  ~subject_tracker() = default;
+
+  std::unique_ptr<subject_index> _index;
+
+  prometheus::Counter *_recorded = nullptr;
+  prometheus::Counter *_attributed = nullptr;
+  prometheus::Counter *_unknown = nullptr;
+  prometheus::Counter *_overwritten = nullptr;
+  prometheus::Gauge *_entries = nullptr;
+  prometheus::Gauge *_subjects = nullptr;
+  size_t _overwritten_reported = 0;
+};
+
+} // namespace firehose
+
+#endif
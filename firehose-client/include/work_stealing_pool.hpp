@@ -0,0 +1,182 @@
+#ifndef __work_stealing_pool_hpp__
+#define __work_stealing_pool_hpp__
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size thread pool for offline batch work of uneven size. Each worker
+// owns a queue. Tasks submitted from inside a task go to the submitting
+// worker's own queue and are taken newest first, so work splits depth-first
+// and stays cache-local. An idle worker steals the oldest task from another
+// worker's queue, which is the largest remaining piece when work is split
+// recursively. Tasks submitted from outside the pool are dealt round-robin.
+class work_stealing_pool {
+public:
+  typedef std::function<void()> task;
+
+  explicit work_stealing_pool(const size_t threads) {
+    const size_t count(threads == 0 ? 1 : threads);
+    for (size_t index = 0; index < count; ++index) {
+      _queues.emplace_back(std::make_unique<queue>());
+    }
+    for (size_t index = 0; index < count; ++index) {
+      _threads.emplace_back([this, index]() { run(index); });
+    }
+  }
+  work_stealing_pool(work_stealing_pool const &) = delete;
+  work_stealing_pool &operator=(work_stealing_pool const &) = delete;
+  ~work_stealing_pool() {
+    {
+      std::lock_guard<std::mutex> guard(_idle_lock);
+      _stop = true;
+    }
+    _work_ready.notify_all();
+    for (auto &thread : _threads) {
+      thread.join();
+    }
+  }
+
+  inline size_t size() const { return _threads.size(); }
+  // queue index of the calling worker, for per-worker state. Only valid
+  // inside a task.
+  inline static size_t current_worker() { return _worker; }
+  inline size_t stolen() const {
+    return _stolen.load(std::memory_order_relaxed);
+  }
+
+  void submit(task next) {
+    _pending.fetch_add(1, std::memory_order_acq_rel);
+    const size_t index(
+        _owner == this
+            ? _worker
+            : _next.fetch_add(1, std::memory_order_relaxed) % _queues.size());
+    {
+      std::lock_guard<std::mutex> guard(_queues[index]->_lock);
+      _queues[index]->_tasks.push_back(std::move(next));
+      _queued.fetch_add(1, std::memory_order_release);
+    }
+    // an idle worker may be between its check and its wait
+    { std::lock_guard<std::mutex> guard(_idle_lock); }
+    _work_ready.notify_one();
+  }
+
+  // Blocks until every submitted task has completed, including tasks they
+  // submitted. Rethrows the first exception thrown by a task.
+  void wait() {
+    std::unique_lock<std::mutex> lock(_idle_lock);
+    _all_done.wait(lock, [this]() {
+      return _pending.load(std::memory_order_acquire) == 0;
+    });
+    if (_failure) {
+      std::exception_ptr failure(std::move(_failure));
+      _failure = nullptr;
+      std::rethrow_exception(failure);
+    }
+  }
+
+private:
+  struct queue {
+    std::mutex _lock;
+    std::deque<task> _tasks;
+  };
+
+  // own queue, newest first
+  bool try_pop(const size_t index, task &next) {
+    std::lock_guard<std::mutex> guard(_queues[index]->_lock);
+    if (_queues[index]->_tasks.empty())
+      return false;
+    next = std::move(_queues[index]->_tasks.back());
+    _queues[index]->_tasks.pop_back();
+    _queued.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // another worker's queue, oldest first
+  bool try_steal(const size_t index, task &next) {
+    for (size_t offset = 1; offset < _queues.size(); ++offset) {
+      queue &victim(*_queues[(index + offset) % _queues.size()]);
+      std::lock_guard<std::mutex> guard(victim._lock);
+      if (victim._tasks.empty())
+        continue;
+      next = std::move(victim._tasks.front());
+      victim._tasks.pop_front();
+      _queued.fetch_sub(1, std::memory_order_relaxed);
+      _stolen.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+    return false;
+  }
+
+  void run(const size_t index) {
+    _owner = this;
+    _worker = index;
+    while (true) {
+      task next;
+      if (try_pop(index, next) || try_steal(index, next)) {
+        try {
+          next();
+        } catch (...) {
+          std::lock_guard<std::mutex> guard(_idle_lock);
+          if (!_failure)
+            _failure = std::current_exception();
+        }
+        if (_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          std::lock_guard<std::mutex> guard(_idle_lock);
+          _all_done.notify_all();
+        }
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(_idle_lock);
+      _work_ready.wait(lock, [this]() {
+        return _stop || _queued.load(std::memory_order_acquire) > 0;
+      });
+      if (_stop && _queued.load(std::memory_order_acquire) == 0)
+        return;
+    }
+  }
+
+  std::vector<std::unique_ptr<queue>> _queues;
+  std::vector<std::thread> _threads;
+  std::atomic<size_t> _pending = 0;
+  std::atomic<size_t> _queued = 0;
+  std::atomic<size_t> _next = 0;
+  std::atomic<size_t> _stolen = 0;
+  std::mutex _idle_lock;
+  std::condition_variable _work_ready;
+  std::condition_variable _all_done;
+  std::exception_ptr _failure;
+  bool _stop = false;
+
+  // identifies the pool and queue of the calling worker thread
+  inline static thread_local work_stealing_pool *_owner = nullptr;
+  inline static thread_local size_t _worker = 0;
+};
+
+#endif
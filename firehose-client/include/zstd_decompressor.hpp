@@ -0,0 +1,62 @@
+#ifndef __zstd_decompressor_hpp__
+#define __zstd_decompressor_hpp__
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include <boost/beast/core.hpp>
+#include <prometheus/counter.h>
+#include <prometheus/histogram.h>
+#include <string>
+#include <zstd.h>
+
+namespace beast = boost::beast; // from <boost/beast.hpp>
+
+// Decompresses zstd frames from a Jetstream "compress=true" subscription.
+// Frames are encoded with a published dictionary, which is loaded once into a
+// ZSTD_DDict. An empty dictionary file name decodes plain zstd frames. Output
+// goes to a buffer that is reused across frames, so steady state
+// decompression does not allocate. Used by one thread at a time.
+class zstd_decompressor {
+public:
+  // bucket boundaries in microseconds
+  static const prometheus::Histogram::BucketBoundaries MicrosecondBuckets;
+
+  zstd_decompressor(std::string const &dictionary_file,
+                    std::string const &host);
+  ~zstd_decompressor();
+  zstd_decompressor(zstd_decompressor const &) = delete;
+  zstd_decompressor &operator=(zstd_decompressor const &) = delete;
+
+  static void register_metrics();
+
+  // Returns false if the frame is not valid zstd for the dictionary. Output
+  // is valid until the next call.
+  bool decompress(beast::flat_buffer const &input);
+  inline beast::flat_buffer const &output() const { return _output; }
+
+private:
+  ZSTD_DCtx *_context = nullptr;
+  ZSTD_DDict *_dictionary = nullptr;
+  beast::flat_buffer _output;
+  prometheus::Counter *_inflated_bytes = nullptr;
+  prometheus::Histogram *_elapsed = nullptr;
+};
+
+#endif
@@ -0,0 +1,44 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+// Global allocator hook for ALLOC_STATS builds only, see
+// common/alloc_stats.hpp. Array forms route through these in the standard
+// library default implementations, over-aligned forms are not counted.
+#include "common/alloc_stats.hpp"
+#include <cstdlib>
+#include <new>
+
+void *operator new(std::size_t size) {
+  alloc_stats::on_allocate(size);
+  if (void *allocated = std::malloc(size == 0 ? 1 : size))
+    return allocated;
+  throw std::bad_alloc();
+}
+void *operator new(std::size_t size, std::nothrow_t const &) noexcept {
+  alloc_stats::on_allocate(size);
+  return std::malloc(size == 0 ? 1 : size);
+}
+void operator delete(void *allocated) noexcept { std::free(allocated); }
+void operator delete(void *allocated, std::size_t) noexcept {
+  std::free(allocated);
+}
+void operator delete(void *allocated, std::nothrow_t const &) noexcept {
+  std::free(allocated);
+}
@@ -0,0 +1,408 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+// Offline scan of repo exports (com.atproto.sync.getRepo output, one CAR file
+// per repo) against the configured filter rules. Prints the reports, labels
+// and list additions the live path would make, and the content statistics,
+// without acting on any of them.
+
+#include "common/bluesky/platform.hpp"
+#include "common/config.hpp"
+#include "common/log_wrapper.hpp"
+#include "common/moderation/report_agent.hpp"
+#include "matcher.hpp"
+#include "parser.hpp"
+#include "project_defs.hpp"
+#include "work_stealing_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// records matched per task, so that one large repo spreads across the pool
+constexpr size_t RecordsPerTask = 256;
+
+// the dimensions handle_content publishes as metrics in the live path
+struct scan_stats {
+  std::map<std::string, size_t> _collections;
+  std::map<std::string, size_t> _embeds;
+  std::map<std::string, size_t> _languages;
+  size_t _replies = 0;
+  size_t _mentions = 0;
+  size_t _tags = 0;
+  size_t _links = 0;
+
+  void merge(scan_stats const &other) {
+    for (auto const &[name, count] : other._collections)
+      _collections[name] += count;
+    for (auto const &[name, count] : other._embeds)
+      _embeds[name] += count;
+    for (auto const &[name, count] : other._languages)
+      _languages[name] += count;
+    _replies += other._replies;
+    _mentions += other._mentions;
+    _tags += other._tags;
+    _links += other._links;
+  }
+};
+
+std::string join(std::unordered_set<std::string> const &values) {
+  std::set<std::string> ordered(values.cbegin(), values.cend());
+  std::string result;
+  for (auto const &value : ordered) {
+    if (!result.empty())
+      result.push_back(',');
+    result.append(value);
+  }
+  return result;
+}
+
+class scanner {
+public:
+  explicit scanner(work_stealing_pool &pool) : _pool(pool) {}
+
+  void scan_file(std::filesystem::path const &file);
+  void print_summary(std::ostream &out) const;
+
+private:
+  // One repo export, shared by the tasks that match its records
+  struct repo_scan {
+    std::string _file;
+    std::string _did;
+    parser _parser;
+    std::unordered_map<atproto::binary_cid, std::string,
+                       atproto::binary_cid_hash>
+        _path_by_cid;
+    // content records, and whether each may hold match candidates
+    std::vector<std::pair<parser::indexed_cbors::value_type const *, bool>>
+        _records;
+    std::atomic<size_t> _remaining = 0;
+    // a task threw, the repo is counted as failed rather than reported
+    std::atomic<bool> _failed = false;
+    std::mutex _lock;
+    path_candidate_list _path_candidates;
+    scan_stats _stats;
+    size_t _unreferenced = 0;
+  };
+
+  static bool index_repo(repo_scan &repo);
+  static void scan_records(repo_scan &repo, const size_t first,
+                           const size_t last);
+  void finish_repo(repo_scan &repo);
+
+  work_stealing_pool &_pool;
+  mutable std::mutex _lock;
+  scan_stats _totals;
+  size_t _repos = 0;
+  size_t _failed = 0;
+  size_t _records = 0;
+  size_t _unreferenced = 0;
+  size_t _reported = 0;
+  size_t _decisions = 0;
+};
+
+// CIDs are CBOR tag 42 byte strings with a leading multibase zero
+atproto::binary_cid cid_from_link(nlohmann::json const &link) {
+  auto const &bytes(link.template get_ref<nlohmann::json::binary_t const &>());
+  if (bytes.empty())
+    throw std::invalid_argument("Empty CID link");
+  return atproto::binary_cid(bytes.cbegin() + 1, bytes.cend());
+}
+
+// Record paths come from the MST nodes. Keys in a node are prefix-compressed
+// against the previous entry in the same node, so each node decodes without
+// walking the tree.
+bool scanner::index_repo(repo_scan &repo) {
+  for (auto const &[cid, block] : repo._parser.other_cbors()) {
+    if (block.contains("did") && block.contains("data")) {
+      repo._did = block["did"].template get<std::string>();
+    } else if (block.contains("e") && block["e"].is_array()) {
+      std::string key;
+      for (auto const &entry : block["e"]) {
+        auto const &suffix(
+            entry["k"].template get_ref<nlohmann::json::binary_t const &>());
+        key.resize(entry["p"].template get<size_t>());
+        key.append(suffix.cbegin(), suffix.cend());
+        repo._path_by_cid.emplace(cid_from_link(entry["v"]), key);
+      }
+    }
+  }
+  if (repo._did.empty()) {
+    REL_ERROR("{} has no commit block", repo._file);
+    return false;
+  }
+  for (auto const &record : repo._parser.content_cbors()) {
+    repo._records.emplace_back(&record, false);
+  }
+  for (auto const &record : repo._parser.matchable_cbors()) {
+    repo._records.emplace_back(&record, true);
+  }
+  return true;
+}
+
+// Candidates and statistics as firehose_payload::handle_content and
+// handle_matchable_content derive them
+void scanner::scan_records(repo_scan &repo, const size_t first,
+                           const size_t last) {
+  scan_stats stats;
+  path_candidate_list found;
+  size_t unreferenced(0);
+  for (size_t index = first; index < last; ++index) {
+    auto const &[cid, content] = *repo._records[index].first;
+    auto path(repo._path_by_cid.find(cid));
+    if (path == repo._path_by_cid.cend()) {
+      // not in the current repo tree
+      ++unreferenced;
+      continue;
+    }
+    auto collection(content["$type"].template get<std::string>());
+    ++stats._collections[collection];
+    if (collection == bsky::AppBskyFeedPost) {
+      if (content.contains("reply"))
+        ++stats._replies;
+      if (content.contains("tags"))
+        stats._tags += content["tags"].size();
+      if (content.contains("embed")) {
+        ++stats._embeds[content["embed"]["$type"].template get<std::string>()];
+        if (content.contains("facets")) {
+          for (auto const &facet : content["facets"]) {
+            for (auto const &feature : facet["features"]) {
+              auto const &facet_type(
+                  feature["$type"].template get<std::string>());
+              if (facet_type == bsky::AppBskyRichtextFacetMention) {
+                ++stats._mentions;
+              } else if (facet_type == bsky::AppBskyRichtextFacetTag) {
+                ++stats._tags;
+              } else if (facet_type == bsky::AppBskyRichtextFacetLink) {
+                found.emplace_back(path_candidates{
+                    path->second,
+                    cid.to_string(),
+                    {{collection,
+                      std::string(bsky::AppBskyRichtextFacetLink),
+                      feature["uri"].template get<std::string>()}}});
+                ++stats._links;
+              }
+            }
+          }
+          if (content.contains("langs")) {
+            for (auto const &lang :
+                 content["langs"].template get<std::vector<std::string>>()) {
+              ++stats._languages[lang];
+            }
+          }
+        }
+      }
+    }
+    if (repo._records[index].second) {
+      auto candidates(parser::get_candidates_from_record(content));
+      if (!candidates.empty()) {
+        found.emplace_back(path_candidates{path->second, cid.to_string(),
+                                           std::move(candidates)});
+      }
+    }
+  }
+  std::lock_guard<std::mutex> guard(repo._lock);
+  repo._stats.merge(stats);
+  repo._unreferenced += unreferenced;
+  repo._path_candidates.insert(repo._path_candidates.end(),
+                               std::make_move_iterator(found.begin()),
+                               std::make_move_iterator(found.end()));
+}
+
+void scanner::scan_file(std::filesystem::path const &file) {
+  auto repo(std::make_shared<repo_scan>());
+  repo->_file = file.string();
+  bool parsed(false);
+  try {
+    // the mapping is only needed while the blocks are decoded
+    boost::interprocess::file_mapping mapping(
+        repo->_file.c_str(), boost::interprocess::read_only);
+    boost::interprocess::mapped_region region(mapping,
+                                              boost::interprocess::read_only);
+    auto const *first(static_cast<unsigned char const *>(region.get_address()));
+    parsed = repo->_parser.json_from_car(first, first + region.get_size()) &&
+             index_repo(*repo);
+  } catch (std::exception const &exc) {
+    REL_ERROR("Scan of {} failed: {}", repo->_file, exc.what());
+  }
+  if (!parsed) {
+    std::lock_guard<std::mutex> guard(_lock);
+    ++_failed;
+    return;
+  }
+
+  const size_t records(repo->_records.size());
+  const size_t tasks(std::max<size_t>(
+      1, (records + RecordsPerTask - 1) / RecordsPerTask));
+  repo->_remaining = tasks;
+  for (size_t task = 0; task < tasks; ++task) {
+    const size_t first(task * RecordsPerTask);
+    const size_t last(std::min(records, first + RecordsPerTask));
+    _pool.submit([this, repo, first, last]() {
+      try {
+        scan_records(*repo, first, last);
+      } catch (std::exception const &exc) {
+        REL_ERROR("Scan of {} failed: {}", repo->_file, exc.what());
+        repo->_failed = true;
+      }
+      if (repo->_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        finish_repo(*repo);
+      }
+    });
+  }
+}
+
+// same decision logic as action_router -> matcher::report_if_needed
+void scanner::finish_repo(repo_scan &repo) {
+  std::set<std::string> block_lists;
+  bsky::moderation::filter_matches decisions;
+  bool failed(repo._failed);
+  if (!failed) {
+    try {
+      account_filter_matches matches;
+      matches._did = repo._did;
+      matches._matches = matcher::shared().all_matches_for_path_candidates(
+          repo._path_candidates);
+      if (!matches._matches.empty()) {
+        decisions = matcher::shared().decide_report(matches, block_lists);
+      }
+    } catch (std::exception const &exc) {
+      REL_ERROR("Scan of {} failed: {}", repo._file, exc.what());
+      failed = true;
+    }
+  }
+
+  std::lock_guard<std::mutex> guard(_lock);
+  if (failed) {
+    ++_failed;
+    return;
+  }
+  ++_repos;
+  _records += repo._records.size();
+  _unreferenced += repo._unreferenced;
+  _totals.merge(repo._stats);
+  if (!decisions._scoped_matches.empty())
+    ++_reported;
+  for (auto const &[path, scoped] : decisions._scoped_matches) {
+    ++_decisions;
+    std::cout << repo._did << " report "
+              << (path.empty() ? std::string("account")
+                               : "at://" + repo._did + '/' + path);
+    if (!scoped._cid.empty())
+      std::cout << " cid=" << scoped._cid;
+    std::cout << " filters=" << join(scoped._filters);
+    if (!scoped._labels.empty())
+      std::cout << " labels=" << join(scoped._labels);
+    std::cout << '\n';
+  }
+  for (auto const &block_list : block_lists) {
+    ++_decisions;
+    std::cout << repo._did << " list " << block_list << '\n';
+  }
+}
+
+void scanner::print_summary(std::ostream &out) const {
+  std::lock_guard<std::mutex> guard(_lock);
+  out << "repos=" << _repos << " failed=" << _failed << " records=" << _records
+      << " unreferenced=" << _unreferenced << " reported=" << _reported
+      << " decisions=" << _decisions << '\n';
+  for (auto const &[name, count] : _totals._collections)
+    out << "collection " << name << ' ' << count << '\n';
+  for (auto const &[name, count] : _totals._embeds)
+    out << "embed " << name << ' ' << count << '\n';
+  for (auto const &[name, count] : _totals._languages)
+    out << "language " << name << ' ' << count << '\n';
+  out << "replies " << _totals._replies << '\n'
+      << "facet " << bsky::AppBskyRichtextFacetMention << ' '
+      << _totals._mentions << '\n'
+      << "facet " << bsky::AppBskyRichtextFacetTag << ' ' << _totals._tags
+      << '\n'
+      << "facet " << bsky::AppBskyRichtextFacetLink << ' ' << _totals._links
+      << '\n';
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  bool log_ready(false);
+  try {
+    // Check command line arguments.
+    if (argc != 3 && argc != 4) {
+      std::cerr << "Usage: car_scanner <config-file-name> <repo-directory> "
+                   "[<threads>]\n";
+      return EXIT_FAILURE;
+    }
+
+    std::shared_ptr<config> settings(std::make_shared<config>(argv[1]));
+    std::string const log_file(
+        settings->get_config()[PROJECT_NAME]["logging"]["filename"]
+            .as<std::string>());
+    spdlog::level::level_enum log_level(spdlog::level::from_str(
+        settings->get_config()[PROJECT_NAME]["logging"]["level"]
+            .as<std::string>()));
+    if (!init_logging(log_file, PROJECT_NAME, log_level)) {
+      return EXIT_FAILURE;
+    }
+    log_ready = true;
+    parser::set_config(settings);
+
+    // rules held in the moderation DB are not loaded offline
+    auto filters(settings->get_config()[PROJECT_NAME]["filters"]);
+    if (!filters["filename"]) {
+      throw std::invalid_argument("car_scanner needs filters.filename");
+    }
+    matcher::shared().load_filter_file(filters["filename"].as<std::string>());
+
+    const size_t threads(argc == 4 ? std::stoul(argv[3])
+                                   : std::thread::hardware_concurrency());
+    work_stealing_pool pool(threads);
+    scanner repo_scanner(pool);
+    for (auto const &entry :
+         std::filesystem::directory_iterator(std::filesystem::path(argv[2]))) {
+      if (entry.is_regular_file() && entry.path().extension() == ".car") {
+        pool.submit([&repo_scanner, file = entry.path()]() {
+          repo_scanner.scan_file(file);
+        });
+      }
+    }
+    pool.wait();
+
+    repo_scanner.print_summary(std::cerr);
+    REL_INFO("car_scanner done, {} tasks stolen across {} threads",
+             pool.stolen(), pool.size());
+    stop_logging();
+    return EXIT_SUCCESS;
+  } catch (std::exception const &exc) {
+    if (log_ready) {
+      REL_CRITICAL("Unhandled exception : {}", exc.what());
+      stop_logging();
+    } else {
+      std::cerr << "Unhandled exception : " << exc.what() << '\n';
+    }
+    return EXIT_FAILURE;
+  }
+}
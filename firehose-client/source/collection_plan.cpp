@@ -0,0 +1,89 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "collection_plan.hpp"
+#include "common/bluesky/platform.hpp"
+#include "common/log_wrapper.hpp"
+#include <stdexcept>
+
+namespace firehose {
+
+decode_plan decode_plan_from_string(std::string const &plan) {
+  if (plan == "skip")
+    return decode_plan::skip;
+  if (plan == "minimal")
+    return decode_plan::minimal;
+  if (plan == "full")
+    return decode_plan::full;
+  throw std::invalid_argument("Invalid decode plan " + plan);
+}
+
+std::string_view to_string(const decode_plan plan) {
+  switch (plan) {
+  case decode_plan::skip:
+    return "skip";
+  case decode_plan::minimal:
+    return "minimal";
+  case decode_plan::full:
+  default:
+    return "full";
+  }
+}
+
+collection_plan &collection_plan::instance() {
+  static collection_plan my_instance;
+  return my_instance;
+}
+
+collection_plan::collection_plan()
+    : _plans({{std::string(bsky::AppBskyFeedPost), decode_plan::full},
+              {std::string(bsky::AppBskyActorProfile), decode_plan::full},
+              {std::string(bsky::AppBskyFeedLike), decode_plan::minimal},
+              {std::string(bsky::AppBskyFeedRepost), decode_plan::minimal},
+              {std::string(bsky::AppBskyGraphFollow), decode_plan::minimal},
+              {std::string(bsky::AppBskyGraphBlock), decode_plan::minimal}}) {}
+
+void collection_plan::set_config(YAML::Node const &settings) {
+  if (!settings.IsDefined())
+    return;
+  if (settings["default"].IsDefined()) {
+    _default = decode_plan_from_string(settings["default"].as<std::string>());
+  }
+  for (auto const &entry : settings["collections"]) {
+    _plans[entry.first.as<std::string>()] =
+        decode_plan_from_string(entry.second.as<std::string>());
+  }
+  for (auto const &plan : _plans) {
+    REL_INFO("Collection {} decode plan {}", plan.first,
+             to_string(plan.second));
+  }
+  REL_INFO("Other collections decode plan {}", to_string(_default));
+}
+
+decode_plan collection_plan::plan_for(std::string_view collection) const {
+  auto plan(_plans.find(collection));
+  return plan == _plans.cend() ? _default : plan->second;
+}
+
+bool collection_plan::is_minimal_field(std::string_view field) {
+  return field == "$type" || field == "createdAt" || field == "subject";
+}
+
+} // namespace firehose
@@ -19,12 +19,102 @@ http://www.fsf.org/licensing/licenses
 *************************************************************************/
 
 #include "content_handler.hpp"
+#include "common/metrics_factory.hpp"
+#include "moderation/auxiliary_data.hpp"
+#include "partition.hpp"
 #include "payload.hpp"
+#include <optional>
+
+namespace {
+int64_t seq_of(parser const &my_parser) {
+  if (my_parser.other_cbors().size() != 2)
+    return 0;
+  auto const &message(my_parser.other_cbors().back().second);
+  return message.contains("seq") ? message["seq"].template get<int64_t>() : 0;
+}
+} // namespace
 
 template <>
-void content_handler<firehose_payload>::handle(
+int64_t content_handler<firehose_payload>::cursor_of(
     beast::flat_buffer const &beast_data) {
-  parser my_parser;
+  message_arena::handle arena(message_arena_pool::instance().acquire());
+  parser my_parser(arena->resource());
+  my_parser.route_only();
+  my_parser.get_candidates_from_flat_buffer(beast_data);
+  return seq_of(my_parser);
+}
+
+template <>
+bool content_handler<firehose_payload>::handle(
+    beast::flat_buffer const &beast_data, const bool primary) {
+  alloc_stats::scope allocations(alloc_stats::stage::content_handler);
+  pipeline::ingest_time ingested(pipeline::stage_timer::now());
+  message_arena::handle arena(message_arena_pool::instance().acquire());
+  parser my_parser(arena->resource());
+  const bool ingest(partition::router::instance().get_role() ==
+                    partition::role::ingest);
+  if (ingest) {
+    my_parser.route_only();
+  }
   my_parser.get_candidates_from_flat_buffer(beast_data);
-  _post_processor.wait_enqueue(firehose_payload(my_parser));
-}
\ No newline at end of file
+  _cursor = seq_of(my_parser);
+  bool repeat(false);
+  if (_dedup && my_parser.other_cbors().size() == 2) {
+    auto const &header(my_parser.other_cbors().front().second);
+    auto const &message(my_parser.other_cbors().back().second);
+    // relays number events independently, identify by content
+    std::string_view op_type;
+    if (header.contains("t")) {
+      op_type = header["t"].template get_ref<std::string const &>();
+    }
+    std::optional<uint64_t> key;
+    if (op_type == firehose::OpTypeCommit && message.contains("repo") &&
+        message.contains("rev")) {
+      key = frame_dedup::key_for(
+          message["repo"].template get_ref<std::string const &>(),
+          message["rev"].template get_ref<std::string const &>());
+    } else if (!op_type.empty() && message.contains("did") &&
+               message.contains("time")) {
+      key = frame_dedup::key_for(
+          message["did"].template get_ref<std::string const &>(),
+          message["time"].template get_ref<std::string const &>(), op_type);
+    }
+    if (key && !_dedup->first_sighting(*key)) {
+      _duplicates->Increment();
+      repeat = true;
+    }
+  }
+  if (ingest) {
+    // the worker that owns the repo does the rest
+    std::string_view did;
+    if (my_parser.other_cbors().size() == 2) {
+      auto const &message(my_parser.other_cbors().back().second);
+      if (message.contains("repo")) {
+        did = message["repo"].template get_ref<std::string const &>();
+      } else if (message.contains("did")) {
+        did = message["did"].template get_ref<std::string const &>();
+      }
+    }
+    // not past a frame the owning worker has yet to receive
+    if (!repeat && !partition::router::instance().route_frame(did, beast_data))
+      return false;
+    // the ingest owns the rewind point, workers each see only some seqs
+    if (primary && my_parser.other_cbors().size() == 2) {
+      auto const &message(my_parser.other_cbors().back().second);
+      if (message.contains("seq") && message.contains("time")) {
+        bsky::moderation::auxiliary_data::instance().update_rewind_point(
+            message["seq"].template get<int64_t>(),
+            message["time"].template get<std::string>());
+      }
+    }
+    return !repeat;
+  }
+  if (repeat && !primary)
+    return false;
+  _post_processor.wait_enqueue(firehose_payload(
+      std::move(arena), my_parser, ingested,
+      repeat    ? firehose_payload::relay_frame::primary_repeat
+      : primary ? firehose_payload::relay_frame::primary
+                : firehose_payload::relay_frame::secondary));
+  return !repeat;
+}
@@ -0,0 +1,171 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "coordinated_actors.hpp"
+#include "common/config.hpp"
+#include "common/controller.hpp"
+#include "common/log_wrapper.hpp"
+#include "common/metrics_factory.hpp"
+#include "moderation/list_manager.hpp"
+#include <stdexcept>
+
+namespace firehose {
+
+coordination_detector &coordination_detector::instance() {
+  static coordination_detector my_instance;
+  return my_instance;
+}
+
+coordination_detector::~coordination_detector() {
+  _stopping = true;
+  if (_thread.joinable())
+    _thread.join();
+}
+
+void coordination_detector::set_config(YAML::Node const &settings) {
+  if (!settings.IsDefined())
+    return;
+  // the index belongs to the detector thread once it runs
+  if (_thread.joinable()) {
+    throw std::invalid_argument("coordinated_actors is already configured");
+  }
+  const std::chrono::milliseconds window(
+      setting_or(settings, "window_ms", std::chrono::milliseconds(60000)));
+  const std::chrono::milliseconds bucket(
+      setting_or(settings, "bucket_ms", std::chrono::milliseconds(10000)));
+  const size_t max_interactions(
+      setting_or<size_t>(settings, "max_interactions", 500000));
+  const size_t min_actors(setting_or<size_t>(settings, "min_actors", 20));
+  const size_t min_targets(setting_or<size_t>(settings, "min_targets", 3));
+  const std::string block_list(
+      setting_or<std::string>(settings, "block_list", ""));
+  if (bucket.count() <= 0 || window < bucket || max_interactions == 0 ||
+      min_actors < 2 || min_targets < 2) {
+    throw std::invalid_argument(
+        "coordinated_actors needs bucket_ms > 0, window_ms >= bucket_ms, "
+        "max_interactions > 0, min_actors >= 2 and min_targets >= 2");
+  }
+  if (!block_list.empty()) {
+    if (!list_manager::is_active_list_for_group(block_list)) {
+      throw std::invalid_argument(
+          "Invalid coordinated_actors block_list " + block_list +
+          ", hyphen not permitted in list-group name");
+    }
+    list_manager::instance().register_block_reason(
+        block_list, "coordinated likes, reposts or follows");
+  }
+  _block_list = block_list;
+  _index = std::make_unique<interaction_index>(
+      window, bucket, max_interactions, min_actors, min_targets);
+  _thread = std::thread([this] {
+    try {
+      while (controller::instance().is_active() && !_stopping) {
+        recorded_interaction item;
+        // timed, so that the thread notices a stop with nothing queued
+        if (_queue.wait_dequeue_timed(item, std::chrono::milliseconds(100))) {
+          record(item);
+        }
+      }
+    } catch (std::exception const &exc) {
+      REL_ERROR("coordination_detector exception {}", exc.what());
+      controller::instance().force_stop();
+    }
+    REL_INFO("coordination_detector stopping");
+  });
+  REL_INFO("Coordinated actor detection: {} accounts on {} targets within {} "
+           "ms in {} ms buckets, up to {} interactions, block list '{}'",
+           min_actors, min_targets, window.count(), bucket.count(),
+           max_interactions, _block_list);
+}
+
+void coordination_detector::register_metrics() {
+  auto &outcomes(metrics_factory::instance().add_counter(
+      "coordinated_actors", "Coordinated interaction detection by outcome"));
+  _recorded = &outcomes.Add({{"interaction", "recorded"}});
+  _dropped = &outcomes.Add({{"interaction", "dropped"}});
+  _groups = &outcomes.Add({{"group", "flagged"}});
+  _flagged = &outcomes.Add({{"account", "flagged"}});
+  auto &index(metrics_factory::instance().add_gauge(
+      "coordinated_actor_index",
+      "Size and mining time of the coordinated interaction index"));
+  _interactions = &index.Add({{"index", "interactions"}});
+  _mine_ms = &index.Add({{"mine", "elapsed_ms"}});
+}
+
+std::vector<coordinated_group>
+coordination_detector::interaction(std::string const &actor,
+                                   std::string const &target,
+                                   const bsky::time_stamp emitted_at,
+                                   pipeline::ingest_time ingested) {
+  if (!_index)
+    return {};
+  if (!_queue.try_enqueue({actor, target, emitted_at, ingested}) &&
+      _dropped) {
+    _dropped->Increment();
+  }
+  std::vector<coordinated_group> groups;
+  coordinated_group group;
+  while (_found.try_dequeue(group)) {
+    groups.push_back(std::move(group));
+  }
+  return groups;
+}
+
+void coordination_detector::record(recorded_interaction const &item) {
+  const bool completed(
+      _index->add(item._actor, item._target, item._emitted_at));
+  if (_recorded) {
+    _recorded->Increment();
+    const size_t dropped(_index->dropped());
+    _dropped->Increment(static_cast<double>(dropped - _dropped_reported));
+    _dropped_reported = dropped;
+  }
+  if (!completed)
+    return;
+
+  auto started(std::chrono::steady_clock::now());
+  std::vector<coordinated_group> groups(_index->mine(item._emitted_at));
+  if (_interactions) {
+    _interactions->Set(static_cast<double>(_index->interactions()));
+    _mine_ms->Set(static_cast<double>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - started)
+            .count()));
+  }
+  for (auto &group : groups) {
+    REL_INFO("Coordinated group of {} accounts on {} targets including {}, "
+             "{} newly flagged",
+             group._accounts, group._targets, group._sample_target,
+             group._flag.size());
+    if (_groups) {
+      _groups->Increment();
+      _flagged->Increment(static_cast<double>(group._flag.size()));
+    }
+    if (!_block_list.empty()) {
+      for (auto const &did : group._flag) {
+        list_manager::instance().wait_enqueue(
+            {did, _block_list, item._ingested});
+      }
+    }
+    _found.enqueue(std::move(group));
+  }
+}
+
+} // namespace firehose
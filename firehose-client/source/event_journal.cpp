@@ -0,0 +1,265 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "event_journal.hpp"
+#include "common/controller.hpp"
+#include "common/log_wrapper.hpp"
+#include "common/metrics_factory.hpp"
+#include "nlohmann/json.hpp"
+#include <algorithm>
+#include <format>
+#include <limits>
+#include <sstream>
+
+namespace journal {
+
+namespace {
+template <typename T> void put(std::ostream &os, const T value) {
+  static_assert(std::is_integral<T>::value, "T must be an integral type");
+  using unsigned_type = std::make_unsigned_t<T>;
+  unsigned_type raw(static_cast<unsigned_type>(value));
+  for (size_t byte = 0; byte < sizeof(T); ++byte) {
+    os.put(static_cast<char>(raw & 0xFF));
+    raw = static_cast<unsigned_type>(raw >> 8);
+  }
+}
+
+template <typename T> bool get(std::istream &is, T &value) {
+  static_assert(std::is_integral<T>::value, "T must be an integral type");
+  using unsigned_type = std::make_unsigned_t<T>;
+  unsigned_type raw(0);
+  for (size_t byte = 0; byte < sizeof(T); ++byte) {
+    int next(is.get());
+    if (next == std::char_traits<char>::eof())
+      return false;
+    raw |= static_cast<unsigned_type>(static_cast<unsigned_type>(next & 0xFF)
+                                      << (8 * byte));
+  }
+  value = static_cast<T>(raw);
+  return true;
+}
+
+void put_string(std::ostream &os, std::string_view value) {
+  // fields are DIDs, paths, CIDs, handles and filter strings - all short
+  uint16_t length(static_cast<uint16_t>(
+      std::min(value.length(), size_t(std::numeric_limits<uint16_t>::max()))));
+  put(os, length);
+  os.write(value.data(), length);
+}
+
+bool get_string(std::istream &is, std::string &value) {
+  uint16_t length(0);
+  if (!get(is, length))
+    return false;
+  value.resize(length);
+  return static_cast<bool>(is.read(value.data(), length));
+}
+} // namespace
+
+std::string_view to_string(event_kind kind) {
+  switch (kind) {
+  case event_kind::identity:
+    return "identity";
+  case event_kind::account:
+    return "account";
+  case event_kind::tombstone:
+    return "tombstone";
+  case event_kind::match:
+    return "match";
+  case event_kind::invalid:
+  default:
+    return "invalid";
+  }
+}
+
+void write_header(std::ostream &os) { os.write(Magic.data(), Magic.length()); }
+
+bool read_header(std::istream &is) {
+  std::string magic(Magic.length(), '\0');
+  return is.read(magic.data(), magic.length()) && magic == Magic;
+}
+
+// Record body is prefixed with its length so that readers can skip records
+// written by a newer schema
+void write_record(std::ostream &os, record const &value) {
+  std::ostringstream body;
+  put(body, static_cast<uint8_t>(value._kind));
+  put(body, value._seq);
+  put(body, static_cast<int64_t>(value._emitted_at.time_since_epoch().count()));
+  put_string(body, value._did);
+  put_string(body, value._path);
+  put_string(body, value._cid);
+  put_string(body, value._detail);
+  put(body, static_cast<uint16_t>(value._rules.size()));
+  for (auto const &rule : value._rules) {
+    put_string(body, rule);
+  }
+  std::string const encoded(body.str());
+  put(os, static_cast<uint32_t>(encoded.length()));
+  os.write(encoded.data(), encoded.length());
+}
+
+bool read_record(std::istream &is, record &value) {
+  uint32_t length(0);
+  if (!get(is, length))
+    return false;
+  std::string encoded(length, '\0');
+  if (!is.read(encoded.data(), length))
+    return false;
+  std::istringstream body(encoded);
+  uint8_t kind(0);
+  int64_t emitted_at(0);
+  uint16_t rules(0);
+  if (!get(body, kind) || !get(body, value._seq) || !get(body, emitted_at) ||
+      !get_string(body, value._did) || !get_string(body, value._path) ||
+      !get_string(body, value._cid) || !get_string(body, value._detail) ||
+      !get(body, rules)) {
+    return false;
+  }
+  value._kind = static_cast<event_kind>(kind);
+  value._emitted_at =
+      bsky::time_stamp(std::chrono::milliseconds(emitted_at));
+  value._rules.resize(rules);
+  for (auto &rule : value._rules) {
+    if (!get_string(body, rule))
+      return false;
+  }
+  return true;
+}
+
+std::string as_text(record const &value) {
+  std::ostringstream oss;
+  oss << std::format("{:%FT%T}Z", value._emitted_at) << ' ' << value._seq
+      << ' ' << to_string(value._kind) << ' ' << value._did;
+  if (!value._path.empty()) {
+    oss << ' ' << value._path;
+  }
+  if (!value._cid.empty()) {
+    oss << ' ' << value._cid;
+  }
+  if (!value._detail.empty()) {
+    oss << ' ' << value._detail;
+  }
+  bool first(true);
+  for (auto const &rule : value._rules) {
+    oss << (first ? " rules='" : "','") << rule;
+    first = false;
+  }
+  if (!first) {
+    oss << '\'';
+  }
+  return oss.str();
+}
+
+std::string as_json(record const &value) {
+  nlohmann::json result({{"seq", value._seq},
+                         {"time", std::format("{:%FT%T}Z", value._emitted_at)},
+                         {"kind", to_string(value._kind)},
+                         {"did", value._did}});
+  if (!value._path.empty()) {
+    result["path"] = value._path;
+  }
+  if (!value._cid.empty()) {
+    result["cid"] = value._cid;
+  }
+  if (!value._detail.empty()) {
+    result["detail"] = value._detail;
+  }
+  if (!value._rules.empty()) {
+    result["rules"] = value._rules;
+  }
+  return result.dump();
+}
+
+event_journal &event_journal::instance() {
+  static event_journal my_instance;
+  return my_instance;
+}
+
+event_journal::event_journal() : _queue(QueueLimit) {}
+
+void event_journal::start(YAML::Node const &settings) {
+  if (!settings || !settings["filename"]) {
+    REL_INFO("No event journal configured");
+    return;
+  }
+  _filename = settings["filename"].as<std::string>();
+  _file.open(_filename, std::ios::binary | std::ios::out | std::ios::app);
+  if (!_file.is_open()) {
+    throw std::invalid_argument("Cannot open event journal " + _filename);
+  }
+  // empty file needs the format marker
+  if (_file.tellp() == 0) {
+    write_header(_file);
+  }
+  metrics_factory::instance().add_counter(
+      "event_journal", "Structured event journal activity");
+  _enabled = true;
+  REL_INFO("Event journal writing to {}", _filename);
+
+  _thread = std::thread([&, this] {
+    auto &written(metrics_factory::instance()
+                      .get_counter("event_journal")
+                      .Add({{"records", "written"}}));
+    auto last_flush(std::chrono::steady_clock::now());
+    journal::record next;
+    while (controller::instance().is_active() && !_stopping) {
+      if (_queue.wait_dequeue_timed(next, FlushInterval)) {
+        write_record(_file, next);
+        written.Increment();
+      }
+      auto now(std::chrono::steady_clock::now());
+      if (now - last_flush > FlushInterval) {
+        _file.flush();
+        last_flush = now;
+      }
+    }
+    // records queued before shutdown are not lost
+    size_t drained(0);
+    while (_queue.try_dequeue(next)) {
+      write_record(_file, next);
+      written.Increment();
+      ++drained;
+    }
+    _file.flush();
+    REL_INFO("event_journal wrote {} queued records at shutdown", drained);
+    REL_INFO("event_journal stopping");
+  });
+}
+
+void event_journal::stop() {
+  if (!_thread.joinable())
+    return;
+  _stopping = true;
+  _thread.join();
+}
+
+void event_journal::record(journal::record &&value) {
+  if (!_enabled)
+    return;
+  if (!_queue.try_enqueue(std::move(value))) {
+    metrics_factory::instance()
+        .get_counter("event_journal")
+        .Get({{"records", "dropped"}})
+        .Increment();
+  }
+}
+
+} // namespace journal
@@ -0,0 +1,238 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "fanout_server.hpp"
+#include "common/controller.hpp"
+#include "common/log_wrapper.hpp"
+#include "common/metrics_factory.hpp"
+#include <boost/beast/http.hpp>
+#include <boost/beast/websocket.hpp>
+#include <algorithm>
+#include <charconv>
+#include <functional>
+
+namespace http = beast::http;           // from <boost/beast/http.hpp>
+namespace websocket = beast::websocket; // from <boost/beast/websocket.hpp>
+using tcp = boost::asio::ip::tcp;       // from <boost/asio/ip/tcp.hpp>
+
+fanout_server::fanout_server(YAML::Node const &settings)
+    : _address(settings["address"] ? settings["address"].as<std::string>()
+                                   : std::string("127.0.0.1")),
+      _port(settings["port"].as<unsigned short>()),
+      _max_frames(settings["ring_frames"]
+                      ? settings["ring_frames"].as<size_t>()
+                      : DefaultRingFrames),
+      _max_bytes(settings["ring_bytes"] ? settings["ring_bytes"].as<size_t>()
+                                        : DefaultRingBytes) {
+  if (_max_frames == 0 || _max_bytes == 0) {
+    throw std::invalid_argument("fanout ring must not be empty");
+  }
+  auto &sessions(metrics_factory::instance().get_counter("fanout_sessions"));
+  _sent = &metrics_factory::instance()
+               .get_counter("fanout_frames")
+               .Add({{"frames", "sent"}});
+  _lagging = &sessions.Add({{"session", "lagging"}});
+  _subscribers = &metrics_factory::instance()
+                      .get_gauge("fanout_ring")
+                      .Add({{"fanout", "subscribers"}});
+  _ring_frames = &metrics_factory::instance()
+                      .get_gauge("fanout_ring")
+                      .Add({{"fanout", "frames"}});
+  _ring_bytes = &metrics_factory::instance()
+                     .get_gauge("fanout_ring")
+                     .Add({{"fanout", "bytes"}});
+}
+
+fanout_server::~fanout_server() {
+  _ioc.stop();
+  if (_thread.joinable()) {
+    _thread.join();
+  }
+}
+
+void fanout_server::register_metrics() {
+  metrics_factory::instance().add_counter(
+      "fanout_frames", "Frames sent to local fan-out subscribers");
+  metrics_factory::instance().add_counter("fanout_sessions",
+                                          "Local fan-out subscriber sessions");
+  metrics_factory::instance().add_gauge(
+      "fanout_ring", "Local fan-out subscribers and buffered frames");
+}
+
+void fanout_server::start() {
+  boost::asio::spawn(_ioc,
+                     std::bind(&fanout_server::accept, this,
+                               std::placeholders::_1),
+                     [](std::exception_ptr ex) {
+                       if (ex)
+                         std::rethrow_exception(ex);
+                     });
+  _thread = std::thread([this] {
+    REL_INFO("fanout server on {}:{}", _address, _port);
+    try {
+      _ioc.run();
+    } catch (std::exception const &exc) {
+      REL_ERROR("fanout server exception {}", exc.what());
+    }
+    REL_INFO("fanout server stopping");
+  });
+}
+
+void fanout_server::publish(beast::flat_buffer const &frame) {
+  auto data(frame.data());
+  frame_ptr copy(std::make_shared<const std::string>(
+      static_cast<const char *>(data.data()), data.size()));
+  {
+    std::lock_guard guard(_lock);
+    _bytes += copy->size();
+    _ring.push_back(std::move(copy));
+    while (_ring.size() > _max_frames ||
+           (_bytes > _max_bytes && _ring.size() > 1)) {
+      _bytes -= _ring.front()->size();
+      _ring.pop_front();
+      ++_first_seq;
+    }
+    _ring_frames->Set(static_cast<double>(_ring.size()));
+    _ring_bytes->Set(static_cast<double>(_bytes));
+  }
+  net::post(_ioc, [this] {
+    for (auto waiting : _waiting) {
+      waiting->cancel();
+    }
+  });
+}
+
+fanout_server::fetch_result fanout_server::fetch(const uint64_t cursor,
+                                                 frame_ptr &frame) {
+  std::lock_guard guard(_lock);
+  if (cursor < _first_seq)
+    return fetch_result::evicted;
+  if (cursor >= _first_seq + _ring.size())
+    return fetch_result::caught_up;
+  frame = _ring[cursor - _first_seq];
+  return fetch_result::frame;
+}
+
+// ?cursor=N replays from N, or the oldest frame held if N was evicted
+uint64_t fanout_server::start_cursor(std::string_view target) {
+  std::lock_guard guard(_lock);
+  const uint64_t live(_first_seq + _ring.size());
+  constexpr std::string_view CursorParam = "cursor=";
+  size_t param(target.find(CursorParam));
+  if (param == std::string_view::npos)
+    return live;
+  uint64_t cursor(0);
+  auto value(target.substr(param + CursorParam.length()));
+  auto parsed(
+      std::from_chars(value.data(), value.data() + value.size(), cursor));
+  if (parsed.ec != std::errc())
+    return live;
+  return std::clamp(cursor, _first_seq, live);
+}
+
+void fanout_server::accept(net::yield_context yield) {
+  beast::error_code ec;
+  tcp::acceptor acceptor(_ioc);
+  tcp::endpoint endpoint(net::ip::make_address(_address), _port);
+  acceptor.open(endpoint.protocol());
+  acceptor.set_option(net::socket_base::reuse_address(true));
+  acceptor.bind(endpoint);
+  acceptor.listen(net::socket_base::max_listen_connections);
+  net::steady_timer hold_off(_ioc);
+  while (controller::instance().is_active()) {
+    auto socket(std::make_shared<tcp::socket>(_ioc));
+    acceptor.async_accept(*socket, yield[ec]);
+    if (ec == net::error::operation_aborted)
+      break;
+    if (ec) {
+      REL_ERROR_LIMITED(10, 0, "fanout accept error {}", ec.message());
+      hold_off.expires_after(AcceptHoldOff);
+      hold_off.async_wait(yield[ec]);
+      continue;
+    }
+    boost::asio::spawn(_ioc,
+                       std::bind(&fanout_server::session, this, socket,
+                                 std::placeholders::_1),
+                       [](std::exception_ptr ex) {
+                         if (ex)
+                           std::rethrow_exception(ex);
+                       });
+  }
+}
+
+void fanout_server::session(std::shared_ptr<tcp::socket> socket,
+                            net::yield_context yield) {
+  beast::error_code ec;
+  websocket::stream<beast::tcp_stream> ws(std::move(*socket));
+
+  // the upgrade request carries the cursor
+  beast::flat_buffer buffer;
+  http::request<http::string_body> request;
+  http::async_read(ws.next_layer(), buffer, request, yield[ec]);
+  if (ec || !websocket::is_upgrade(request))
+    return;
+  uint64_t cursor(start_cursor(
+      std::string_view(request.target().data(), request.target().size())));
+  std::string const first(std::to_string(cursor));
+  ws.set_option(websocket::stream_base::timeout::suggested(
+      beast::role_type::server));
+  ws.set_option(websocket::stream_base::decorator(
+      [first](websocket::response_type &res) {
+        res.set("X-Fanout-Cursor", first);
+      }));
+  ws.async_accept(request, yield[ec]);
+  if (ec)
+    return;
+  ws.binary(true);
+  std::string const peer(
+      beast::get_lowest_layer(ws).socket().remote_endpoint(ec).address()
+          .to_string());
+  REL_INFO("fanout subscriber {} from seq {}", peer, cursor);
+  _subscribers->Increment();
+
+  net::steady_timer wake(_ioc);
+  while (controller::instance().is_active()) {
+    frame_ptr frame;
+    fetch_result result(fetch(cursor, frame));
+    if (result == fetch_result::evicted) {
+      REL_WARNING("fanout subscriber {} fell behind at seq {}, dropped", peer,
+                  cursor);
+      _lagging->Increment();
+      ws.async_close(websocket::close_code::policy_error, yield[ec]);
+      break;
+    }
+    if (result == fetch_result::caught_up) {
+      // woken by publish, or periodically to notice shutdown
+      wake.expires_after(std::chrono::seconds(1));
+      auto waiting(_waiting.insert(_waiting.end(), &wake));
+      wake.async_wait(yield[ec]);
+      _waiting.erase(waiting);
+      continue;
+    }
+    ws.async_write(net::buffer(*frame), yield[ec]);
+    if (ec) {
+      REL_INFO("fanout subscriber {} closed: {}", peer, ec.message());
+      break;
+    }
+    _sent->Increment();
+    ++cursor;
+  }
+  _subscribers->Decrement();
+}
@@ -0,0 +1,59 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+// Offline decoder for the firehose_client binary event journal
+
+#include "event_journal.hpp"
+#include <fstream>
+#include <iostream>
+#include <string_view>
+
+int main(int argc, char **argv) {
+  // Check command line arguments.
+  bool as_json(false);
+  if (argc == 3 && std::string_view(argv[2]) == "--json") {
+    as_json = true;
+  } else if (argc != 2) {
+    std::cerr << "Usage: journal_decoder <journal-file-name> [--json]\n";
+    return EXIT_FAILURE;
+  }
+
+  std::ifstream file(argv[1], std::ios::binary);
+  if (!file.is_open()) {
+    std::cerr << "Cannot open " << argv[1] << '\n';
+    return EXIT_FAILURE;
+  }
+  if (!journal::read_header(file)) {
+    std::cerr << argv[1] << " is not an event journal\n";
+    return EXIT_FAILURE;
+  }
+  size_t count(0);
+  journal::record next;
+  while (journal::read_record(file, next)) {
+    std::cout << (as_json ? journal::as_json(next) : journal::as_text(next))
+              << '\n';
+    ++count;
+  }
+  if (!file.eof()) {
+    std::cerr << "Truncated or corrupt record after " << count << " records\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
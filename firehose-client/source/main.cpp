@@ -33,25 +33,36 @@ http://www.fsf.org/licensing/licenses
 //
 //------------------------------------------------------------------------------
 
+#include "collection_plan.hpp"
+#include "common/activity/event_recorder.hpp"
+#include "common/activity/pile_on.hpp"
+#include "common/alloc_stats.hpp"
 #include "common/bluesky/async_loader.hpp"
 #include "common/config.hpp"
 #include "common/controller.hpp"
 #include "common/log_wrapper.hpp"
 #include "common/metrics_factory.hpp"
+#include "common/pipeline_timing.hpp"
 #if defined(__GNUC__)
 #include "common/activity/neo4j_adapter.hpp"
 #endif
 #include "common/moderation/ozone_adapter.hpp"
 #include "common/moderation/report_agent.hpp"
+#include "coordinated_actors.hpp"
 #include "datasource.hpp"
+#include "event_journal.hpp"
 #include "matcher.hpp"
 #include "moderation/action_router.hpp"
 #include "moderation/auxiliary_data.hpp"
 #include "moderation/embed_checker.hpp"
 #include "moderation/list_manager.hpp"
+#include "near_duplicates.hpp"
+#include "overload_policy.hpp"
 #include "parser.hpp"
+#include "partition.hpp"
 #include "payload.hpp"
 #include "project_defs.hpp"
+#include "subject_index.hpp"
 #include <chrono>
 #include <iostream>
 #include <thread>
@@ -87,6 +98,18 @@ int main(int argc, char **argv) {
 
     metrics_factory::instance().set_config(settings, PROJECT_NAME);
     parser::set_config(settings);
+    firehose::collection_plan::instance().set_config(
+        settings->get_config()[PROJECT_NAME]["collection_plan"]);
+    firehose::overload_policy::instance().set_config(
+        settings->get_config()[PROJECT_NAME]["overload_policy"]);
+    firehose::near_duplicate_detector::instance().set_config(
+        settings->get_config()[PROJECT_NAME]["near_duplicates"]);
+    firehose::coordination_detector::instance().set_config(
+        settings->get_config()[PROJECT_NAME]["coordinated_actors"]);
+    activity::pile_on_detector::instance().set_config(
+        settings->get_config()[PROJECT_NAME]["pile_on"]);
+    firehose::subject_tracker::instance().set_config(
+        settings->get_config()[PROJECT_NAME]["subject_index"]);
 
 #if _DEBUG
     restc_cpp::Logger::Instance().SetLogLevel(restc_cpp::LogLevel::WARNING);
@@ -133,60 +156,112 @@ int main(int argc, char **argv) {
           "realtime_alerts", "Alerts generated for possibly suspect activity");
       metrics_factory::instance().add_gauge(
           "process_operation", "Statistics about process internals");
+      pipeline::stage_timer::instance().register_metrics();
+      firehose::overload_policy::instance().register_metrics();
+      firehose::near_duplicate_detector::instance().register_metrics();
+      firehose::coordination_detector::instance().register_metrics();
+      activity::pile_on_detector::instance().register_metrics();
+      firehose::subject_tracker::instance().register_metrics();
+#if defined(ALLOC_STATS)
+      alloc_stats::recorder::instance().register_metrics();
+#endif
 
-      // seed database monitors before we start post-processing firehose
-      // messages
-      // requires poller thread
-      bsky::moderation::ozone_adapter::instance().start(
-          build_db_connection_string(
-              settings->get_config()[PROJECT_NAME]["moderation_data"]["db"]),
-          true);
+      // optional DID-partitioned deployment across processes
+      partition::router::instance().set_config(
+          settings->get_config()[PROJECT_NAME]["partition"]);
+      partition::router::instance().register_metrics();
+      if (partition::router::instance().get_role() == partition::role::worker) {
+        activity::event_recorder::instance().set_partition(
+            [](std::string const &did) {
+              return partition::router::instance().is_local(did);
+            },
+            [](activity::timed_event const &event, const bool low_history) {
+              partition::router::instance().forward_interaction(event,
+                                                                low_history);
+            },
+            [](std::string const &did) {
+              partition::router::instance().forward_alert(did);
+            });
+      }
+      // the ingest only routes frames, moderation work is done by the
+      // partition workers
+      const bool moderate(partition::router::instance().get_role() !=
+                          partition::role::ingest);
 
-      // prepare for Bluesky API calls
-      bsky::async_loader::instance().start(
-          settings->get_config()[PROJECT_NAME]["appview_client"]);
+      if (moderate) {
+        // seed database monitors before we start post-processing firehose
+        // messages
+        // requires poller thread
+        bsky::moderation::ozone_adapter::instance().start(
+            build_db_connection_string(
+                settings->get_config()[PROJECT_NAME]["moderation_data"]["db"]),
+            true);
 
-      // Matcher is shared by many classes. Loads from file or DB.
-      matcher::shared().set_config(
-          settings->get_config()[PROJECT_NAME]["filters"]);
+        // prepare for Bluesky API calls
+        bsky::async_loader::instance().start(
+            settings->get_config()[PROJECT_NAME]["appview_client"]);
+
+        // Matcher is shared by many classes. Loads from file or DB.
+        matcher::shared().set_config(
+            settings->get_config()[PROJECT_NAME]["filters"]);
+      }
 
-      // seeds matcher with rules
+      // seeds matcher with rules. In the ingest, only the rewind point.
       bsky::moderation::auxiliary_data::instance().start(
           settings->get_config()[PROJECT_NAME]["auxiliary_data"]);
       int64_t cursor(
           bsky::moderation::auxiliary_data::instance().get_rewind_point());
 
-      // wait for matcher and embed checker to be ready
-      do {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-      } while (!matcher::shared().is_ready() ||
-               !bsky::moderation::embed_checker::instance().is_ready());
+      if (moderate) {
+        // wait for matcher and embed checker to be ready
+        do {
+          std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        } while (!matcher::shared().is_ready() ||
+                 !bsky::moderation::embed_checker::instance().is_ready());
 
+        // structured record of moderation-relevant events, optional
+        journal::event_journal::instance().start(
+            settings->get_config()[PROJECT_NAME]["journal"]);
+      }
+
+      // reconnects resume after the last frame received
       datasource<firehose_payload>::instance().set_config(settings, cursor);
+      datasource<firehose_payload>::register_metrics();
       datasource<firehose_payload>::instance().start();
 
-      // prepare action handlers after we start processing firehose messages
-      // this is time consuming - allow a backlog for handlers while
-      // existing members load
-      bsky::moderation::report_agent::instance().start(
-          settings->get_config()[PROJECT_NAME]["auto_reporter"], PROJECT_NAME);
+      if (moderate) {
+        // prepare action handlers after we start processing firehose
+        // messages this is time consuming - allow a backlog for handlers
+        // while existing members load
+        bsky::moderation::report_agent::instance().start(
+            settings->get_config()[PROJECT_NAME]["auto_reporter"],
+            PROJECT_NAME);
 
-      action_router::instance().start();
+        action_router::instance().start();
 #if _DEBUG
-      // std::this_thread::sleep_for(std::chrono::milliseconds(10000000));
+        // std::this_thread::sleep_for(std::chrono::milliseconds(10000000));
 #endif
 
-      bsky::moderation::embed_checker::instance().set_config(
-          settings->get_config()[PROJECT_NAME]["embed_checker"]);
-      bsky::moderation::embed_checker::instance().start();
+        bsky::moderation::embed_checker::instance().set_config(
+            settings->get_config()[PROJECT_NAME]["embed_checker"]);
+        bsky::moderation::embed_checker::instance().start();
 
-      list_manager::instance().start(
-          settings->get_config()[PROJECT_NAME]["list_manager"]);
+        list_manager::instance().start(
+            settings->get_config()[PROJECT_NAME]["list_manager"]);
+      }
 
       // continue as long as firehose runs OK
       datasource<firehose_payload>::instance().wait_for_end_thread();
+      journal::event_journal::instance().stop();
     } else {
+      pipeline::stage_timer::instance().register_metrics();
+      // rules from file, they also determine the subscribed collections
+      matcher::shared().set_config(
+          settings->get_config()[PROJECT_NAME]["filters"]);
+
+      // live at startup, reconnects resume at the last event's time_us
       datasource<jetstream_payload>::instance().set_config(settings, 0);
+      datasource<jetstream_payload>::register_metrics();
       datasource<jetstream_payload>::instance().start();
 
       // continue as long as data feed runs OK
@@ -19,6 +19,8 @@ http://www.fsf.org/licensing/licenses
 *************************************************************************/
 
 #include "matcher.hpp"
+#include "collection_plan.hpp"
+#include "common/bluesky/platform.hpp"
 #include "common/helpers.hpp"
 #include "common/log_wrapper.hpp"
 #include "common/metrics_factory.hpp"
@@ -34,9 +36,15 @@ matcher::matcher() { _whole_word_trie.only_whole_words(); }
 
 // load from file, or wait for DB to load
 void matcher::set_config(const YAML::Node &filter_config) {
-  _use_db_for_rules = filter_config["use_db"].as<bool>();
+  _use_db_for_rules =
+      filter_config["use_db"] && filter_config["use_db"].as<bool>();
   if (!_use_db_for_rules) {
-    load_filter_file(filter_config["filename"].as<std::string>());
+    _filter_file = filter_config["filename"].as<std::string>();
+    std::error_code error;
+    _filter_file_time = std::filesystem::last_write_time(_filter_file, error);
+    load_filter_file(_filter_file);
+    _generation.fetch_add(1, std::memory_order_release);
+    _is_ready = true;
   }
 }
 
@@ -74,9 +82,56 @@ void matcher::refresh_rules(matcher &&replacement) {
   _rule_lookup.swap(replacement._rule_lookup);
   _substring_trie = std::move(replacement._substring_trie);
   _whole_word_trie = std::move(replacement._whole_word_trie);
+  _generation.fetch_add(1, std::memory_order_release);
   _is_ready = true;
 }
 
+bool matcher::reload_if_changed() {
+  if (_use_db_for_rules || _filter_file.empty())
+    return false;
+  std::error_code error;
+  auto const modified(std::filesystem::last_write_time(_filter_file, error));
+  {
+    std::lock_guard lock(_lock);
+    if (error || modified == _filter_file_time)
+      return false;
+    _filter_file_time = modified;
+  }
+  matcher replacement;
+  try {
+    replacement.load_filter_file(_filter_file);
+  } catch (std::exception const &exc) {
+    REL_ERROR("Rules reload from {} failed: {}", _filter_file, exc.what());
+    return false;
+  }
+  REL_INFO("Rules reloaded from {}", _filter_file);
+  refresh_rules(std::move(replacement));
+  return true;
+}
+
+std::set<std::string> matcher::wanted_collections() const {
+  std::set<std::string> collections;
+  {
+    std::lock_guard lock(_lock);
+    for (auto const &entry : _rule_lookup) {
+      if (entry.second._content_scope == rule::content_scope::profile) {
+        collections.insert(std::string(bsky::AppBskyActorProfile));
+      } else {
+        for (auto const &target : json::TargetFieldNames) {
+          collections.insert(std::string(target.first));
+        }
+        break;
+      }
+    }
+  }
+  // no point receiving what will not be decoded
+  std::erase_if(collections, [](std::string const &collection) {
+    return firehose::collection_plan::instance().plan_for(collection) ==
+           firehose::decode_plan::skip;
+  });
+  return collections;
+}
+
 bool matcher::add_rule(std::string const &match_rule) {
   return insert_rule(rule(match_rule));
 }
@@ -195,8 +250,9 @@ path_match_results matcher::all_matches_for_path_candidates(
   return results;
 }
 
-void matcher::report_if_needed(account_filter_matches &matches) {
-
+bsky::moderation::filter_matches
+matcher::decide_report(account_filter_matches const &matches,
+                       std::set<std::string> &block_lists) const {
   // iterate the match results for any rules that are marked
   // auto-reportable
   // reports may be at account or content-item scope
@@ -227,8 +283,7 @@ void matcher::report_if_needed(account_filter_matches &matches) {
           cid.clear();
         }
         if (!matched_rule._block_list_name.empty()) {
-          list_manager::instance().wait_enqueue(
-              {matches._did, matched_rule._block_list_name});
+          block_lists.insert(matched_rule._block_list_name);
         }
         // make sure the scope is correct for this match
         bool match_confirmed(false);
@@ -256,12 +311,24 @@ void matcher::report_if_needed(account_filter_matches &matches) {
     }
   }
 
+  return mapped_matches;
+}
+
+void matcher::report_if_needed(account_filter_matches &matches) {
+  std::set<std::string> block_lists;
+  bsky::moderation::filter_matches mapped_matches(
+      decide_report(matches, block_lists));
+  for (auto const &block_list_name : block_lists) {
+    list_manager::instance().wait_enqueue(
+        {matches._did, block_list_name, matches._ingested});
+  }
+
   // report the account and content as needed. All entries are non-empty, by
   // construction.
   if (!mapped_matches._scoped_matches.empty()) {
     bsky::moderation::report_agent::instance().wait_enqueue(
-        bsky::moderation::account_report(matches._did,
-                                         std::move(mapped_matches)));
+        bsky::moderation::account_report(
+            matches._did, std::move(mapped_matches), matches._ingested));
   }
 }
 
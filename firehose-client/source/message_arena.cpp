@@ -0,0 +1,56 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "message_arena.hpp"
+#include "common/metrics_factory.hpp"
+
+message_arena_pool &message_arena_pool::instance() {
+  static message_arena_pool my_instance;
+  return my_instance;
+}
+
+message_arena::handle message_arena_pool::acquire() {
+  message_arena *arena(nullptr);
+  if (_pool.try_dequeue(arena)) {
+    _pooled.fetch_sub(1, std::memory_order_relaxed);
+    return message_arena::handle(arena);
+  }
+  metrics_factory::instance()
+      .get_gauge("process_operation")
+      .Get({{"message_arena", "allocated"}})
+      .Increment();
+  return message_arena::handle(new message_arena);
+}
+
+void message_arena_pool::release(message_arena *arena) {
+  if (!arena)
+    return;
+  arena->reset();
+  if (_pooled.fetch_add(1, std::memory_order_relaxed) < MaxPooled &&
+      _pool.enqueue(arena)) {
+    return;
+  }
+  _pooled.fetch_sub(1, std::memory_order_relaxed);
+  metrics_factory::instance()
+      .get_gauge("process_operation")
+      .Get({{"message_arena", "allocated"}})
+      .Decrement();
+  delete arena;
+}
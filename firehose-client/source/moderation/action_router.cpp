@@ -43,6 +43,8 @@ void action_router::start() {
           .get_gauge("process_operation")
           .Get({{"action_router", "backlog"}})
           .Decrement();
+      pipeline::stage_timer::instance().record(pipeline::stage::action_router,
+                                               matches._ingested);
       matcher::shared().report_if_needed(matches);
     }
     REL_INFO("action_router stopping");
@@ -22,6 +22,7 @@ http://www.fsf.org/licensing/licenses
 #include "common/log_wrapper.hpp"
 #include "matcher.hpp"
 #include "moderation/embed_checker.hpp"
+#include "partition.hpp"
 
 namespace bsky {
 namespace moderation {
@@ -31,7 +32,12 @@ void auxiliary_data::start(YAML::Node const &settings) {
   // stoppage
 
   _connection_string = build_db_connection_string(settings["db"]);
-  _enable_rewind = settings["enable_rewind"].as<bool>(false);
+  // when partitioned, the ingest owns the rewind point and the workers use
+  // the match filters and popular hosts
+  const partition::role role(partition::router::instance().get_role());
+  _enable_rewind = role != partition::role::worker &&
+                   settings["enable_rewind"].as<bool>(false);
+  _refresh_moderation_data = role != partition::role::ingest;
   try {
     _cx = std::make_unique<pqxx::connection>(_connection_string);
     REL_INFO("Connected OK to auxiliary DB: {}", safe_connection_string());
@@ -49,11 +55,13 @@ void auxiliary_data::start(YAML::Node const &settings) {
         }
         // update firehose checkpoint regularly
         check_rewind_point();
-        // load/refresh string match filters
-        update_match_filters();
-        // load/refresh string popular hosts used in embed:external and other
-        // places
-        update_popular_hosts();
+        if (_refresh_moderation_data) {
+          // load/refresh string match filters
+          update_match_filters();
+          // load/refresh string popular hosts used in embed:external and
+          // other places
+          update_popular_hosts();
+        }
       } catch (pqxx::broken_connection const &exc) {
         // will reconnect on net loop
         REL_ERROR("pqxx::broken_connection {}", exc.what());
@@ -78,6 +86,7 @@ void auxiliary_data::prepare_statements() {
 
 void auxiliary_data::update_rewind_point(const int64_t seq,
                                          const std::string &emitted_at) {
+  _last_processed.store(seq, std::memory_order_relaxed);
   if (!_enable_rewind)
     return;
   // TODO should be safe but not guaranteed always accurate for lock-free read
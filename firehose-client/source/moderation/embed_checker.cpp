@@ -380,7 +380,7 @@ void embed_handler::operator()(embed::external const &value) {
 
 bool embed_handler::on_url_redirect(int code, std::string &url,
                                     const restc_cpp::Reply &reply) {
-  REL_INFO("Redirect code {} for {}", code, url);
+  REL_INFO_LIMITED(100, 100, "Redirect code {} for {}", code, url);
   _uri_chain.emplace_back(url);
   // already processed, or whitelisted
   if (_checker.uri_seen(_repo, _path, url) ||
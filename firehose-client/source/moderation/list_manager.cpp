@@ -123,6 +123,8 @@ void list_manager::start(YAML::Node const &settings) {
               .get_gauge("process_operation")
               .Get({{"list_manager", "backlog"}})
               .Decrement();
+          pipeline::stage_timer::instance().record(
+              pipeline::stage::list_manager, to_block._ingested);
 
           // do not process if whitelisted
           if (bsky::moderation::ozone_adapter::instance().already_processed(
@@ -0,0 +1,102 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "near_duplicates.hpp"
+#include "common/config.hpp"
+#include "common/log_wrapper.hpp"
+#include "common/metrics_factory.hpp"
+#include <stdexcept>
+
+namespace firehose {
+
+near_duplicate_detector &near_duplicate_detector::instance() {
+  static near_duplicate_detector my_instance;
+  return my_instance;
+}
+
+void near_duplicate_detector::set_config(YAML::Node const &settings) {
+  if (!settings.IsDefined())
+    return;
+  const std::chrono::milliseconds window(
+      setting_or(settings, "window_ms", std::chrono::milliseconds(3600000)));
+  const size_t max_posts(setting_or<size_t>(settings, "max_posts", 200000));
+  const size_t cluster_accounts(
+      setting_or<size_t>(settings, "cluster_accounts", 5));
+  const size_t min_shingles(
+      setting_or(settings, "min_shingles", _min_shingles));
+  if (window.count() <= 0 || max_posts == 0 || cluster_accounts < 2) {
+    throw std::invalid_argument(
+        "near_duplicates needs window_ms > 0, max_posts > 0 and "
+        "cluster_accounts >= 2");
+  }
+  _min_shingles = min_shingles;
+  _index = std::make_unique<near_duplicate_index>(window, max_posts,
+                                                  cluster_accounts);
+  REL_INFO("Near-duplicate detection: {} accounts within {} ms, up to {} "
+           "posts, at least {} shingles",
+           cluster_accounts, window.count(), max_posts, _min_shingles);
+}
+
+void near_duplicate_detector::register_metrics() {
+  auto &outcomes(metrics_factory::instance().add_counter(
+      "near_duplicates", "Near-duplicate post detection by outcome"));
+  _checked = &outcomes.Add({{"post", "checked"}});
+  _skipped = &outcomes.Add({{"post", "too_short"}});
+  _clusters = &outcomes.Add({{"cluster", "flagged"}});
+  _flagged = &outcomes.Add({{"account", "flagged"}});
+  auto &index(metrics_factory::instance().add_gauge(
+      "near_duplicate_index", "Size of the near-duplicate post index"));
+  _posts = &index.Add({{"index", "posts"}});
+  _buckets = &index.Add({{"index", "buckets"}});
+}
+
+near_duplicate_index::cluster
+near_duplicate_detector::check(std::string const &did,
+                               std::string_view text,
+                               const bsky::time_stamp emitted_at) {
+  if (!_index)
+    return {};
+  text_signature signature(text_signature::of(text));
+  if (signature._shingles < _min_shingles) {
+    if (_skipped)
+      _skipped->Increment();
+    return {};
+  }
+  near_duplicate_index::cluster result(
+      _index->add(did, signature._minhashes, emitted_at));
+  if (_checked) {
+    _checked->Increment();
+    _posts->Set(static_cast<double>(_index->posts()));
+    _buckets->Set(static_cast<double>(_index->buckets()));
+  }
+  // a newly flagged cluster lists every member, a late joiner only itself
+  if (result._flag.size() > 1) {
+    REL_INFO("Near-duplicate cluster of {} accounts from {}",
+             result._accounts, did);
+    if (_clusters)
+      _clusters->Increment();
+  }
+  if (_flagged && !result._flag.empty()) {
+    _flagged->Increment(static_cast<double>(result._flag.size()));
+  }
+  return result;
+}
+
+} // namespace firehose
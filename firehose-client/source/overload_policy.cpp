@@ -0,0 +1,112 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "overload_policy.hpp"
+#include "common/config.hpp"
+#include "common/log_wrapper.hpp"
+#include "common/metrics_factory.hpp"
+#include "common/pipeline_timing.hpp"
+#include <stdexcept>
+
+namespace firehose {
+
+std::string_view to_string(const sheddable work) {
+  switch (work) {
+  case sheddable::social_graph:
+    return "social_graph";
+  case sheddable::coordination:
+    return "coordination";
+  case sheddable::facet_metrics:
+    return "facet_metrics";
+  case sheddable::language_metrics:
+  default:
+    return "language_metrics";
+  }
+}
+
+overload_policy &overload_policy::instance() {
+  static overload_policy my_instance;
+  return my_instance;
+}
+
+void overload_policy::set_config(YAML::Node const &settings) {
+  if (!settings.IsDefined())
+    return;
+  // validated before any setting is changed
+  const std::chrono::milliseconds shed_lag(
+      setting_or(settings, "shed_lag_ms", _shed_lag));
+  const std::chrono::milliseconds recover_lag(
+      setting_or(settings, "recover_lag_ms", _recover_lag));
+  const size_t keep_one_in(setting_or(settings, "keep_one_in", _keep_one_in));
+  if (keep_one_in == 0 || recover_lag > shed_lag) {
+    throw std::invalid_argument(
+        "overload_policy needs keep_one_in > 0 and recover_lag_ms <= "
+        "shed_lag_ms");
+  }
+  _shed_lag = shed_lag;
+  _recover_lag = recover_lag;
+  _keep_one_in = keep_one_in;
+  _enabled = true;
+  REL_INFO("Overload policy: shed above {} ms lag, recover below {} ms, keep "
+           "1 in {}",
+           _shed_lag.count(), _recover_lag.count(), _keep_one_in);
+}
+
+void overload_policy::register_metrics() {
+  auto &shed(metrics_factory::instance().add_counter(
+      "firehose_shed", "Work skipped by the overload policy"));
+  for (size_t index = 0; index < _shed.size(); ++index) {
+    _shed[index] = &shed.Add(
+        {{"work", std::string(to_string(static_cast<sheddable>(index)))}});
+  }
+  _transitions = &shed.Add({{"overload", "episodes"}});
+  _state = &metrics_factory::instance()
+                .add_gauge("firehose_overloaded",
+                           "1 while the overload policy is shedding work")
+                .Add({});
+}
+
+bool overload_policy::admit(const sheddable work) {
+  if (!_enabled)
+    return true;
+  auto lag(pipeline::stage_timer::instance().lag());
+  if (_overloaded ? lag < _recover_lag : lag > _shed_lag) {
+    _overloaded = !_overloaded;
+    REL_WARNING("Overload policy {}, lag {} ms",
+                _overloaded ? "shedding" : "recovered", lag.count());
+    if (_state) {
+      _state->Set(_overloaded ? 1.0 : 0.0);
+    }
+    if (_overloaded && _transitions) {
+      _transitions->Increment();
+    }
+  }
+  if (!_overloaded)
+    return true;
+  const size_t index(static_cast<size_t>(work));
+  if (_seen[index]++ % _keep_one_in == 0)
+    return true;
+  if (_shed[index]) {
+    _shed[index]->Increment();
+  }
+  return false;
+}
+
+} // namespace firehose
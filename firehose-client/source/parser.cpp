@@ -20,9 +20,13 @@ http://www.fsf.org/licensing/licenses
 
 #include "parser.hpp"
 #include "common/helpers.hpp"
+#include "common/pipeline_timing.hpp"
 #include "common/rest_utils.hpp"
 #include "datasource.hpp"
+#include "partition.hpp"
+#include "simdjson.h"
 #include <boost/asio/buffers_iterator.hpp>
+#include <cstring>
 #include <sstream>
 
 std::shared_ptr<config> parser::_settings;
@@ -45,12 +49,94 @@ parser::get_candidates_from_flat_buffer(beast::flat_buffer const &beast_data) {
     }
     return {};
   } else {
-    nlohmann::json full_json(
-        nlohmann::json::parse(buffers_begin(buffer), buffers_end(buffer)));
-    return get_candidates_from_json(full_json);
+    // websocket frame is a single contiguous buffer
+    return get_candidates_from_jetstream(
+        static_cast<char const *>(buffer.data()), buffer.size());
   }
 }
 
+// Read only what is needed to qualify a Jetstream frame and extract its match
+// targets, on demand from the raw text. Nothing is built for frames that
+// cannot match. Must agree with get_candidates_from_json.
+candidate_list parser::get_candidates_from_jetstream(char const *data,
+                                                     const size_t length) {
+  // field name and pointer relative to the frame root, by record type
+  typedef std::vector<std::pair<std::string, std::string>> field_pointers;
+  static const std::map<std::string_view, field_pointers, std::less<>>
+      frame_pointers([]() {
+        std::map<std::string_view, field_pointers, std::less<>> pointers;
+        for (auto const &target : json::TargetFieldNames) {
+          auto &fields(pointers[target.first]);
+          for (auto const &field : target.second) {
+            fields.emplace_back(field.to_string(),
+                                "/commit/record" + field.to_string());
+          }
+        }
+        return pointers;
+      }());
+  // reused per thread, simdjson reads past the end of the input
+  thread_local simdjson::ondemand::parser frame_parser;
+  thread_local std::string padded;
+  if (padded.size() < length + simdjson::SIMDJSON_PADDING) {
+    padded.resize(length + simdjson::SIMDJSON_PADDING);
+  }
+  std::memcpy(padded.data(), data, length);
+
+  try {
+    simdjson::ondemand::document frame(
+        frame_parser.iterate(padded.data(), length, padded.size()));
+    // Jetstream stamps every event, lag drives catch-up and overload handling
+    int64_t time_us(0);
+    if (frame["time_us"].get_int64().get(time_us) == simdjson::SUCCESS) {
+      pipeline::stage_timer::instance().record_lag(bsky::time_stamp(
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::microseconds(time_us))));
+    }
+    std::string_view kind(frame["kind"].get_string());
+    // handle updates
+    if (kind == "identity") {
+      std::string_view handle;
+      if (frame["identity"]["handle"].get_string().get(handle) ==
+          simdjson::SUCCESS) {
+        return {{"identity", "handle", std::string(handle)}};
+      }
+      return {};
+    }
+
+    // other than handles, only interested in commits
+    if (kind != "commit")
+      return {};
+
+    simdjson::ondemand::object commit(frame["commit"].get_object());
+    // Skip deletions
+    std::string_view operation(commit["operation"].get_string());
+    if (operation == "delete")
+      return {};
+
+    auto const record_fields(
+        frame_pointers.find(std::string_view(commit["collection"])));
+    if (record_fields == frame_pointers.cend())
+      return {};
+    // each lookup rewinds the document and reuses its string buffer, so
+    // values are copied out as they are found. Values are re-serialized as
+    // nlohmann would, get_candidates_from_record matches the JSON form.
+    candidate_list results;
+    for (auto const &field : record_fields->second) {
+      std::string_view value;
+      if (frame.at_pointer(field.second).get_string().get(value) ==
+          simdjson::SUCCESS) {
+        results.emplace_back(std::string(record_fields->first), field.first,
+                             nlohmann::to_string(nlohmann::json(value)));
+      }
+    }
+    return results;
+  } catch (simdjson::simdjson_error const &exc) {
+    REL_ERROR("Error {} processing JSON\n{}", exc.what(),
+              std::string_view(data, length));
+  }
+  return {};
+}
+
 candidate_list
 parser::get_candidates_from_record(nlohmann::json const &record) {
   auto record_type(record["$type"].template get<std::string>());
@@ -89,7 +175,7 @@ parser::get_candidates_from_json(nlohmann::json &full_json) const {
     if (full_json["kind"] != "commit")
       return {};
 
-    auto commit(full_json["commit"]);
+    auto &commit(full_json["commit"]);
     // Skip deletions
     if (commit["operation"] == "delete")
       return {};
@@ -101,16 +187,13 @@ parser::get_candidates_from_json(nlohmann::json &full_json) const {
   return {};
 }
 
-inline bool parser::cbor_callback(int /* depth */,
+inline bool parser::cbor_callback(int depth,
                                   nlohmann::json::parse_event_t event,
                                   nlohmann::json &parsed) {
   if (event == nlohmann::json::parse_event_t::result) {
     // Check for "roots" and decode embedded CIDs is found
     if (parsed.contains("roots")) {
       DBG_TRACE("JSON roots  {}", parsed.dump());
-    } else if (parsed.contains("__readable_cid__")) {
-      // DBG_TRACE("JSON block cid {}", parsed.dump());
-      _block_cid = parsed["__readable_cid__"].template get<std::string>();
     } else {
       DBG_TRACE("JSON Result  {}", parsed.dump());
       if (parsed.contains("$type")) {
@@ -126,7 +209,7 @@ inline bool parser::cbor_callback(int /* depth */,
           // block may contains string-matching content
           if (!_cids.insert(_block_cid).second) {
             REL_ERROR("Matchable Block CID {} already stored, block={}",
-                      _block_cid, parsed.dump());
+                      _block_cid.to_string(), parsed.dump());
             return false;
           }
           _matchable_cbors.emplace_back(_block_cid, std::move(parsed));
@@ -134,7 +217,7 @@ inline bool parser::cbor_callback(int /* depth */,
           // Also store other typed CBORs.
           if (!_cids.insert(_block_cid).second) {
             REL_ERROR("Content Block CID {} already stored, block={}",
-                      _block_cid, parsed.dump());
+                      _block_cid.to_string(), parsed.dump());
             return false;
           }
           _content_cbors.emplace_back(_block_cid, std::move(parsed));
@@ -144,6 +227,18 @@ inline bool parser::cbor_callback(int /* depth */,
       }
     }
   } else if (event == nlohmann::json::parse_event_t::key) {
+    // minimal decode discards other top-level fields, value is not built
+    if (depth == 1 && _block_plan == firehose::decode_plan::minimal &&
+        !firehose::collection_plan::is_minimal_field(
+            parsed.template get_ref<std::string const &>())) {
+      return false;
+    }
+    // blocks, ops and the rest are left for the partition worker
+    if (depth == 1 && _route_only &&
+        !partition::is_routing_field(
+            parsed.template get_ref<std::string const &>())) {
+      return false;
+    }
     DBG_TRACE("JSON Key     {}", parsed.dump());
   } else if (event == nlohmann::json::parse_event_t::value) {
     DBG_TRACE("JSON Value   {}", parsed.dump());
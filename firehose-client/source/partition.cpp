@@ -0,0 +1,512 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "partition.hpp"
+#include "common/controller.hpp"
+#include "common/log_wrapper.hpp"
+#include "common/metrics_factory.hpp"
+#include <boost/asio/read.hpp>
+#include <boost/asio/spawn.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/write.hpp>
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace partition {
+
+namespace {
+template <typename T> void put(std::ostream &os, const T value) {
+  static_assert(std::is_integral<T>::value, "T must be an integral type");
+  using unsigned_type = std::make_unsigned_t<T>;
+  unsigned_type raw(static_cast<unsigned_type>(value));
+  for (size_t byte = 0; byte < sizeof(T); ++byte) {
+    os.put(static_cast<char>(raw & 0xFF));
+    raw = static_cast<unsigned_type>(raw >> 8);
+  }
+}
+
+template <typename T> bool get(std::istream &is, T &value) {
+  static_assert(std::is_integral<T>::value, "T must be an integral type");
+  using unsigned_type = std::make_unsigned_t<T>;
+  unsigned_type raw(0);
+  for (size_t byte = 0; byte < sizeof(T); ++byte) {
+    int next(is.get());
+    if (next == std::char_traits<char>::eof())
+      return false;
+    raw |= static_cast<unsigned_type>(static_cast<unsigned_type>(next & 0xFF)
+                                      << (8 * byte));
+  }
+  value = static_cast<T>(raw);
+  return true;
+}
+
+// DIDs, record keys and at-uris, all short
+void put_string(std::ostream &os, std::string_view value) {
+  put(os, static_cast<uint16_t>(value.length()));
+  os.write(value.data(), value.length());
+}
+
+bool get_string(std::istream &is, std::string &value) {
+  uint16_t length(0);
+  if (!get(is, length))
+    return false;
+  value.resize(length);
+  return static_cast<bool>(is.read(value.data(), length));
+}
+
+// the variable part of each interaction, in declaration order
+struct interaction_writer {
+  std::ostream &_os;
+  template <typename T> void operator()(T const &) {}
+  void operator()(activity::reply const &value) {
+    put_string(_os, value._reply);
+    put_string(_os, std::string(value._root));
+    put_string(_os, std::string(value._parent));
+  }
+  void operator()(activity::repost const &value) {
+    put_string(_os, value._repost);
+    put_string(_os, std::string(value._post));
+  }
+  void operator()(activity::quote const &value) {
+    put_string(_os, value._quote);
+    put_string(_os, std::string(value._post));
+  }
+  void operator()(activity::follow const &value) {
+    put_string(_os, value._follow);
+    put_string(_os, value._followed);
+  }
+  void operator()(activity::block const &value) {
+    put_string(_os, value._block);
+    put_string(_os, value._blocked);
+  }
+  void operator()(activity::like const &value) {
+    put_string(_os, value._like);
+    put_string(_os, std::string(value._content));
+  }
+  void operator()(activity::deleted const &value) {
+    put_string(_os, value._path);
+    put_string(_os, value._subject);
+  }
+};
+
+struct target_finder {
+  std::vector<std::string> &_targets;
+  template <typename T> void operator()(T const &) {}
+  void operator()(activity::reply const &value) {
+    _targets.push_back(value._root._authority);
+    _targets.push_back(value._parent._authority);
+  }
+  void operator()(activity::repost const &value) {
+    _targets.push_back(value._post._authority);
+  }
+  void operator()(activity::quote const &value) {
+    _targets.push_back(value._post._authority);
+  }
+  void operator()(activity::follow const &value) {
+    _targets.push_back(value._followed);
+  }
+  void operator()(activity::block const &value) {
+    _targets.push_back(value._blocked);
+  }
+  void operator()(activity::like const &value) {
+    _targets.push_back(value._content._authority);
+  }
+  // the target's counts are undone where they were made
+  void operator()(activity::deleted const &value) {
+    if (value._subject.empty())
+      return;
+    if (starts_with(value._path, bsky::AppBskyFeedLike) ||
+        starts_with(value._path, bsky::AppBskyFeedRepost)) {
+      _targets.push_back(atproto::at_uri(value._subject)._authority);
+    } else if (starts_with(value._path, bsky::AppBskyGraphFollow) ||
+               starts_with(value._path, bsky::AppBskyGraphBlock)) {
+      _targets.push_back(value._subject);
+    }
+  }
+};
+
+// position of T in the event variant, some alternatives have no default
+// constructor
+template <typename T, typename... ALTERNATIVES>
+constexpr uint8_t index_in(std::variant<ALTERNATIVES...> const *) {
+  uint8_t index(0);
+  bool found(false);
+  ((found = found || std::is_same_v<T, ALTERNATIVES>, index += found ? 0 : 1),
+   ...);
+  return index;
+}
+template <typename T> constexpr uint8_t index_of() {
+  return index_in<T>(static_cast<activity::event const *>(nullptr));
+}
+} // namespace
+
+std::vector<std::string> targets_of(activity::event const &event) {
+  std::vector<std::string> targets;
+  std::visit(target_finder{targets}, event);
+  return targets;
+}
+
+std::string encode_interaction(activity::timed_event const &event,
+                               const bool low_history) {
+  std::ostringstream body;
+  put(body, static_cast<uint8_t>(event._event.index()));
+  put_string(body, event._did);
+  put(body, static_cast<int64_t>(event._created_at.time_since_epoch().count()));
+  put(body, static_cast<uint8_t>(low_history ? 1 : 0));
+  std::visit(interaction_writer{body}, event._event);
+  return body.str();
+}
+
+bool decode_interaction(std::string_view data, activity::timed_event &event) {
+  std::istringstream body{std::string(data)};
+  uint8_t index(0);
+  int64_t created_at(0);
+  uint8_t low_history(0);
+  if (!get(body, index) || !get_string(body, event._did) ||
+      !get(body, created_at) || !get(body, low_history))
+    return false;
+  event._created_at =
+      bsky::time_stamp(std::chrono::milliseconds(created_at));
+  event._low_history = low_history != 0;
+  std::string first;
+  std::string second;
+  // all but target_alert name the record and the account or record targeted
+  if (index != index_of<activity::target_alert>() &&
+      (!get_string(body, first) || !get_string(body, second)))
+    return false;
+  switch (index) {
+  case index_of<activity::reply>(): {
+    std::string parent;
+    if (!get_string(body, parent))
+      return false;
+    event._event = activity::reply{first, atproto::at_uri(second),
+                                   atproto::at_uri(parent)};
+    break;
+  }
+  case index_of<activity::repost>():
+    event._event = activity::repost{first, atproto::at_uri(second)};
+    break;
+  case index_of<activity::quote>():
+    event._event = activity::quote{first, atproto::at_uri(second)};
+    break;
+  case index_of<activity::follow>():
+    event._event = activity::follow{first, second};
+    break;
+  case index_of<activity::block>():
+    event._event = activity::block{first, second};
+    break;
+  case index_of<activity::like>():
+    event._event = activity::like{first, atproto::at_uri(second)};
+    break;
+  case index_of<activity::deleted>():
+    event._event = activity::deleted{first, second};
+    break;
+  case index_of<activity::target_alert>():
+    event._event = activity::target_alert();
+    break;
+  default:
+    return false;
+  }
+  event._forwarded = true;
+  return true;
+}
+
+router &router::instance() {
+  static router my_instance;
+  return my_instance;
+}
+
+void router::set_config(YAML::Node const &settings) {
+  if (!settings.IsDefined())
+    return;
+  std::string const role_name(settings["role"].as<std::string>());
+  if (role_name == "ingest") {
+    _role = role::ingest;
+  } else if (role_name == "worker") {
+    _role = role::worker;
+    _index = settings["index"].as<uint32_t>();
+  } else {
+    throw std::invalid_argument("Invalid partition role " + role_name);
+  }
+  _workers = settings["workers"].as<uint32_t>();
+  _socket_path = settings["socket_path"].as<std::string>();
+  if (_workers == 0 || (_role == role::worker && _index >= _workers)) {
+    throw std::invalid_argument("partition index must be below workers");
+  }
+  for (uint32_t index = 0; index < _workers; ++index) {
+    _peers.emplace_back(std::make_unique<peer>(socket_for(index)));
+  }
+  REL_INFO("Partition role {} index {} of {} workers at {}", role_name,
+           _index, _workers, _socket_path);
+}
+
+void router::register_metrics() {
+  if (_role == role::single)
+    return;
+  metrics_factory::instance().add_counter(
+      "partition_messages", "Messages between partitioned processes");
+  auto &messages(metrics_factory::instance().get_counter("partition_messages"));
+  for (uint32_t index = 0; index < _peers.size(); ++index) {
+    std::string const partition(std::to_string(index));
+    _peers[index]->_frames =
+        &messages.Add({{"partition", partition}, {"sent", "frame"}});
+    _peers[index]->_interactions =
+        &messages.Add({{"partition", partition}, {"sent", "interaction"}});
+    _peers[index]->_dropped =
+        &messages.Add({{"partition", partition}, {"sent", "dropped"}});
+    _peers[index]->_retried =
+        &messages.Add({{"partition", partition}, {"sent", "retried"}});
+  }
+}
+
+std::string router::socket_for(const uint32_t index) const {
+  return _socket_path + '.' + std::to_string(index);
+}
+
+bool router::route_frame(std::string_view did,
+                         boost::beast::flat_buffer const &frame) {
+  auto data(frame.data());
+  std::string_view const body(static_cast<const char *>(data.data()),
+                              data.size());
+  const uint32_t owner(owner_of(did, _workers));
+  // the worker's frames wait in the relay until it is back, none are lost
+  while (!send(owner, message_kind::frame, body)) {
+    _peers[owner]->_retried->Increment();
+    if (!controller::instance().is_active())
+      return false;
+    std::this_thread::sleep_for(ReconnectHoldOff);
+  }
+  return true;
+}
+
+void router::forward_interaction(activity::timed_event const &event,
+                                 const bool low_history) {
+  if (_role != role::worker || event._forwarded)
+    return;
+  std::vector<std::string> targets(targets_of(event._event));
+  std::string encoded;
+  std::vector<uint32_t> sent;
+  for (auto const &target : targets) {
+    const uint32_t owner(owner_of(target, _workers));
+    if (owner == _index ||
+        std::find(sent.cbegin(), sent.cend(), owner) != sent.cend())
+      continue;
+    if (encoded.empty()) {
+      encoded = encode_interaction(event, low_history);
+    }
+    if (!send(owner, message_kind::interaction, encoded)) {
+      _peers[owner]->_dropped->Increment();
+    }
+    sent.push_back(owner);
+  }
+}
+
+void router::forward_alert(std::string const &actor) {
+  if (_role != role::worker)
+    return;
+  const uint32_t owner(owner_of(actor, _workers));
+  if (!send(owner, message_kind::interaction,
+            encode_interaction(
+                {actor, bsky::current_time(), activity::target_alert()},
+                false))) {
+    _peers[owner]->_dropped->Increment();
+  }
+}
+
+bool router::send(const uint32_t partition, const message_kind kind,
+                  std::string_view body) {
+  peer &target(*_peers[partition]);
+  std::lock_guard guard(target._lock);
+  boost::system::error_code ec;
+  if (!target._socket.is_open()) {
+    auto now(std::chrono::steady_clock::now());
+    if (now < target._retry_after)
+      return false;
+    target._socket.connect(
+        boost::asio::local::stream_protocol::endpoint(target._path), ec);
+    if (ec) {
+      REL_WARNING("Partition {} connect to {} failed: {}", partition,
+                  target._path, ec.message());
+      target._socket.close();
+      target._retry_after = now + ReconnectHoldOff;
+      return false;
+    }
+  }
+  std::array<uint8_t, 5> header = {static_cast<uint8_t>(kind)};
+  const uint32_t length(static_cast<uint32_t>(body.length()));
+  for (size_t byte = 0; byte < sizeof(length); ++byte) {
+    header[1 + byte] = static_cast<uint8_t>((length >> (8 * byte)) & 0xFF);
+  }
+  std::array<boost::asio::const_buffer, 2> buffers = {
+      boost::asio::buffer(header), boost::asio::buffer(body)};
+  boost::asio::write(target._socket, buffers, ec);
+  if (ec) {
+    REL_WARNING("Partition {} send failed: {}", partition, ec.message());
+    target._socket.close();
+    return false;
+  }
+  (kind == message_kind::frame ? target._frames : target._interactions)
+      ->Increment();
+  return true;
+}
+
+void router::serve(
+    std::function<void(boost::beast::flat_buffer const &)> const &on_frame,
+    std::function<bool()> const &saturated) {
+  typedef boost::asio::local::stream_protocol::socket socket_type;
+  boost::asio::io_context ioc;
+  std::string const path(socket_for(_index));
+  // left behind by a previous run
+  std::filesystem::remove(path);
+  boost::asio::local::stream_protocol::acceptor acceptor(
+      ioc, boost::asio::local::stream_protocol::endpoint(path));
+  REL_INFO("Partition {} listening on {}", _index, path);
+
+  auto &received(metrics_factory::instance().get_counter("partition_messages"));
+  prometheus::Counter &frames(received.Add({{"received", "frame"}}));
+  prometheus::Counter &interactions(
+      received.Add({{"received", "interaction"}}));
+  prometheus::Counter &rejected(received.Add({{"received", "rejected"}}));
+
+  // open connections, closed along with the acceptor when the process stops
+  // so that pending reads and accepts complete and ioc.run() returns
+  std::vector<std::weak_ptr<socket_type>> connections;
+  boost::asio::steady_timer stop_check(ioc);
+  std::function<void(boost::system::error_code)> check_stop =
+      [&](boost::system::error_code) {
+        if (controller::instance().is_active()) {
+          stop_check.expires_after(StopCheckInterval);
+          stop_check.async_wait(check_stop);
+          return;
+        }
+        boost::system::error_code ignored;
+        acceptor.close(ignored);
+        for (auto const &entry : connections) {
+          if (auto socket = entry.lock()) {
+            socket->close(ignored);
+          }
+        }
+      };
+  check_stop({});
+
+  // one coroutine per connection, from ingest or a peer worker
+  auto connection = [&](std::shared_ptr<socket_type> socket,
+                        boost::asio::yield_context yield) {
+    boost::system::error_code ec;
+    while (controller::instance().is_active()) {
+      std::array<uint8_t, 5> header;
+      boost::asio::async_read(*socket, boost::asio::buffer(header), yield[ec]);
+      if (ec)
+        break;
+      uint32_t length(0);
+      for (size_t byte = 0; byte < sizeof(length); ++byte) {
+        length |= static_cast<uint32_t>(header[1 + byte]) << (8 * byte);
+      }
+      if (length > MaxMessage) {
+        REL_ERROR("Partition message length {} too large", length);
+        break;
+      }
+      boost::beast::flat_buffer body;
+      body.commit(boost::asio::async_read(*socket, body.prepare(length),
+                                          yield[ec]));
+      if (ec)
+        break;
+      if (header[0] == static_cast<uint8_t>(message_kind::frame)) {
+        frames.Increment();
+        on_frame(body);
+        // Only the ingest sends frames. Holding its connection lets the
+        // socket buffer push back, so the ingest blocks in route_frame.
+        if (saturated()) {
+          boost::asio::steady_timer poll(ioc);
+          boost::system::error_code wait_ec;
+          while (saturated() && controller::instance().is_active()) {
+            poll.expires_after(ReadPausePoll);
+            poll.async_wait(yield[wait_ec]);
+          }
+        }
+      } else if (header[0] ==
+                 static_cast<uint8_t>(message_kind::interaction)) {
+        activity::timed_event event;
+        auto data(body.data());
+        if (decode_interaction(
+                std::string_view(static_cast<const char *>(data.data()),
+                                 data.size()),
+                event)) {
+          interactions.Increment();
+          _inbox.enqueue(std::move(event));
+        } else {
+          rejected.Increment();
+        }
+      } else {
+        rejected.Increment();
+      }
+    }
+    if (ec && ec != boost::asio::error::eof &&
+        ec != boost::asio::error::operation_aborted &&
+        controller::instance().is_active()) {
+      REL_WARNING("Partition connection error: {}", ec.message());
+    }
+  };
+
+  boost::asio::spawn(
+      ioc,
+      [&](boost::asio::yield_context yield) {
+        boost::system::error_code ec;
+        boost::asio::steady_timer hold_off(ioc);
+        while (controller::instance().is_active()) {
+          auto socket(std::make_shared<socket_type>(ioc));
+          acceptor.async_accept(*socket, yield[ec]);
+          if (ec == boost::asio::error::operation_aborted)
+            break;
+          if (ec) {
+            REL_ERROR_LIMITED(10, 0, "Partition accept error: {}",
+                              ec.message());
+            hold_off.expires_after(AcceptHoldOff);
+            hold_off.async_wait(yield[ec]);
+            continue;
+          }
+          std::erase_if(connections,
+                        [](std::weak_ptr<socket_type> const &entry) {
+                          return entry.expired();
+                        });
+          connections.push_back(socket);
+          boost::asio::spawn(
+              ioc,
+              [&connection, socket](boost::asio::yield_context yield) {
+                connection(socket, yield);
+              },
+              [](std::exception_ptr ex) {
+                if (ex)
+                  std::rethrow_exception(ex);
+              });
+        }
+      },
+      [](std::exception_ptr ex) {
+        if (ex)
+          std::rethrow_exception(ex);
+      });
+  ioc.run();
+}
+
+} // namespace partition
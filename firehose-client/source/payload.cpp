@@ -19,20 +19,34 @@ http://www.fsf.org/licensing/licenses
 *************************************************************************/
 
 #include "payload.hpp"
+#include "collection_plan.hpp"
+#include "coordinated_actors.hpp"
 #include "common/activity/account_events.hpp"
 #include "common/activity/event_recorder.hpp"
+#include "common/alloc_stats.hpp"
 #include "common/moderation/ozone_adapter.hpp"
+#include "event_journal.hpp"
 #include "moderation/action_router.hpp"
 #include "moderation/auxiliary_data.hpp"
 #include "moderation/embed_checker.hpp"
+#include "near_duplicates.hpp"
+#include "overload_policy.hpp"
 #include "parser.hpp"
 #include "payload.hpp"
+#include "subject_index.hpp"
 #include <multiformats/cid.hpp>
 
+using firehose::coordination_detector;
+using firehose::near_duplicate_detector;
+using firehose::overload_policy;
+using firehose::sheddable;
+using firehose::subject_tracker;
+
 jetstream_payload::jetstream_payload() {}
 jetstream_payload::jetstream_payload(std::string json_msg,
-                                     match_results matches)
-    : _json_msg(json_msg), _matches(matches) {}
+                                     match_results matches,
+                                     pipeline::ingest_time ingested)
+    : _json_msg(json_msg), _matches(matches), _ingested(ingested) {}
 
 void jetstream_payload::handle(post_processor<jetstream_payload> &) {
   // TODO almost identical to jetstream_payload::handle
@@ -57,14 +71,54 @@ void jetstream_payload::handle(post_processor<jetstream_payload> &) {
 }
 
 firehose_payload::firehose_payload() {}
-firehose_payload::firehose_payload(parser &my_parser)
-    : _parser(std::move(my_parser)) {}
+namespace {
+// hand off moderation-relevant event to the binary journal, off the hot path
+void journal_event(journal::event_kind kind, nlohmann::json const &message,
+                   const bsky::time_stamp emitted_at, std::string const &did,
+                   std::string const &detail, std::string const &path = {},
+                   std::string const &cid = {},
+                   std::vector<std::string> &&rules = {}) {
+  if (!journal::event_journal::instance().is_enabled())
+    return;
+  journal::event_journal::instance().record(
+      {message["seq"].template get<int64_t>(), emitted_at, kind, did, path,
+       cid, detail, std::move(rules)});
+}
+
+// likes, reposts and follows shared by a group of accounts
+void check_coordination(post_processor<firehose_payload> &processor,
+                        std::string const &repo, std::string const &target,
+                        const bsky::time_stamp emitted_at) {
+  for (auto const &group : coordination_detector::instance().interaction(
+           repo, target, emitted_at, processor.ingested())) {
+    for (auto const &did : group._flag) {
+      processor.request_recording(
+          {did, emitted_at,
+           activity::coordinated(static_cast<unsigned short>(std::min<size_t>(
+               group._targets, std::numeric_limits<unsigned short>::max())))});
+    }
+  }
+}
+} // namespace
+
+firehose_payload::state::state(message_arena::handle &&arena,
+                               parser &&my_parser)
+    : _arena(std::move(arena)), _parser(std::move(my_parser)),
+      _path_by_cid(_arena->resource()) {}
+
+firehose_payload::firehose_payload(message_arena::handle &&arena,
+                                   parser &my_parser,
+                                   pipeline::ingest_time ingested,
+                                   const relay_frame source)
+    : _state(std::make_unique<state>(std::move(arena), std::move(my_parser))),
+      _ingested(ingested), _source(source) {}
 
 void firehose_payload::handle(post_processor<firehose_payload> &processor) {
-  auto const &other_cbors(_parser.other_cbors());
+  alloc_stats::scope allocations(alloc_stats::stage::firehose_payload);
+  auto const &other_cbors(_state->_parser.other_cbors());
   if (other_cbors.size() != 2) {
     std::ostringstream oss;
-    for (auto const &cbor : _parser.other_cbors()) {
+    for (auto const &cbor : other_cbors) {
       oss << cbor.second.dump();
     }
     REL_ERROR("Malformed firehose message {}", oss.str());
@@ -72,6 +126,15 @@ void firehose_payload::handle(post_processor<firehose_payload> &processor) {
   }
   auto const &header(other_cbors.front().second);
   auto const &message(other_cbors.back().second);
+  if (_source == relay_frame::primary_repeat) {
+    // queued behind the copy from the other relay
+    if (message.contains("seq") && message.contains("time")) {
+      bsky::moderation::auxiliary_data::instance().update_rewind_point(
+          message["seq"].template get<int64_t>(),
+          message["time"].template get<std::string>());
+    }
+    return;
+  }
   REL_DEBUG("Firehose header:  {}", dump_json(header));
   REL_DEBUG("         message: {}", dump_json(message));
   int op(header["op"].template get<int>());
@@ -91,12 +154,50 @@ void firehose_payload::handle(post_processor<firehose_payload> &processor) {
         .Get({{"op", "message"}, {"type", op_type}})
         .Increment();
     std::string repo;
-    parser block_parser;
+    // info messages carry no time
+    const bsky::time_stamp emitted_at(
+        message.contains("time")
+            ? bsky::time_stamp_from_iso_8601(
+                  message["time"].template get_ref<std::string const &>())
+            : bsky::current_time());
+    parser block_parser(_state->_arena->resource());
     if (op_type == firehose::OpTypeCommit) {
       repo = message["repo"].template get<std::string>();
-      if (message.contains("blocks")) {
+      // Decide from the op paths which CAR blocks are worth decoding before
+      // touching the CAR. Commit and MST blocks are never needed.
+      parser::block_plans plans(_state->_arena->resource());
+      for (auto const &oper : message["ops"]) {
+        if (!oper.contains("cid") || oper["cid"].is_null())
+          continue;
+        std::string_view path(
+            oper["path"].template get_ref<std::string const &>());
+        firehose::decode_plan plan(
+            firehose::collection_plan::instance().plan_for(
+                path.substr(0, path.find('/'))));
+        metrics_factory::instance()
+            .get_counter("firehose_content")
+            .Get({{"op", "message"},
+                  {"type", op_type},
+                  {"decode_plan", std::string(firehose::to_string(plan))}})
+            .Increment();
+        if (plan == firehose::decode_plan::skip)
+          continue;
+        auto const &cid(
+            oper["cid"].template get_ref<nlohmann::json::binary_t const &>());
+        try {
+          // nlhomann parser gives us a leading zero
+          plans.emplace(atproto::binary_cid(cid.cbegin() + 1, cid.cend()),
+                        plan);
+        } catch (std::exception const &) {
+          // reported in the op loop below
+        }
+      }
+      block_parser.plan_blocks(&plans);
+      if (!plans.empty() && message.contains("blocks")) {
         // CAR file - nested in-situ parse to extract as JSON
-        auto blocks(message["blocks"].template get<nlohmann::json::binary_t>());
+        auto const &blocks(
+            message["blocks"]
+                .template get_ref<nlohmann::json::binary_t const &>());
         bool parsed(block_parser.json_from_car(blocks.cbegin(), blocks.cend()));
         if (parsed) {
           DBG_DEBUG("Commit content blocks: {}",
@@ -136,31 +237,37 @@ void firehose_payload::handle(post_processor<firehose_payload> &processor) {
         }
         // track deletions
         if (oper_kind == firehose::op_kind::delete_) {
-          processor.request_recording(
-              {repo,
-               bsky::time_stamp_from_iso_8601(
-                   message["time"].template get<std::string>()),
-               activity::deleted(path)});
+          activity::deleted deleted{path};
+          // what the record was about, so its effects can be undone
+          auto subject(
+              subject_tracker::instance().deleted(repo, path, emitted_at));
+          if (subject) {
+            deleted._subject = std::move(subject->_subject);
+            deleted._lifetime = emitted_at - subject->_created;
+          }
+          processor.request_recording({repo, emitted_at, std::move(deleted)});
         } else if (oper.contains("cid") && !oper["cid"].is_null()) {
           auto cid(oper["cid"].template get<nlohmann::json::binary_t>());
           try {
             // nlhomann parser gives us a leading zero
-            atproto::cid_decoder decoder(cid.cbegin() + 1, cid.cend());
-            std::string friendly_cid(decoder.as_string());
-            auto insertion(_path_by_cid.insert({friendly_cid, path}));
+            atproto::binary_cid op_cid(cid.cbegin() + 1, cid.cend());
+            auto insertion(_state->_path_by_cid.emplace(op_cid, path));
             if (!insertion.second) {
               // We see this for Block operations very rarely. Log to try to
               // track it down
-              REL_ERROR(
-                  "Duplicate cid {} at op.path {}, already used for path {}",
-                  friendly_cid, path, insertion.first->second);
-              REL_ERROR("Firehose header:  {}", dump_json(header));
-              REL_ERROR("         message: {}", dump_json(message));
-              REL_ERROR("Content CBORs:  {}",
-                        block_parser.dump_parse_content());
-              REL_ERROR("Matched CBORs:  {}",
-                        block_parser.dump_parse_matched());
-              REL_ERROR("Other CBORs:    {}", block_parser.dump_parse_other());
+              REL_ERROR_LIMITED(
+                  10, 0,
+                  "Duplicate cid {} at op.path {}, already used for path {}\n"
+                  "Firehose header:  {}\n"
+                  "         message: {}\n"
+                  "Content CBORs:  {}\n"
+                  "Matched CBORs:  {}\n"
+                  "Other CBORs:    {}",
+                  op_cid.to_string(), path, insertion.first->second,
+                  dump_json(header), dump_json(message),
+                  block_parser.dump_parse_content(),
+                  block_parser.dump_parse_matched(),
+                  block_parser.dump_parse_other());
             }
           } catch (std::exception const &exc) {
             REL_ERROR("CID parse error {} in message {}", exc.what(),
@@ -170,30 +277,29 @@ void firehose_payload::handle(post_processor<firehose_payload> &processor) {
       }
       // handle all the CBORs with content, metrics, checking
       for (auto const &content_cbor : block_parser.content_cbors()) {
-        handle_content(processor, repo, content_cbor.first,
+        handle_content(processor, repo, emitted_at, content_cbor.first,
                        content_cbor.second);
       }
       for (auto const &matchable_cbor : block_parser.matchable_cbors()) {
-        handle_matchable_content(processor, repo, matchable_cbor.first,
-                                 matchable_cbor.second);
+        handle_matchable_content(processor, repo, emitted_at,
+                                 matchable_cbor.first, matchable_cbor.second);
       }
     } else if (op_type == firehose::OpTypeIdentity ||
                op_type == firehose::OpTypeHandle) {
       repo = message["did"].template get<std::string>();
       if (message.contains("handle")) {
         std::string handle(message["handle"].template get<std::string>());
-        _path_candidates.emplace_back(path_candidates{
+        _state->_path_candidates.emplace_back(path_candidates{
             std::string(matcher::HandleSentinel), // path
             std::string(matcher::HandleSentinel), // cid
             {{op_type, std::string(matcher::HandleSentinel), handle}}});
         processor.request_recording(
-            {repo,
-             bsky::time_stamp_from_iso_8601(
-                 message["time"].template get<std::string>()),
-             activity::handle(handle)});
+            {repo, emitted_at, activity::handle(handle)});
         activity::event_recorder::instance().update_handle(repo, handle);
+        journal_event(journal::event_kind::identity, message, emitted_at, repo,
+                      handle);
       }
-      REL_INFO("{} {}", op_type.c_str(), dump_json(message));
+      REL_DEBUG("{} {}", op_type.c_str(), dump_json(message));
     } else if (op_type == firehose::OpTypeAccount) {
       repo = message["did"].template get<std::string>();
       bool active(message["active"].template get<bool>());
@@ -204,91 +310,94 @@ void firehose_payload::handle(post_processor<firehose_payload> &processor) {
                 {"status", active ? "active" : "inactive"}})
           .Increment();
       if (active) {
-        processor.request_recording(
-            {repo,
-             bsky::time_stamp_from_iso_8601(
-                 message["time"].template get<std::string>()),
-             activity::active()});
+        processor.request_recording({repo, emitted_at, activity::active()});
       } else if (message.contains("status")) {
         processor.request_recording(
-            {repo,
-             bsky::time_stamp_from_iso_8601(
-                 message["time"].template get<std::string>()),
+            {repo, emitted_at,
              activity::inactive(bsky::down_reason_from_string(
                  message["status"].template get<std::string>()))});
       } else {
         processor.request_recording(
-            {repo,
-             bsky::time_stamp_from_iso_8601(
-                 message["time"].template get<std::string>()),
-             activity::inactive(bsky::down_reason::unknown)});
+            {repo, emitted_at, activity::inactive(bsky::down_reason::unknown)});
       }
-      REL_INFO("{} {}", op_type.c_str(), dump_json(message));
+      journal_event(journal::event_kind::account, message, emitted_at, repo,
+                    active ? std::string("active")
+                           : message.value("status", std::string("inactive")));
+      REL_DEBUG("{} {}", op_type.c_str(), dump_json(message));
     } else if (op_type == firehose::OpTypeTombstone) {
       repo = message["did"].template get<std::string>();
       processor.request_recording(
-          {repo,
-           bsky::time_stamp_from_iso_8601(
-               message["time"].template get<std::string>()),
-           activity::inactive(bsky::down_reason::tombstone)});
-      REL_INFO("{} {}", op_type.c_str(), dump_json(message));
+          {repo, emitted_at, activity::inactive(bsky::down_reason::tombstone)});
+      journal_event(journal::event_kind::tombstone, message, emitted_at, repo,
+                    {});
+      REL_DEBUG("{} {}", op_type.c_str(), dump_json(message));
     } else if (op_type == firehose::OpTypeMigrate ||
                op_type == firehose::OpTypeInfo) {
       // no-op
     }
     REL_TRACE("{} {}", header.dump(), message.dump());
-    if (!_path_candidates.empty()) {
-      auto matches(
-          matcher::shared().all_matches_for_path_candidates(_path_candidates));
+    if (!_state->_path_candidates.empty()) {
+      auto matches(matcher::shared().all_matches_for_path_candidates(
+          _state->_path_candidates));
       if (!matches.empty()) {
         // track/retrieve account info
         auto handle(activity::event_recorder::instance().ensure_loaded(repo));
         // Publish metrics for matches
         size_t count(0);
         for (auto const &result : matches) {
+          std::vector<std::string> rules;
           for (auto const &next_match : result._matches) {
             // this is the substring of the full JSON that matched one or more
             // desired strings
             // start tracking this account if not already
-            REL_INFO("{}/{}/{} matched candidate {}|{}|{}", next_match._matches,
-                     repo, handle, next_match._candidate._type,
-                     next_match._candidate._field,
-                     next_match._candidate._value);
+            REL_DEBUG("{}/{}/{} matched candidate {}|{}|{}",
+                      next_match._matches, repo, handle,
+                      next_match._candidate._type, next_match._candidate._field,
+                      next_match._candidate._value);
             count += next_match._matches.size();
             for (auto const &match : next_match._matches) {
+              std::string filter(wstring_to_utf8(match.get_keyword()));
               prometheus::Labels labels(
                   {{"type", next_match._candidate._type},
                    {"field", next_match._candidate._field},
-                   {"filter", wstring_to_utf8(match.get_keyword())}});
+                   {"filter", filter}});
               metrics_factory::instance()
                   .get_counter("message_string_matches")
                   .Get(labels)
                   .Increment();
+              rules.emplace_back(std::move(filter));
             }
           }
+          // one structured record per matched path, full content available
+          // from the source repo by path/cid
+          journal_event(journal::event_kind::match, message, emitted_at, repo,
+                        handle, result._path, result._cid, std::move(rules));
         }
-        // only log message once - might be interleaved with other thread output
+        // full message text only for diagnosis
         if (op_type == firehose::OpTypeCommit) {
           // curate a smaller version of the full message for correlation
-          REL_INFO("in message: {} {} {}", repo, dump_json(message["ops"]),
-                   block_parser.dump_parse_content());
+          REL_DEBUG("in message: {} {} {}", repo, dump_json(message["ops"]),
+                    block_parser.dump_parse_content());
         } else {
-          REL_INFO("in message: {} {}", repo, dump_json(message));
+          REL_DEBUG("in message: {} {}", repo, dump_json(message));
         }
         // record suspect activity as a special-case event
         processor.request_recording(
             {repo, bsky::current_time(), activity::matches(count)});
 
         // forward account and its matched records for possible auto-moderation
-        action_router::instance().wait_enqueue({repo, std::move(matches)});
+        action_router::instance().wait_enqueue(
+            {repo, std::move(matches), _ingested});
       }
     }
     // update last-seen sequence number
     if (op_type != firehose::OpTypeInfo) {
       int64_t seq(message["seq"].template get<int64_t>());
-      std::string emitted_at(message["time"].template get<std::string>());
-      bsky::moderation::auxiliary_data::instance().update_rewind_point(
-          seq, emitted_at);
+      pipeline::stage_timer::instance().record_lag(emitted_at);
+      if (_source == relay_frame::primary) {
+        bsky::moderation::auxiliary_data::instance().update_rewind_point(
+            seq, message["time"].template get<std::string>());
+      }
     }
   }
 }
@@ -363,11 +472,13 @@ firehose_payload::context::process_embed(nlohmann::json const &embed) {
 
 void firehose_payload::handle_content(
     post_processor<firehose_payload> &processor, std::string const &repo,
-    std::string const &cid, nlohmann::json const &content) {
-  context this_context(processor, content);
+    const bsky::time_stamp emitted_at, atproto::binary_cid const &cid,
+    nlohmann::json const &content) {
+  context this_context(processor, cid, content);
   this_context._repo = repo;
-  if (_path_by_cid.contains(cid)) {
-    this_context._this_path = _path_by_cid[cid];
+  auto path(_state->_path_by_cid.find(cid));
+  if (path != _state->_path_by_cid.cend()) {
+    this_context._this_path = path->second;
   } else {
     throw std::runtime_error("cannot get URI for cid at " + dump_json(content));
   }
@@ -405,7 +516,13 @@ void firehose_payload::handle_content(
       if (content.contains("facets")) {
         size_t mentions(0);
         size_t links(0);
-        if (embed_type == bsky::embed_type::video && embed.contains("langs")) {
+        const bool video_languages(embed_type == bsky::embed_type::video &&
+                                   embed.contains("langs"));
+        // only sample when there is something to count
+        const bool count_languages(
+            (video_languages || content.contains("langs")) &&
+            overload_policy::instance().admit(sheddable::language_metrics));
+        if (count_languages && video_languages) {
           // count languages in video
           auto langs(embed["langs"].template get<std::vector<std::string>>());
           for (auto const &lang : langs) {
@@ -428,9 +545,9 @@ void firehose_payload::handle_content(
               ++tags;
               // }
             } else if (facet_type == bsky::AppBskyRichtextFacetLink) {
-              _path_candidates.emplace_back(path_candidates{
+              _state->_path_candidates.emplace_back(path_candidates{
                   this_context._this_path,
-                  cid,
+                  this_context.cid_string(),
                   {{collection, std::string(bsky::AppBskyRichtextFacetLink),
                     feature["uri"].template get<std::string>()}}});
               this_context.add_embed(
@@ -440,26 +557,29 @@ void firehose_payload::handle_content(
           }
         }
         // record metrics for facet types by embed type
-        if (mentions > 0) {
+        const bool record_facets(
+            (has_facets || tags > 0) &&
+            overload_policy::instance().admit(sheddable::facet_metrics));
+        if (record_facets && mentions > 0) {
           metrics_factory::instance()
               .get_histogram("firehose_facets")
               .GetAt(
                   {{"facet", std::string(bsky::AppBskyRichtextFacetMention)}})
               .Observe(static_cast<double>(mentions));
         }
-        if (links > 0) {
+        if (record_facets && links > 0) {
           metrics_factory::instance()
               .get_histogram("firehose_facets")
               .GetAt({{"facet", std::string(bsky::AppBskyRichtextFacetLink)}})
               .Observe(static_cast<double>(links));
         }
-        if (tags > 0) {
+        if (record_facets && tags > 0) {
           metrics_factory::instance()
               .get_histogram("firehose_facets")
               .GetAt({{"facet", std::string(bsky::AppBskyRichtextFacetTag)}})
               .Observe(static_cast<double>(tags));
         }
-        if (has_facets) {
+        if (record_facets && has_facets) {
           size_t total(mentions + tags + links);
           metrics_factory::instance()
               .get_histogram("firehose_facets")
@@ -473,7 +593,7 @@ void firehose_payload::handle_content(
                                 static_cast<unsigned short>(mentions),
                                 static_cast<unsigned short>(links))});
         }
-        if (content.contains("langs")) {
+        if (count_languages && content.contains("langs")) {
           auto langs(content["langs"].template get<std::vector<std::string>>());
           for (auto const &lang : langs) {
             metrics_factory::instance()
@@ -499,21 +619,41 @@ void firehose_payload::handle_content(
              content["createdAt"].template get<std::string>()),
          activity::block(this_context._this_path,
                          content["subject"].template get<std::string>())});
+    subject_tracker::instance().created(
+        repo, this_context._this_path,
+        content["subject"].template get_ref<std::string const &>(),
+        emitted_at);
   } else if (this_context._event_type == bsky::tracked_event::follow) {
-    processor.request_recording(
-        {repo,
-         bsky::time_stamp_from_iso_8601(
-             content["createdAt"].template get<std::string>()),
-         activity::follow(this_context._this_path,
-                          content["subject"].template get<std::string>())});
+    auto const &subject(
+        content["subject"].template get_ref<std::string const &>());
+    if (overload_policy::instance().admit(sheddable::social_graph)) {
+      // a delete undoes only what was recorded, shed records are not tracked
+      subject_tracker::instance().created(repo, this_context._this_path,
+                                          subject, emitted_at);
+      processor.request_recording(
+          {repo,
+           bsky::time_stamp_from_iso_8601(
+               content["createdAt"].template get<std::string>()),
+           activity::follow(this_context._this_path, subject)});
+    }
+    if (overload_policy::instance().admit(sheddable::coordination)) {
+      check_coordination(processor, repo, subject, emitted_at);
+    }
   } else if (this_context._event_type == bsky::tracked_event::like) {
-    processor.request_recording(
-        {repo,
-         bsky::time_stamp_from_iso_8601(
-             content["createdAt"].template get<std::string>()),
-         activity::like(
-             this_context._this_path,
-             content["subject"]["uri"].template get<std::string>())});
+    auto const &subject(
+        content["subject"]["uri"].template get_ref<std::string const &>());
+    if (overload_policy::instance().admit(sheddable::social_graph)) {
+      subject_tracker::instance().created(repo, this_context._this_path,
+                                          subject, emitted_at);
+      processor.request_recording(
+          {repo,
+           bsky::time_stamp_from_iso_8601(
+               content["createdAt"].template get<std::string>()),
+           activity::like(this_context._this_path, subject)});
+    }
+    if (overload_policy::instance().admit(sheddable::coordination)) {
+      check_coordination(processor, repo, subject, emitted_at);
+    }
   } else if (this_context._event_type == bsky::tracked_event::profile) {
     processor.request_recording(
         {repo,
@@ -523,38 +663,63 @@ void firehose_payload::handle_content(
               : bsky::current_time()),
          activity::profile(this_context._this_path)});
   } else if (this_context._event_type == bsky::tracked_event::repost) {
-    processor.request_recording(
-        {repo,
-         bsky::time_stamp_from_iso_8601(
-             content["createdAt"].template get<std::string>()),
-         activity::repost(
-             this_context._this_path,
-             content["subject"]["uri"].template get<std::string>())});
+    auto const &subject(
+        content["subject"]["uri"].template get_ref<std::string const &>());
+    if (overload_policy::instance().admit(sheddable::social_graph)) {
+      subject_tracker::instance().created(repo, this_context._this_path,
+                                          subject, emitted_at);
+      processor.request_recording(
+          {repo,
+           bsky::time_stamp_from_iso_8601(
+               content["createdAt"].template get<std::string>()),
+           activity::repost(this_context._this_path, subject)});
+    }
+    if (overload_policy::instance().admit(sheddable::coordination)) {
+      check_coordination(processor, repo, subject, emitted_at);
+    }
   }
   // pass along embeds for analysis
   if (!this_context.get_embeds().empty()) {
     bsky::moderation::embed_checker::instance().wait_enqueue(
-        {repo, this_context._this_path, cid, this_context.get_embeds()});
+        {repo, this_context._this_path, this_context.cid_string(),
+         this_context.get_embeds()});
   }
 }
 
 void firehose_payload::handle_matchable_content(
     post_processor<firehose_payload> &processor, std::string const &repo,
-    std::string const &cid, nlohmann::json const &content) {
+    const bsky::time_stamp emitted_at, atproto::binary_cid const &cid,
+    nlohmann::json const &content) {
   // common processing
-  handle_content(processor, repo, cid, content);
+  handle_content(processor, repo, emitted_at, cid, content);
 
   // check for matches
   std::string this_path;
-  if (_path_by_cid.contains(cid)) {
-    this_path = _path_by_cid[cid];
+  auto path(_state->_path_by_cid.find(cid));
+  if (path != _state->_path_by_cid.cend()) {
+    this_path = path->second;
   } else {
     throw std::runtime_error("cannot get URI for cid at " + dump_json(content));
   }
   auto candidates(parser::get_candidates_from_record(content));
   if (!candidates.empty()) {
-    _path_candidates.insert(
-        _path_candidates.end(),
-        {std::string(this_path), cid, std::move(candidates)});
+    _state->_path_candidates.insert(
+        _state->_path_candidates.end(),
+        {std::string(this_path), cid.to_string(), std::move(candidates)});
+  }
+
+  // campaigns that vary a few words per post evade exact filters
+  if (content.contains("text") &&
+      content["$type"].template get_ref<std::string const &>() ==
+          bsky::AppBskyFeedPost) {
+    auto cluster(near_duplicate_detector::instance().check(
+        repo, content["text"].template get_ref<std::string const &>(),
+        emitted_at));
+    for (auto const &did : cluster._flag) {
+      processor.request_recording(
+          {did, emitted_at,
+           activity::near_duplicate(
+               static_cast<unsigned short>(cluster._accounts))});
+    }
   }
 }
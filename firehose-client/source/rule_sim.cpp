@@ -0,0 +1,123 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+// Offline comparison of a candidate rule file with the current rules over a
+// frame capture (see frame_corpus.hpp). Reports per-rule hits, the matches
+// the candidate rules add and remove with samples, and how many reports each
+// rule set would send. Nothing is reported.
+
+#include "common/config.hpp"
+#include "common/log_wrapper.hpp"
+#include "datasource.hpp"
+#include "parser.hpp"
+#include "project_defs.hpp"
+#include "rule_simulator.hpp"
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using namespace rule_sim;
+
+namespace {
+
+void print_tallies(std::string_view heading, rule_tallies const &tallies,
+                   const bool with_samples) {
+  for (auto const &[rule, tally] : tallies) {
+    std::cout << heading << ' ' << rule << " hits=" << tally._hits
+              << " accounts=" << tally._accounts.size() << '\n';
+    if (!with_samples)
+      continue;
+    for (auto const &sample : tally._samples) {
+      std::cout << "  " << sample << '\n';
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  bool log_ready(false);
+  try {
+    // Check command line arguments.
+    if (argc != 4 && argc != 5) {
+      std::cerr << "Usage: rule_sim <config-file-name> <candidate-rule-file> "
+                   "<frame-corpus> [<threads>]\n";
+      return EXIT_FAILURE;
+    }
+
+    std::shared_ptr<config> settings(std::make_shared<config>(argv[1]));
+    std::string const log_file(
+        settings->get_config()[PROJECT_NAME]["logging"]["filename"]
+            .as<std::string>());
+    spdlog::level::level_enum log_level(spdlog::level::from_str(
+        settings->get_config()[PROJECT_NAME]["logging"]["level"]
+            .as<std::string>()));
+    if (!init_logging(log_file, PROJECT_NAME, log_level)) {
+      return EXIT_FAILURE;
+    }
+    log_ready = true;
+    parser::set_config(settings);
+
+    // rules held in the moderation DB are not loaded offline
+    auto filters(settings->get_config()[PROJECT_NAME]["filters"]);
+    if (!filters["filename"]) {
+      throw std::invalid_argument("rule_sim needs filters.filename");
+    }
+
+    corpus::frames frames(corpus::load_frames(argv[3]));
+    const size_t threads(argc == 5 ? std::stoul(argv[4])
+                                   : std::thread::hardware_concurrency());
+    work_stealing_pool pool(threads);
+    simulator sim(filters["filename"].as<std::string>(), argv[2],
+                  is_full(*settings), pool);
+
+    const auto started(std::chrono::steady_clock::now());
+    sim.run(frames);
+    const auto elapsed(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - started));
+
+    sim_results const &results(sim.results());
+    print_tallies("current", results._current, false);
+    print_tallies("candidate", results._candidate, false);
+    print_tallies("added", results._added, true);
+    print_tallies("removed", results._removed, true);
+    std::cout << "frames=" << results._frames << " failed=" << results._failed
+              << " reports current=" << results._current_reports
+              << " candidate=" << results._candidate_reports << '\n';
+    std::cout << "elapsed_ms=" << elapsed.count();
+    if (results._first && results._last && elapsed.count() > 0) {
+      const auto captured(*results._last - *results._first);
+      std::cout << " captured_ms=" << captured.count() << " speedup="
+                << static_cast<double>(captured.count()) /
+                       static_cast<double>(elapsed.count());
+    }
+    std::cout << '\n';
+    stop_logging();
+    return EXIT_SUCCESS;
+  } catch (std::exception const &exc) {
+    if (log_ready) {
+      REL_CRITICAL("Unhandled exception : {}", exc.what());
+      stop_logging();
+    } else {
+      std::cerr << "Unhandled exception : " << exc.what() << '\n';
+    }
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,229 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "rule_simulator.hpp"
+#include "common/log_wrapper.hpp"
+#include "common/moderation/report_agent.hpp"
+#include "parser.hpp"
+#include "post_processor.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+namespace rule_sim {
+
+namespace {
+// matches keyed by path and rule filter, with the matched text
+typedef std::map<std::pair<std::string, std::string>, std::string>
+    keyed_matches;
+
+keyed_matches key_matches(matcher const &rules,
+                          path_match_results const &matches) {
+  keyed_matches result;
+  for (auto const &content : matches) {
+    for (auto const &next_match : content._matches) {
+      for (auto const &emit : next_match._matches) {
+        std::string filter(rules.find_rule(emit.get_keyword())._target);
+        result.emplace(std::make_pair(content._path, std::move(filter)),
+                       next_match._candidate._value);
+      }
+    }
+  }
+  return result;
+}
+
+size_t count_reports(matcher const &rules, std::string const &did,
+                     path_match_results const &matches) {
+  if (matches.empty())
+    return 0;
+  account_filter_matches account_matches;
+  account_matches._did = did;
+  account_matches._matches = matches;
+  std::set<std::string> block_lists;
+  return rules.decide_report(account_matches, block_lists)
+      ._scoped_matches.size();
+}
+
+} // namespace
+
+bool decode_firehose(std::string const &frame, frame_content &content) {
+  parser frame_parser;
+  if (!frame_parser.json_from_cbor(frame.cbegin(), frame.cend()) ||
+      frame_parser.other_cbors().size() != 2) {
+    return false;
+  }
+  auto const &header(frame_parser.other_cbors().front().second);
+  auto const &message(frame_parser.other_cbors().back().second);
+  if (!header.contains("t"))
+    return true;
+  if (message.contains("time")) {
+    content._time = bsky::time_stamp_from_iso_8601(
+        message["time"].template get<std::string>());
+  }
+  std::string op_type(header["t"].template get<std::string>());
+  if (op_type == firehose::OpTypeIdentity ||
+      op_type == firehose::OpTypeHandle) {
+    content._did = message["did"].template get<std::string>();
+    if (message.contains("handle")) {
+      content._path_candidates.emplace_back(path_candidates{
+          std::string(matcher::HandleSentinel),
+          std::string(matcher::HandleSentinel),
+          {{op_type, std::string(matcher::HandleSentinel),
+            message["handle"].template get<std::string>()}}});
+    }
+    return true;
+  }
+  if (op_type != firehose::OpTypeCommit || !message.contains("blocks"))
+    return true;
+  content._did = message["repo"].template get<std::string>();
+  std::unordered_map<atproto::binary_cid, std::string,
+                     atproto::binary_cid_hash>
+      path_by_cid;
+  for (auto const &oper : message["ops"]) {
+    if (!oper.contains("cid") || oper["cid"].is_null())
+      continue;
+    auto const &cid(
+        oper["cid"].template get_ref<nlohmann::json::binary_t const &>());
+    // nlhomann parser gives us a leading zero
+    path_by_cid.emplace(atproto::binary_cid(cid.cbegin() + 1, cid.cend()),
+                        oper["path"].template get<std::string>());
+  }
+  auto const &blocks(
+      message["blocks"].template get_ref<nlohmann::json::binary_t const &>());
+  parser block_parser;
+  if (!block_parser.json_from_car(blocks.cbegin(), blocks.cend()))
+    return false;
+  for (auto const &[cid, record] : block_parser.matchable_cbors()) {
+    auto path(path_by_cid.find(cid));
+    if (path == path_by_cid.cend())
+      continue;
+    auto candidates(parser::get_candidates_from_record(record));
+    if (!candidates.empty()) {
+      content._path_candidates.emplace_back(path_candidates{
+          path->second, cid.to_string(), std::move(candidates)});
+    }
+  }
+  return true;
+}
+
+bool decode_jetstream(std::string const &frame, frame_content &content) {
+  nlohmann::json event(nlohmann::json::parse(frame, nullptr, false));
+  if (event.is_discarded() || !event.contains("did"))
+    return false;
+  content._did = event["did"].template get<std::string>();
+  if (event.contains("time_us")) {
+    const std::chrono::microseconds time_us(
+        event["time_us"].template get<int64_t>());
+    content._time = bsky::time_stamp(
+        std::chrono::duration_cast<std::chrono::milliseconds>(time_us));
+  }
+  candidate_list candidates(parser().get_candidates_from_json(event));
+  if (candidates.empty())
+    return true;
+  std::string path(matcher::HandleSentinel);
+  if (event["kind"] == "commit") {
+    auto const &commit(event["commit"]);
+    path = commit["collection"].template get<std::string>() + '/' +
+           commit["rkey"].template get<std::string>();
+  }
+  std::string cid(event["kind"] == "commit" && event["commit"].contains("cid")
+                      ? event["commit"]["cid"].template get<std::string>()
+                      : path);
+  content._path_candidates.emplace_back(
+      path_candidates{path, cid, std::move(candidates)});
+  return true;
+}
+
+simulator::simulator(std::string const &current_rules,
+                     std::string const &candidate_rules, const bool is_full,
+                     work_stealing_pool &pool)
+    : _is_full(is_full), _pool(pool) {
+  // private rule sets per worker, so that workers do not contend for the
+  // matcher lock
+  for (size_t worker = 0; worker < pool.size(); ++worker) {
+    _current.emplace_back(std::make_unique<matcher>());
+    _current.back()->load_filter_file(current_rules);
+    _candidate.emplace_back(std::make_unique<matcher>());
+    _candidate.back()->load_filter_file(candidate_rules);
+  }
+}
+
+void simulator::run(corpus::frames const &frames) {
+  for (size_t first = 0; first < frames.size(); first += FramesPerTask) {
+    const size_t last(std::min(frames.size(), first + FramesPerTask));
+    _pool.submit([this, &frames, first, last]() {
+      simulate(frames, first, last);
+    });
+  }
+  _pool.wait();
+}
+
+void simulator::simulate(corpus::frames const &frames, const size_t first,
+                         const size_t last) {
+  const size_t worker(work_stealing_pool::current_worker());
+  matcher const &current(*_current[worker]);
+  matcher const &candidate(*_candidate[worker]);
+  sim_results results;
+  for (size_t index = first; index < last; ++index) {
+    ++results._frames;
+    frame_content content;
+    bool decoded(false);
+    try {
+      decoded = _is_full ? decode_firehose(frames[index], content)
+                         : decode_jetstream(frames[index], content);
+    } catch (std::exception const &exc) {
+      REL_ERROR("Frame {} decode failed: {}", index, exc.what());
+    }
+    if (!decoded) {
+      ++results._failed;
+      continue;
+    }
+    results.saw(content._time);
+    if (content._path_candidates.empty())
+      continue;
+
+    auto current_matches(
+        current.all_matches_for_path_candidates(content._path_candidates));
+    auto candidate_matches(
+        candidate.all_matches_for_path_candidates(content._path_candidates));
+    results._current_reports +=
+        count_reports(current, content._did, current_matches);
+    results._candidate_reports +=
+        count_reports(candidate, content._did, candidate_matches);
+
+    keyed_matches before(key_matches(current, current_matches));
+    keyed_matches after(key_matches(candidate, candidate_matches));
+    for (auto const &[key, text] : before) {
+      std::string sample(content._did + ' ' + key.first + ' ' + text);
+      results._current[key.second].add(content._did, sample);
+      if (!after.contains(key))
+        results._removed[key.second].add(content._did, sample);
+    }
+    for (auto const &[key, text] : after) {
+      std::string sample(content._did + ' ' + key.first + ' ' + text);
+      results._candidate[key.second].add(content._did, sample);
+      if (!before.contains(key))
+        results._added[key.second].add(content._did, sample);
+    }
+  }
+  std::lock_guard<std::mutex> guard(_lock);
+  _results.merge(results);
+}
+
+} // namespace rule_sim
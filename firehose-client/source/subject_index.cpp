@@ -0,0 +1,96 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "subject_index.hpp"
+#include "common/config.hpp"
+#include "common/log_wrapper.hpp"
+#include "common/metrics_factory.hpp"
+#include <stdexcept>
+
+namespace firehose {
+
+subject_tracker &subject_tracker::instance() {
+  static subject_tracker my_instance;
+  return my_instance;
+}
+
+void subject_tracker::set_config(YAML::Node const &settings) {
+  if (!settings.IsDefined())
+    return;
+  const size_t capacity(setting_or(settings, "capacity", size_t(4194304)));
+  const std::chrono::milliseconds retention(setting_or(
+      settings, "retention_ms", std::chrono::milliseconds(86400000)));
+  if (capacity == 0 || retention.count() <= 0) {
+    throw std::invalid_argument(
+        "subject_index needs capacity > 0 and retention_ms > 0");
+  }
+  _index = std::make_unique<subject_index>(capacity, retention);
+  REL_INFO("Subject index: {} slots, {} ms retention", _index->capacity(),
+           retention.count());
+}
+
+void subject_tracker::register_metrics() {
+  auto &outcomes(metrics_factory::instance().add_counter(
+      "subject_index", "Subjects of likes, reposts, follows and blocks"));
+  _recorded = &outcomes.Add({{"create", "recorded"}});
+  _attributed = &outcomes.Add({{"delete", "attributed"}});
+  _unknown = &outcomes.Add({{"delete", "unknown"}});
+  _overwritten = &outcomes.Add({{"create", "overwritten"}});
+  auto &size(metrics_factory::instance().add_gauge(
+      "subject_index_size", "Size of the record subject index"));
+  _entries = &size.Add({{"index", "entries"}});
+  _subjects = &size.Add({{"index", "subjects"}});
+}
+
+void subject_tracker::created(std::string const &did, std::string const &path,
+                              std::string const &subject,
+                              const bsky::time_stamp emitted_at) {
+  if (!_index)
+    return;
+  if (!_index->insert(did, path, subject, emitted_at))
+    return;
+  if (_recorded) {
+    _recorded->Increment();
+    const size_t overwritten(_index->overwritten());
+    _overwritten->Increment(
+        static_cast<double>(overwritten - _overwritten_reported));
+    _overwritten_reported = overwritten;
+    _entries->Set(static_cast<double>(_index->entries()));
+    _subjects->Set(static_cast<double>(_index->subjects()));
+  }
+}
+
+std::optional<subject_index::found>
+subject_tracker::deleted(std::string const &did, std::string const &path,
+                         const bsky::time_stamp emitted_at) {
+  if (!_index || !subject_index::tracks(path))
+    return {};
+  auto result(_index->take(did, path, emitted_at));
+  if (_attributed) {
+    if (result) {
+      _attributed->Increment();
+    } else {
+      _unknown->Increment();
+    }
+  }
+  return result;
+}
+
+} // namespace firehose
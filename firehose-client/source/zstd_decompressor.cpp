@@ -0,0 +1,119 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "zstd_decompressor.hpp"
+#include "common/log_wrapper.hpp"
+#include "common/metrics_factory.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+const prometheus::Histogram::BucketBoundaries
+    zstd_decompressor::MicrosecondBuckets = {1,  2,   5,   10,   20,  50,
+                                             100, 200, 500, 1000, 5000};
+
+zstd_decompressor::zstd_decompressor(std::string const &dictionary_file,
+                                     std::string const &host) {
+  _context = ZSTD_createDCtx();
+  if (!_context) {
+    throw std::runtime_error("Cannot create zstd decompression context");
+  }
+  if (!dictionary_file.empty()) {
+    std::ifstream dictionary_stream(dictionary_file, std::ios::binary);
+    if (!dictionary_stream) {
+      ZSTD_freeDCtx(_context);
+      throw std::invalid_argument("Cannot open zstd dictionary " +
+                                  dictionary_file);
+    }
+    std::vector<char> dictionary((std::istreambuf_iterator<char>(
+                                     dictionary_stream)),
+                                 std::istreambuf_iterator<char>());
+    _dictionary = ZSTD_createDDict(dictionary.data(), dictionary.size());
+    if (!_dictionary) {
+      ZSTD_freeDCtx(_context);
+      throw std::invalid_argument("Invalid zstd dictionary " +
+                                  dictionary_file);
+    }
+    ZSTD_DCtx_refDDict(_context, _dictionary);
+    REL_INFO("zstd dictionary {} loaded, {} bytes, id {}", dictionary_file,
+             dictionary.size(), ZSTD_getDictID_fromDDict(_dictionary));
+  } else {
+    REL_INFO("zstd decompression without dictionary");
+  }
+
+  _inflated_bytes = &metrics_factory::instance()
+                         .get_counter("websocket_inflated_bytes")
+                         .Add({{"host", host}});
+  _elapsed = &metrics_factory::instance()
+                  .get_histogram("websocket_decompression")
+                  .Add({{"host", host}}, MicrosecondBuckets);
+}
+
+zstd_decompressor::~zstd_decompressor() {
+  ZSTD_freeDCtx(_context);
+  ZSTD_freeDDict(_dictionary);
+}
+
+void zstd_decompressor::register_metrics() {
+  metrics_factory::instance().add_counter(
+      "websocket_inflated_bytes",
+      "Number of inbound message bytes after decompression");
+  metrics_factory::instance().add_histogram(
+      "websocket_decompression",
+      "Microseconds to decompress each inbound message");
+}
+
+bool zstd_decompressor::decompress(beast::flat_buffer const &input) {
+  auto const started(std::chrono::steady_clock::now());
+  _output.clear();
+  auto const data(input.data());
+  ZSTD_inBuffer source{data.data(), data.size(), 0};
+  // reuse dictionary and context, only the frame state is reset
+  ZSTD_DCtx_reset(_context, ZSTD_reset_session_only);
+  while (true) {
+    // Jetstream frames inflate a little over 2x, allow headroom
+    auto target(_output.prepare(
+        std::max(ZSTD_DStreamOutSize(), (source.size - source.pos) * 3)));
+    ZSTD_outBuffer sink{target.data(), target.size(), 0};
+    const size_t result(ZSTD_decompressStream(_context, &sink, &source));
+    if (ZSTD_isError(result)) {
+      REL_ERROR_LIMITED(10, 0, "zstd decompress error {}",
+                        ZSTD_getErrorName(result));
+      return false;
+    }
+    _output.commit(sink.pos);
+    if (result == 0)
+      break;
+    if (source.pos == source.size && sink.pos < sink.size) {
+      REL_ERROR_LIMITED(10, 0, "zstd frame truncated at {} bytes",
+                        source.size);
+      return false;
+    }
+  }
+  _inflated_bytes->Increment(static_cast<double>(_output.size()));
+  _elapsed->Observe(static_cast<double>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - started)
+          .count()));
+  return true;
+}
@@ -1,8 +1,23 @@
+#include "common/metrics_factory.hpp"
 #include "nlohmann/json.hpp"
+#include <chrono>
 #include <fstream>
 #include <gtest/gtest.h>
 
 constexpr const char *DataPath = "./data/";
+// fixed origin for tests that replay a timeline of events
+constexpr std::chrono::sys_days TestStart(std::chrono::year(2026) / 1 / 1);
+
+// gauge the client registers in main, shared by suites that drive the
+// post-processor. Metrics can be added only once per process.
+inline void add_process_metrics() {
+  static const bool added([] {
+    metrics_factory::instance().add_gauge(
+        "process_operation", "Statistics about process internals");
+    return true;
+  }());
+  (void)added;
+}
 
 inline nlohmann::json load_json_from_file(const std::string &filename) {
   std::string decorated = DataPath + filename;
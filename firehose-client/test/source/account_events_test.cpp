@@ -0,0 +1,87 @@
+#include <chrono>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <string>
+
+#include "common/activity/event_cache.hpp"
+#include "common/metrics_factory.hpp"
+#include "testdefs.hpp"
+
+using activity::account;
+using activity::event_cache;
+using activity::timed_event;
+using namespace std::chrono;
+
+namespace {
+const std::string Liker("did:plc:liker");
+const std::string Author("did:plc:author");
+const std::string Post("at://did:plc:author/app.bsky.feed.post/3lbrevwbpe22k");
+
+std::string like_path(const size_t index) {
+  return "app.bsky.feed.like/3lbrevx" + std::to_string(100000 + index);
+}
+timed_event like(const size_t index) {
+  return {Liker, TestStart,
+          activity::like{like_path(index), atproto::at_uri(Post)}};
+}
+// delete of a like whose subject was found in the subject index
+timed_event unlike(const size_t index, const milliseconds lifetime) {
+  return {Liker, TestStart + lifetime,
+          activity::deleted{like_path(index), Post, lifetime}};
+}
+
+class AccountEventsTest : public ::testing::Test {
+protected:
+  static void SetUpTestSuite() {
+    metrics_factory::instance().add_counter(
+        "realtime_alerts", "Alerts generated for possibly suspect activity");
+    add_process_metrics();
+  }
+};
+} // namespace
+
+TEST_F(AccountEventsTest, DeleteUndoesLikeAndFlagsChurn) {
+  event_cache cache;
+  auto &churn_alerts(metrics_factory::instance()
+                         .get_counter("realtime_alerts")
+                         .Get({{"account", "like_churn"}}));
+  const double before(churn_alerts.Value());
+  for (size_t cycle = 0; cycle < account::LikeChurnFactor; ++cycle) {
+    cache.record(like(cycle));
+    cache.record(unlike(cycle, minutes(1)));
+  }
+  auto author(cache.find_account(Author));
+  ASSERT_TRUE(author);
+  EXPECT_EQ(author->get_statistics()._liked, 0);
+  EXPECT_EQ(author->find_content_item(atproto::at_uri(Post))->_likes, 0);
+  auto liker(cache.find_account(Liker));
+  ASSERT_TRUE(liker);
+  EXPECT_EQ(liker->get_statistics()._like_churn, account::LikeChurnFactor);
+  EXPECT_EQ(churn_alerts.Value(), before + 1);
+}
+
+TEST_F(AccountEventsTest, DeleteDoesNotCreateOrGoNegative) {
+  event_cache cache;
+  // the author was never seen here, there is nothing to undo
+  cache.record(unlike(0, hours(48)));
+  EXPECT_FALSE(cache.find_account(Author));
+
+  cache.record(like(1));
+  cache.record(unlike(1, hours(48)));
+  // deleted again, e.g. a replayed frame
+  cache.record(unlike(1, hours(48)));
+  auto author(cache.find_account(Author));
+  ASSERT_TRUE(author);
+  EXPECT_EQ(author->get_statistics()._liked, 0);
+  EXPECT_EQ(author->find_content_item(atproto::at_uri(Post))->_likes, 0);
+  // outside the churn window
+  EXPECT_EQ(cache.find_account(Liker)->get_statistics()._like_churn, 0u);
+}
+
+TEST_F(AccountEventsTest, RepostCountedOnce) {
+  event_cache cache;
+  cache.record({Liker, TestStart,
+                activity::repost{"app.bsky.feed.repost/3lbrevx100000",
+                                 atproto::at_uri(Post)}});
+  EXPECT_EQ(cache.find_account(Author)->get_statistics()._reposted, 1);
+}
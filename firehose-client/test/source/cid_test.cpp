@@ -1,3 +1,4 @@
+#include "common/bluesky/platform.hpp"
 #include "multiformats/cid.hpp"
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -11,5 +12,29 @@ TEST(CIDTest, RoundTrip) {
       cid.to_string(Multiformats::Multibase::Protocol::Base32));
   EXPECT_EQ(readable, mod_service_banner);
   auto decoded(Multiformats::Multibase::decode(mod_service_banner));
-  EXPECT_EQ(decoded.size(), 36);
+  EXPECT_EQ(decoded.size(), 36u);
+}
+
+TEST(CIDTest, BinaryMatchesMultiformats) {
+  const std::string mod_service_banner(
+      "bafyreifd275x5ujvzarnxzwmztn32ncrtewmtp4ne4bb73opkflvdabere");
+  auto decoded(Multiformats::Multibase::decode(mod_service_banner));
+  atproto::binary_cid cid(decoded.cbegin(), decoded.cend());
+  EXPECT_EQ(cid.length(), 36u);
+  EXPECT_EQ(cid.to_string(), mod_service_banner);
+
+  atproto::binary_cid same(decoded.cbegin(), decoded.cend());
+  EXPECT_EQ(cid, same);
+  EXPECT_EQ(atproto::binary_cid_hash()(cid), atproto::binary_cid_hash()(same));
+  decoded.back() ^= 0x01;
+  atproto::binary_cid different(decoded.cbegin(), decoded.cend());
+  EXPECT_FALSE(cid == different);
+}
+
+TEST(CIDTest, BinaryTruncated) {
+  const std::string mod_service_banner(
+      "bafyreifd275x5ujvzarnxzwmztn32ncrtewmtp4ne4bb73opkflvdabere");
+  auto decoded(Multiformats::Multibase::decode(mod_service_banner));
+  EXPECT_THROW(atproto::binary_cid(decoded.cbegin(), decoded.cend() - 1),
+               std::invalid_argument);
 }
@@ -0,0 +1,167 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "collection_plan.hpp"
+#include "common/bluesky/platform.hpp"
+#include "parser.hpp"
+
+namespace {
+std::vector<uint8_t> block_cid(const uint8_t seed) {
+  // CIDv1, dag-cbor, sha2-256
+  std::vector<uint8_t> cid({0x01, 0x71, 0x12, 0x20});
+  for (uint8_t offset = 0; offset < 32; ++offset) {
+    cid.push_back(static_cast<uint8_t>(seed + offset));
+  }
+  return cid;
+}
+
+void append_varint(std::vector<uint8_t> &car, uint64_t value) {
+  do {
+    uint8_t next(value & 0x7f);
+    value >>= 7;
+    if (value)
+      next |= 0x80;
+    car.push_back(next);
+  } while (value);
+}
+
+void append_block(std::vector<uint8_t> &car, std::vector<uint8_t> const &cid,
+                  nlohmann::json const &record) {
+  auto const cbor(nlohmann::json::to_cbor(record));
+  append_varint(car, cid.size() + cbor.size());
+  car.insert(car.end(), cid.cbegin(), cid.cend());
+  car.insert(car.end(), cbor.cbegin(), cbor.cend());
+}
+
+atproto::binary_cid as_binary(std::vector<uint8_t> const &cid) {
+  return atproto::binary_cid(cid.cbegin(), cid.cend());
+}
+
+// post, like with a non-minimal field, untyped MST-style node
+class CarDecodeTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    auto const header(nlohmann::json::to_cbor(
+        {{"roots", nlohmann::json::array(
+                       {nlohmann::json::binary(block_cid(_post_seed))})},
+         {"version", 1}}));
+    append_varint(_car, header.size());
+    _car.insert(_car.end(), header.cbegin(), header.cend());
+    append_block(_car, block_cid(_post_seed),
+                 {{"$type", bsky::AppBskyFeedPost},
+                  {"text", "sample post text"},
+                  {"langs", {"en"}},
+                  {"createdAt", "2026-01-01T00:00:00.000Z"}});
+    append_block(
+        _car, block_cid(_like_seed),
+        {{"$type", bsky::AppBskyFeedLike},
+         {"subject",
+          {{"uri", "at://did:plc:abc/app.bsky.feed.post/3lbrev1"},
+           {"cid", "bafyreib2rxk3rh6kzwq"}}},
+         {"via", {{"uri", "at://did:plc:def/app.bsky.feed.repost/3lbrev2"}}},
+         {"createdAt", "2026-01-01T00:00:01.000Z"}});
+    append_block(_car, block_cid(_node_seed),
+                 {{"l", nlohmann::json::binary(block_cid(_like_seed))},
+                  {"e", nlohmann::json::array()}});
+  }
+
+  static constexpr uint8_t _post_seed = 0;
+  static constexpr uint8_t _like_seed = 40;
+  static constexpr uint8_t _node_seed = 80;
+  std::vector<uint8_t> _car;
+};
+} // namespace
+
+TEST(CollectionPlanTest, PlanStringRoundTrip) {
+  for (auto const plan : {firehose::decode_plan::skip,
+                          firehose::decode_plan::minimal,
+                          firehose::decode_plan::full}) {
+    EXPECT_EQ(firehose::decode_plan_from_string(
+                  std::string(firehose::to_string(plan))),
+              plan);
+  }
+  EXPECT_THROW(firehose::decode_plan_from_string("partial"),
+               std::invalid_argument);
+}
+
+TEST(CollectionPlanTest, DefaultsAndOverrides) {
+  auto &plans(firehose::collection_plan::instance());
+  EXPECT_EQ(plans.plan_for(bsky::AppBskyFeedPost),
+            firehose::decode_plan::full);
+  EXPECT_EQ(plans.plan_for(bsky::AppBskyActorProfile),
+            firehose::decode_plan::full);
+  EXPECT_EQ(plans.plan_for(bsky::AppBskyFeedLike),
+            firehose::decode_plan::minimal);
+  EXPECT_EQ(plans.plan_for(bsky::AppBskyGraphBlock),
+            firehose::decode_plan::minimal);
+  EXPECT_EQ(plans.plan_for("app.bsky.feed.threadgate"),
+            firehose::decode_plan::skip);
+
+  YAML::Node settings;
+  settings["default"] = "minimal";
+  settings["collections"]["app.bsky.feed.threadgate"] = "full";
+  plans.set_config(settings);
+  EXPECT_EQ(plans.plan_for("app.bsky.feed.threadgate"),
+            firehose::decode_plan::full);
+  EXPECT_EQ(plans.plan_for("app.bsky.graph.listitem"),
+            firehose::decode_plan::minimal);
+  // built-in entries not named in config are retained
+  EXPECT_EQ(plans.plan_for(bsky::AppBskyFeedLike),
+            firehose::decode_plan::minimal);
+
+  YAML::Node invalid;
+  invalid["collections"]["app.bsky.feed.threadgate"] = "partial";
+  EXPECT_THROW(plans.set_config(invalid), std::invalid_argument);
+
+  // leave the singleton as the other tests expect
+  YAML::Node restore;
+  restore["default"] = "skip";
+  restore["collections"]["app.bsky.feed.threadgate"] = "skip";
+  plans.set_config(restore);
+}
+
+TEST(CollectionPlanTest, MinimalFields) {
+  EXPECT_TRUE(firehose::collection_plan::is_minimal_field("$type"));
+  EXPECT_TRUE(firehose::collection_plan::is_minimal_field("createdAt"));
+  EXPECT_TRUE(firehose::collection_plan::is_minimal_field("subject"));
+  EXPECT_FALSE(firehose::collection_plan::is_minimal_field("via"));
+  EXPECT_FALSE(firehose::collection_plan::is_minimal_field("text"));
+}
+
+TEST_F(CarDecodeTest, NoPlanDecodesAll) {
+  parser block_parser;
+  ASSERT_TRUE(block_parser.json_from_car(_car.cbegin(), _car.cend()));
+  ASSERT_EQ(block_parser.matchable_cbors().size(), 1u);
+  ASSERT_EQ(block_parser.content_cbors().size(), 1u);
+  EXPECT_TRUE(block_parser.content_cbors().front().second.contains("via"));
+  // untyped MST node
+  EXPECT_EQ(block_parser.other_cbors().size(), 1u);
+}
+
+TEST_F(CarDecodeTest, SkipAndMinimal) {
+  parser::block_plans plans;
+  plans.emplace(as_binary(block_cid(_post_seed)), firehose::decode_plan::full);
+  plans.emplace(as_binary(block_cid(_like_seed)),
+                firehose::decode_plan::minimal);
+  parser block_parser;
+  block_parser.plan_blocks(&plans);
+  ASSERT_TRUE(block_parser.json_from_car(_car.cbegin(), _car.cend()));
+
+  ASSERT_EQ(block_parser.matchable_cbors().size(), 1u);
+  auto const &post(block_parser.matchable_cbors().front());
+  EXPECT_EQ(post.first, as_binary(block_cid(_post_seed)));
+  EXPECT_EQ(post.second["text"], "sample post text");
+  EXPECT_TRUE(post.second.contains("langs"));
+
+  ASSERT_EQ(block_parser.content_cbors().size(), 1u);
+  auto const &like(block_parser.content_cbors().front());
+  EXPECT_EQ(like.first, as_binary(block_cid(_like_seed)));
+  EXPECT_EQ(like.second["$type"], std::string(bsky::AppBskyFeedLike));
+  EXPECT_EQ(like.second["subject"]["uri"],
+            "at://did:plc:abc/app.bsky.feed.post/3lbrev1");
+  EXPECT_TRUE(like.second.contains("createdAt"));
+  EXPECT_FALSE(like.second.contains("via"));
+
+  // MST node was not in the plan
+  EXPECT_TRUE(block_parser.other_cbors().empty());
+}
@@ -0,0 +1,150 @@
+#include <chrono>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "common/controller.hpp"
+#include "coordinated_actors.hpp"
+#include "testdefs.hpp"
+#include <thread>
+
+using firehose::coordination_detector;
+using firehose::interaction_index;
+using namespace std::chrono;
+
+namespace {
+std::string account(const size_t index) {
+  return "did:plc:account" + std::to_string(index);
+}
+std::string post(const size_t index) {
+  return "at://did:plc:target/app.bsky.feed.post/" + std::to_string(index);
+}
+
+// background of unrelated interactions, no two accounts share targets
+void background(interaction_index &index, bsky::time_stamp when,
+                const size_t count) {
+  for (size_t item = 0; item < count; ++item) {
+    index.add(account(1000 + item), post(1000 + item), when);
+  }
+}
+} // namespace
+
+TEST(CoordinatedActorsTest, GroupFlaggedOnce) {
+  interaction_index index(milliseconds(60000), milliseconds(10000), 100000, 20,
+                          3);
+  background(index, TestStart, 500);
+  // 30 accounts like the same 4 posts, 2 of them skip one post
+  for (size_t target = 0; target < 4; ++target) {
+    for (size_t actor = 0; actor < 30; ++actor) {
+      if (actor < 2 && target == 3)
+        continue;
+      index.add(account(actor), post(target), TestStart + seconds(1));
+    }
+  }
+  // a few accounts on one of the posts only, not part of the group
+  for (size_t actor = 100; actor < 105; ++actor) {
+    index.add(account(actor), post(0), TestStart + seconds(2));
+  }
+  EXPECT_TRUE(index.add(account(999), post(999), TestStart + seconds(11)));
+  auto groups(index.mine(TestStart + seconds(11)));
+  ASSERT_EQ(groups.size(), 1u);
+  EXPECT_EQ(groups[0]._targets, 4u);
+  EXPECT_EQ(groups[0]._accounts, 30u);
+  EXPECT_EQ(groups[0]._flag.size(), 30u);
+  EXPECT_THAT(groups[0]._flag, testing::Contains(account(0)));
+  EXPECT_THAT(groups[0]._flag, testing::Not(testing::Contains(account(100))));
+  EXPECT_EQ(index.flagged(), 30u);
+
+  // mined again, nothing new to flag. A late joiner is flagged alone.
+  EXPECT_TRUE(index.mine(TestStart + seconds(12)).empty());
+  for (size_t target = 0; target < 4; ++target) {
+    index.add(account(50), post(target), TestStart + seconds(12));
+  }
+  groups = index.mine(TestStart + seconds(13));
+  ASSERT_EQ(groups.size(), 1u);
+  EXPECT_THAT(groups[0]._flag, testing::ElementsAre(account(50)));
+}
+
+TEST(CoordinatedActorsTest, UnrelatedAudiencesNotFlagged) {
+  interaction_index index(milliseconds(60000), milliseconds(10000), 100000, 20,
+                          3);
+  // popular posts, each with its own audience
+  for (size_t target = 0; target < 10; ++target) {
+    for (size_t actor = 0; actor < 50; ++actor) {
+      index.add(account(target * 100 + actor), post(target), TestStart);
+    }
+  }
+  // and a group too small to matter
+  for (size_t target = 10; target < 14; ++target) {
+    for (size_t actor = 0; actor < 10; ++actor) {
+      index.add(account(5000 + actor), post(target), TestStart);
+    }
+  }
+  EXPECT_TRUE(index.mine(TestStart + seconds(1)).empty());
+  EXPECT_EQ(index.flagged(), 0u);
+}
+
+TEST(CoordinatedActorsTest, WindowAndCapBoundMemory) {
+  interaction_index index(milliseconds(60000), milliseconds(10000), 6000, 20,
+                          3);
+  // one bucket holds a sixth of the limit
+  background(index, TestStart, 2000);
+  EXPECT_EQ(index.interactions(), 1000u);
+  EXPECT_EQ(index.dropped(), 1000u);
+  // buckets older than the window are dropped whole
+  for (size_t second = 0; second < 300; second += 5) {
+    background(index, TestStart + seconds(second), 100);
+  }
+  EXPECT_LE(index.buckets(), 6u);
+  EXPECT_LE(index.interactions(), 6000u);
+  // a group spread beyond the window is not seen
+  for (size_t target = 0; target < 4; ++target) {
+    for (size_t actor = 0; actor < 30; ++actor) {
+      index.add(account(actor), post(target),
+                TestStart + seconds(400 + target * 70));
+    }
+  }
+  EXPECT_TRUE(index.mine(TestStart + seconds(611)).empty());
+}
+
+TEST(CoordinatedActorsTest, DetectorUsesFrameTime) {
+  controller::instance().start();
+  YAML::Node settings;
+  settings["min_actors"] = 20;
+  settings["min_targets"] = 3;
+  auto &detector(coordination_detector::instance());
+  detector.set_config(settings);
+  const pipeline::ingest_time ingested(pipeline::clock::now());
+  // a replayed backlog arrives at once, its frames are a minute apart
+  for (size_t target = 0; target < 4; ++target) {
+    for (size_t actor = 0; actor < 30; ++actor) {
+      EXPECT_TRUE(detector
+                      .interaction(account(actor), post(target),
+                                   TestStart + minutes(target), ingested)
+                      .empty());
+    }
+  }
+  // groups are mined on the detector thread and returned by a later call
+  std::vector<firehose::coordinated_group> groups;
+  for (size_t attempt = 0; attempt < 100 && groups.empty(); ++attempt) {
+    std::this_thread::sleep_for(milliseconds(10));
+    groups = detector.interaction(account(999), post(999),
+                                  TestStart + minutes(4), ingested);
+  }
+  EXPECT_TRUE(groups.empty());
+
+  // the same targets within one window are a group
+  for (size_t target = 10; target < 14; ++target) {
+    for (size_t actor = 0; actor < 30; ++actor) {
+      detector.interaction(account(actor), post(target),
+                           TestStart + minutes(5), ingested);
+    }
+  }
+  for (size_t attempt = 0; attempt < 100 && groups.empty(); ++attempt) {
+    std::this_thread::sleep_for(milliseconds(10));
+    groups = detector.interaction(account(999), post(999),
+                                  TestStart + minutes(6), ingested);
+  }
+  ASSERT_EQ(groups.size(), 1u);
+  EXPECT_EQ(groups[0]._targets, 4u);
+  EXPECT_EQ(groups[0]._flag.size(), 30u);
+}
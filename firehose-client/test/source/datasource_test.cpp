@@ -0,0 +1,375 @@
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <thread>
+
+#include "common/controller.hpp"
+#include "common/pipeline_timing.hpp"
+#include "datasource.hpp"
+#include "moderation/auxiliary_data.hpp"
+#include "payload.hpp"
+#include "testdefs.hpp"
+
+namespace {
+using tcp = boost::asio::ip::tcp;
+
+template <typename CONDITION> bool wait_until(CONDITION condition) {
+  auto const deadline(std::chrono::steady_clock::now() +
+                      std::chrono::seconds(10));
+  while (std::chrono::steady_clock::now() < deadline) {
+    if (condition())
+      return true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return false;
+}
+
+// Local TLS websocket relay. Records the target and time of each
+// subscription request and sends that connection's scripted frames. The
+// connection is then closed so the client reconnects, or held open for
+// frames pushed later.
+class relay_stand_in {
+public:
+  relay_stand_in(std::string const &address, const unsigned short port)
+      : _ssl(ssl::context::tlsv12_server),
+        _acceptor(_ioc, tcp::endpoint(net::ip::make_address(address), port)),
+        _endpoint(_acceptor.local_endpoint()) {
+    _ssl.use_certificate_chain_file(std::string(DataPath) +
+                                    "relay_stand_in.crt");
+    _ssl.use_private_key_file(std::string(DataPath) + "relay_stand_in.key",
+                              ssl::context::pem);
+    _thread = std::thread([this] { serve(); });
+  }
+  ~relay_stand_in() { stop(); }
+
+  inline unsigned short port() const { return _endpoint.port(); }
+
+  // frames for the next connection that has no script yet
+  void script(std::vector<std::string> &&frames, const bool hold = false) {
+    std::lock_guard lock(_lock);
+    _scripts.push_back({std::move(frames), hold});
+  }
+
+  // sent on the connection being held open
+  void push(std::string const &frame) {
+    std::lock_guard lock(_lock);
+    _pushed.push_back(frame);
+    _wake.notify_all();
+  }
+
+  // new connections are refused from here on
+  void stop() {
+    if (!_thread.joinable())
+      return;
+    {
+      std::lock_guard lock(_lock);
+      _stopping = true;
+      _wake.notify_all();
+    }
+    // wake the blocking accept
+    net::io_context ioc;
+    tcp::socket wake(ioc);
+    beast::error_code ec;
+    wake.connect(_endpoint, ec);
+    _thread.join();
+    _acceptor.close(ec);
+  }
+
+  bool wait_for(const size_t connections) const {
+    return wait_until([&] { return targets().size() >= connections; });
+  }
+
+  std::vector<std::string> targets() const {
+    std::lock_guard lock(_lock);
+    return _targets;
+  }
+
+  std::vector<std::chrono::steady_clock::time_point> connected() const {
+    std::lock_guard lock(_lock);
+    return _connected;
+  }
+
+private:
+  struct connection {
+    std::vector<std::string> _frames;
+    bool _hold = false;
+  };
+
+  connection next_script() {
+    std::lock_guard lock(_lock);
+    if (_scripts.empty())
+      return {};
+    connection next(std::move(_scripts.front()));
+    _scripts.pop_front();
+    return next;
+  }
+
+  template <typename STREAM>
+  void send(STREAM &ws, connection const &script) {
+    beast::error_code ec;
+    ws.binary(true);
+    for (auto const &frame : script._frames) {
+      ws.write(net::buffer(frame), ec);
+    }
+    if (!script._hold)
+      return;
+    std::unique_lock lock(_lock);
+    while (!_stopping) {
+      _wake.wait(lock, [this] { return _stopping || !_pushed.empty(); });
+      while (!_pushed.empty()) {
+        std::string frame(std::move(_pushed.front()));
+        _pushed.pop_front();
+        lock.unlock();
+        ws.write(net::buffer(frame), ec);
+        lock.lock();
+      }
+    }
+  }
+
+  void serve() {
+    while (!_stopping) {
+      tcp::socket socket(_ioc);
+      beast::error_code ec;
+      _acceptor.accept(socket, ec);
+      if (ec || _stopping)
+        break;
+      websocket::stream<ssl::stream<tcp::socket>> ws(std::move(socket), _ssl);
+      ws.next_layer().handshake(ssl::stream_base::server, ec);
+      if (ec)
+        continue;
+      beast::flat_buffer buffer;
+      http::request<http::string_body> request;
+      http::read(ws.next_layer(), buffer, request, ec);
+      if (ec)
+        continue;
+      {
+        std::lock_guard lock(_lock);
+        _targets.emplace_back(request.target());
+        _connected.push_back(std::chrono::steady_clock::now());
+      }
+      ws.accept(request, ec);
+      if (ec)
+        continue;
+      send(ws, next_script());
+      ws.close(websocket::close_code::going_away, ec);
+    }
+  }
+
+  net::io_context _ioc;
+  ssl::context _ssl;
+  tcp::acceptor _acceptor;
+  tcp::endpoint _endpoint;
+  std::atomic<bool> _stopping = false;
+  std::thread _thread;
+  mutable std::mutex _lock;
+  std::condition_variable _wake;
+  std::vector<std::string> _targets;
+  std::vector<std::chrono::steady_clock::time_point> _connected;
+  std::deque<connection> _scripts;
+  std::deque<std::string> _pushed;
+};
+
+constexpr std::string_view Subscription =
+    "/xrpc/com.atproto.sync.subscribeRepos";
+
+std::shared_ptr<config> relays_config(std::string const &hosts,
+                                      const unsigned short port,
+                                      std::string const &options = {}) {
+  const std::filesystem::path filename(
+      std::filesystem::temp_directory_path() / "datasource_test.yml");
+  {
+    std::ofstream file(filename, std::ios::trunc);
+    file << PROJECT_NAME << ":\n"
+         << "  datasource:\n"
+         << "    hosts: " << hosts << "\n"
+         << "    port: \"" << port << "\"\n"
+         << "    subscription: \"" << Subscription << "\"\n"
+         << options;
+  }
+  auto settings(std::make_shared<config>(filename.string()));
+  std::filesystem::remove(filename);
+  return settings;
+}
+
+std::shared_ptr<config> two_relays(const unsigned short port) {
+  return relays_config("[\"127.0.0.1\", \"127.0.0.2\"]", port);
+}
+
+// header and message CBORs of an #identity event, which the post-processor
+// handles without side effects other than the rewind point
+std::string identity_frame(const int64_t seq, std::string const &did,
+                           std::string const &time) {
+  auto const header(nlohmann::json::to_cbor({{"op", 1}, {"t", "#identity"}}));
+  auto const message(nlohmann::json::to_cbor(
+      {{"did", did}, {"seq", seq}, {"time", time}}));
+  std::string frame(header.cbegin(), header.cend());
+  frame.append(message.cbegin(), message.cend());
+  return frame;
+}
+
+std::string now_iso_8601() {
+  return std::format("{:%FT%TZ}",
+                     std::chrono::floor<std::chrono::milliseconds>(
+                         std::chrono::system_clock::now()));
+}
+
+class DatasourceTest : public ::testing::Test {
+protected:
+  static void SetUpTestSuite() {
+    datasource<firehose_payload>::register_metrics();
+    add_process_metrics();
+  }
+};
+} // namespace
+
+TEST_F(DatasourceTest, TwoRelaysInitialCursor) {
+  relay_stand_in first("127.0.0.1", 0);
+  relay_stand_in second("127.0.0.2", first.port());
+  auto settings(two_relays(first.port()));
+
+  controller::instance().start();
+  {
+    datasource<firehose_payload> source;
+    source.set_config(settings, 1234);
+    source.start();
+    ASSERT_TRUE(first.wait_for(2));
+    ASSERT_TRUE(second.wait_for(2));
+    controller::instance().force_stop();
+    first.stop();
+    second.stop();
+    source.wait_for_end_thread();
+  }
+  controller::instance().start();
+
+  const std::string resumed(std::string(Subscription) + "?cursor=1234");
+  auto const first_targets(first.targets());
+  // nothing was delivered, so the reconnect also resumes at the cursor
+  EXPECT_EQ(first_targets[0], resumed);
+  EXPECT_EQ(first_targets[1], resumed);
+  auto const second_targets(second.targets());
+  EXPECT_EQ(second_targets[0], Subscription);
+  EXPECT_EQ(second_targets[1], Subscription);
+}
+
+// Reconnects back off while a relay delivers nothing, and resume from the
+// last frame received once it does
+TEST_F(DatasourceTest, BackoffAndCursorResume) {
+  relay_stand_in relay("127.0.0.1", 0);
+  // four empty connections, then one that delivers frames
+  for (size_t connection = 0; connection < 4; ++connection) {
+    relay.script({});
+  }
+  const std::string time(now_iso_8601());
+  relay.script({identity_frame(10, "did:plc:first", time),
+                identity_frame(11, "did:plc:second", time),
+                identity_frame(12, "did:plc:third", time)});
+  auto settings(relays_config("\"127.0.0.1\"", relay.port()));
+
+  controller::instance().start();
+  {
+    datasource<firehose_payload> source;
+    source.set_config(settings, 1234);
+    source.start();
+    ASSERT_TRUE(relay.wait_for(6));
+    controller::instance().force_stop();
+    relay.stop();
+    source.wait_for_end_thread();
+  }
+  controller::instance().start();
+
+  const std::string initial(std::string(Subscription) + "?cursor=1234");
+  auto const targets(relay.targets());
+  for (size_t connection = 0; connection < 5; ++connection) {
+    EXPECT_EQ(targets[connection], initial);
+  }
+  EXPECT_EQ(targets[5], std::string(Subscription) + "?cursor=12");
+
+  // delay is at least half of a window that doubles from 50ms
+  auto const connected(relay.connected());
+  for (size_t attempt = 0; attempt < 4; ++attempt) {
+    EXPECT_GE(connected[attempt + 1] - connected[attempt],
+              std::chrono::milliseconds(25 << attempt));
+  }
+  // frames were received, so backoff starts over instead of doubling again
+  EXPECT_LT(connected[5] - connected[4], std::chrono::milliseconds(400));
+}
+
+// Standby frames are held until the standby relay takes over, then replayed
+// through dedup: events the active relay delivered are dropped, the rest are
+// handled. Only the primary relay's seq moves the restart point.
+TEST_F(DatasourceTest, StandbySwapReplaysHeldFrames) {
+  relay_stand_in primary("127.0.0.1", 0);
+  relay_stand_in standby("127.0.0.2", primary.port());
+  const std::string time(now_iso_8601());
+  // the primary delivers two events, then goes quiet
+  primary.script({identity_frame(101, "did:plc:first", time),
+                  identity_frame(102, "did:plc:second", time)},
+                 true);
+  standby.script({}, true);
+  auto settings(relays_config("[\"127.0.0.1\", \"127.0.0.2\"]",
+                              primary.port(), "    relay_mode: standby\n"));
+
+  auto &received(metrics_factory::instance()
+                     .get_counter("websocket_inbound_messages")
+                     .Get({{"host", "127.0.0.2"}}));
+  auto &handled(metrics_factory::instance()
+                    .get_counter("firehose_content")
+                    .Get({{"op", "message"}, {"type", "#identity"}}));
+  auto &duplicates(metrics_factory::instance()
+                       .get_counter("websocket_duplicate_messages")
+                       .Add({}));
+  auto &swaps(metrics_factory::instance()
+                  .get_counter("websocket_relay_swaps")
+                  .Get({{"from", "127.0.0.1"}, {"to", "127.0.0.2"}}));
+  const double received_before(received.Value());
+  const double handled_before(handled.Value());
+  const double duplicates_before(duplicates.Value());
+  const double swaps_before(swaps.Value());
+
+  controller::instance().start();
+  {
+    datasource<firehose_payload> source;
+    source.set_config(settings, 0);
+    source.start();
+    ASSERT_TRUE(standby.wait_for(1));
+    ASSERT_TRUE(
+        wait_until([&] { return handled.Value() == handled_before + 2; }));
+    // copies of both, and an event the primary missed
+    standby.push(identity_frame(201, "did:plc:first", time));
+    standby.push(identity_frame(202, "did:plc:second", time));
+    standby.push(identity_frame(203, "did:plc:third", time));
+    ASSERT_TRUE(
+        wait_until([&] { return received.Value() == received_before + 3; }));
+    EXPECT_EQ(handled.Value(), handled_before + 2);
+
+    // the pipeline falls behind, so the next standby frame takes over
+    pipeline::stage_timer::instance().record_lag(bsky::current_time() -
+                                                 std::chrono::minutes(5));
+    standby.push(identity_frame(204, "did:plc:fourth", time));
+    EXPECT_TRUE(
+        wait_until([&] { return handled.Value() == handled_before + 4; }));
+    controller::instance().force_stop();
+    primary.stop();
+    standby.stop();
+    source.wait_for_end_thread();
+  }
+  controller::instance().start();
+
+  EXPECT_EQ(swaps.Value(), swaps_before + 1);
+  EXPECT_EQ(duplicates.Value(), duplicates_before + 2);
+  EXPECT_EQ(handled.Value(), handled_before + 4);
+  EXPECT_EQ(bsky::moderation::auxiliary_data::instance().last_processed(),
+            102);
+}
@@ -0,0 +1,98 @@
+#include <filesystem>
+#include <fstream>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <sstream>
+
+#include "common/controller.hpp"
+#include "event_journal.hpp"
+
+namespace {
+journal::record sample(const int64_t seq, const journal::event_kind kind) {
+  return {seq,
+          bsky::time_stamp(std::chrono::milliseconds(1767225600000 + seq)),
+          kind,
+          "did:plc:abc",
+          kind == journal::event_kind::match ? "app.bsky.feed.post/3lbrev1"
+                                             : "",
+          kind == journal::event_kind::match ? "bafyreib2rxk3rh6kzwq" : "",
+          kind == journal::event_kind::account ? "deactivated" : "",
+          kind == journal::event_kind::match
+              ? std::vector<std::string>{"first rule", "second"}
+              : std::vector<std::string>{}};
+}
+
+void expect_same(journal::record const &actual,
+                 journal::record const &expected) {
+  EXPECT_EQ(actual._seq, expected._seq);
+  EXPECT_EQ(actual._emitted_at, expected._emitted_at);
+  EXPECT_EQ(actual._kind, expected._kind);
+  EXPECT_EQ(actual._did, expected._did);
+  EXPECT_EQ(actual._path, expected._path);
+  EXPECT_EQ(actual._cid, expected._cid);
+  EXPECT_EQ(actual._detail, expected._detail);
+  EXPECT_THAT(actual._rules, ::testing::ContainerEq(expected._rules));
+}
+} // namespace
+
+TEST(EventJournalTest, RecordRoundTrip) {
+  std::vector<journal::record> written(
+      {sample(1, journal::event_kind::identity),
+       sample(2, journal::event_kind::account),
+       sample(3, journal::event_kind::tombstone),
+       sample(4, journal::event_kind::match)});
+  std::stringstream stream;
+  journal::write_header(stream);
+  for (auto const &value : written) {
+    journal::write_record(stream, value);
+  }
+
+  ASSERT_TRUE(journal::read_header(stream));
+  for (auto const &expected : written) {
+    journal::record actual;
+    ASSERT_TRUE(journal::read_record(stream, actual));
+    expect_same(actual, expected);
+  }
+  journal::record past_end;
+  EXPECT_FALSE(journal::read_record(stream, past_end));
+}
+
+TEST(EventJournalTest, TruncatedRecordRejected) {
+  std::stringstream stream;
+  journal::write_record(stream, sample(4, journal::event_kind::match));
+  std::string encoded(stream.str());
+  std::istringstream truncated(encoded.substr(0, encoded.length() - 1));
+  journal::record value;
+  EXPECT_FALSE(journal::read_record(truncated, value));
+  std::istringstream no_magic("PEFJRNL0");
+  EXPECT_FALSE(journal::read_header(no_magic));
+}
+
+TEST(EventJournalTest, QueuedRecordsWrittenAtStop) {
+  const std::filesystem::path filename(
+      std::filesystem::temp_directory_path() / "event_journal_test.bin");
+  std::filesystem::remove(filename);
+  controller::instance().start();
+  YAML::Node settings;
+  settings["filename"] = filename.string();
+  journal::event_journal::instance().start(settings);
+  ASSERT_TRUE(journal::event_journal::instance().is_enabled());
+  constexpr int64_t Records = 1000;
+  for (int64_t seq = 1; seq <= Records; ++seq) {
+    journal::event_journal::instance().record(
+        sample(seq, journal::event_kind::match));
+  }
+  journal::event_journal::instance().stop();
+
+  std::ifstream file(filename, std::ios::binary);
+  ASSERT_TRUE(journal::read_header(file));
+  int64_t seq(0);
+  journal::record actual;
+  while (journal::read_record(file, actual)) {
+    ++seq;
+    expect_same(actual, sample(seq, journal::event_kind::match));
+  }
+  EXPECT_EQ(seq, Records);
+  file.close();
+  std::filesystem::remove(filename);
+}
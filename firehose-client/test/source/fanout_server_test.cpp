@@ -0,0 +1,146 @@
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/websocket.hpp>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "common/controller.hpp"
+#include "fanout_server.hpp"
+
+namespace {
+namespace websocket = beast::websocket;
+using tcp = net::ip::tcp;
+
+beast::flat_buffer frame_of(std::string const &content) {
+  beast::flat_buffer frame;
+  beast::ostream(frame) << content;
+  return frame;
+}
+
+// subscriber over a plain websocket, as local tools connect
+class subscriber {
+public:
+  subscriber(const unsigned short port, std::string const &target)
+      : _ws(_ioc) {
+    _ws.next_layer().connect(
+        tcp::endpoint(net::ip::make_address("127.0.0.1"), port));
+    websocket::response_type response;
+    _ws.handshake(response, "127.0.0.1", target);
+    _first = std::string(response["X-Fanout-Cursor"]);
+  }
+
+  inline std::string const &first() const { return _first; }
+
+  std::string next() {
+    beast::flat_buffer buffer;
+    _ws.read(buffer);
+    return beast::buffers_to_string(buffer.data());
+  }
+
+  // frames until the server closes the session
+  beast::error_code drain(size_t &frames) {
+    beast::error_code ec;
+    while (true) {
+      beast::flat_buffer buffer;
+      _ws.read(buffer, ec);
+      if (ec)
+        return ec;
+      ++frames;
+    }
+  }
+  inline websocket::close_reason reason() const { return _ws.reason(); }
+
+private:
+  net::io_context _ioc;
+  websocket::stream<tcp::socket> _ws;
+  std::string _first;
+};
+
+class FanoutServerTest : public ::testing::Test {
+protected:
+  static void SetUpTestSuite() {
+    fanout_server::register_metrics();
+    controller::instance().start();
+  }
+
+  void SetUp() override {
+    // find a free port, the server binds it again with reuse_address
+    net::io_context ioc;
+    tcp::acceptor probe(ioc,
+                        tcp::endpoint(net::ip::make_address("127.0.0.1"), 0));
+    _port = probe.local_endpoint().port();
+  }
+
+  std::unique_ptr<fanout_server> start_server(const size_t ring_frames) {
+    YAML::Node settings;
+    settings["port"] = _port;
+    settings["ring_frames"] = ring_frames;
+    auto server(std::make_unique<fanout_server>(settings));
+    server->start();
+    // the acceptor is opened on the server thread
+    for (size_t attempt = 0; attempt < 100; ++attempt) {
+      net::io_context ioc;
+      tcp::socket probe(ioc);
+      beast::error_code ec;
+      probe.connect(tcp::endpoint(net::ip::make_address("127.0.0.1"), _port),
+                    ec);
+      if (!ec)
+        break;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return server;
+  }
+
+  unsigned short _port = 0;
+};
+} // namespace
+
+TEST_F(FanoutServerTest, ReplayFromCursor) {
+  auto server(start_server(3));
+  for (auto const content : {"1", "2", "3", "4", "5"}) {
+    server->publish(frame_of(content));
+  }
+
+  // 1 and 2 are evicted, replay starts at the oldest frame held
+  subscriber oldest(_port, "/?cursor=1");
+  EXPECT_EQ(oldest.first(), "3");
+  EXPECT_EQ(oldest.next(), "3");
+  EXPECT_EQ(oldest.next(), "4");
+  EXPECT_EQ(oldest.next(), "5");
+
+  subscriber replay(_port, "/?cursor=4");
+  EXPECT_EQ(replay.first(), "4");
+  EXPECT_EQ(replay.next(), "4");
+
+  // without a cursor, only frames published from now on
+  subscriber live(_port, "/");
+  EXPECT_EQ(live.first(), "6");
+
+  server->publish(frame_of("6"));
+  EXPECT_EQ(oldest.next(), "6");
+  EXPECT_EQ(replay.next(), "5");
+  EXPECT_EQ(replay.next(), "6");
+  EXPECT_EQ(live.next(), "6");
+}
+
+TEST_F(FanoutServerTest, LaggingSubscriberDropped) {
+  auto server(start_server(2));
+  const std::string large(1024 * 1024, 'x');
+  server->publish(frame_of(large));
+  subscriber lagging(_port, "/?cursor=1");
+  EXPECT_EQ(lagging.first(), "1");
+
+  // the subscriber does not read, so the server stalls on a write while the
+  // frames it still has to send are evicted
+  constexpr size_t Published = 64;
+  for (size_t frame = 1; frame < Published; ++frame) {
+    server->publish(frame_of(large));
+  }
+  size_t frames(0);
+  lagging.drain(frames);
+  EXPECT_LT(frames, Published);
+  EXPECT_EQ(lagging.reason().code, websocket::close_code::policy_error);
+}
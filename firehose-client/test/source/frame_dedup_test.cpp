@@ -0,0 +1,84 @@
+#include <chrono>
+#include <cstring>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <string>
+
+#include "frame_dedup.hpp"
+
+TEST(FrameDedupTest, DuplicateInWindow) {
+  frame_dedup dedup(4);
+  const uint64_t commit(frame_dedup::key_for("did:plc:abc", "3lbrev1"));
+  EXPECT_TRUE(dedup.first_sighting(commit));
+  EXPECT_FALSE(dedup.first_sighting(commit));
+  EXPECT_TRUE(
+      dedup.first_sighting(frame_dedup::key_for("did:plc:abc", "3lbrev2")));
+  EXPECT_TRUE(
+      dedup.first_sighting(frame_dedup::key_for("did:plc:xyz", "3lbrev1")));
+  EXPECT_EQ(dedup.size(), 3u);
+}
+
+TEST(FrameDedupTest, FieldsAreOrdered) {
+  EXPECT_NE(frame_dedup::key_for("a", "b"), frame_dedup::key_for("b", "a"));
+  EXPECT_NE(frame_dedup::key_for("did", "time", "#identity"),
+            frame_dedup::key_for("did", "time", "#account"));
+}
+
+TEST(FrameDedupTest, OldestEvicted) {
+  frame_dedup dedup(3);
+  for (uint64_t key = 1; key <= 3; ++key) {
+    EXPECT_TRUE(dedup.first_sighting(key));
+  }
+  // evicts 1
+  EXPECT_TRUE(dedup.first_sighting(4));
+  EXPECT_EQ(dedup.size(), 3u);
+  EXPECT_FALSE(dedup.first_sighting(2));
+  EXPECT_FALSE(dedup.first_sighting(4));
+  EXPECT_TRUE(dedup.first_sighting(1));
+  // 1 evicted 2
+  EXPECT_TRUE(dedup.first_sighting(2));
+}
+
+namespace {
+boost::beast::flat_buffer frame(std::string const &content) {
+  boost::beast::flat_buffer buffer;
+  auto target(buffer.prepare(content.size()));
+  std::memcpy(target.data(), content.data(), content.size());
+  buffer.commit(content.size());
+  return buffer;
+}
+
+std::string content(boost::beast::flat_buffer const &buffer) {
+  return boost::beast::buffers_to_string(buffer.data());
+}
+} // namespace
+
+TEST(HeldFramesTest, ReleasedOldestFirst) {
+  held_frames held(std::chrono::milliseconds(1000), 4);
+  const auto now(held_frames::clock::now());
+  held.hold(frame("first"), now);
+  held.hold(frame("second"), now);
+  EXPECT_EQ(content(held.newest()), "second");
+  auto const released(held.release());
+  ASSERT_EQ(released.size(), 2u);
+  EXPECT_EQ(content(released.front().second), "first");
+  EXPECT_EQ(content(released.back().second), "second");
+  EXPECT_TRUE(held.empty());
+}
+
+TEST(HeldFramesTest, OldestDroppedByAgeAndLimit) {
+  held_frames held(std::chrono::milliseconds(1000), 3);
+  const auto start(held_frames::clock::now());
+  held.hold(frame("stale"), start);
+  held.hold(frame("first"), start + std::chrono::milliseconds(600));
+  // stale is past the span
+  held.hold(frame("second"), start + std::chrono::milliseconds(1200));
+  EXPECT_EQ(held.size(), 2u);
+  held.hold(frame("third"), start + std::chrono::milliseconds(1300));
+  // at the limit, first goes
+  held.hold(frame("fourth"), start + std::chrono::milliseconds(1400));
+  auto const released(held.release());
+  ASSERT_EQ(released.size(), 3u);
+  EXPECT_EQ(content(released.front().second), "second");
+  EXPECT_EQ(content(released.back().second), "fourth");
+}
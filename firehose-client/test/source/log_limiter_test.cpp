@@ -0,0 +1,99 @@
+#include <chrono>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <string_view>
+#include <thread>
+
+#include "common/log_limiter.hpp"
+
+TEST(LogLimiterTest, BurstThenSuppress) {
+  log_limiter limiter(3, 0, std::chrono::seconds(1));
+  uint64_t suppressed(0);
+  for (size_t call = 0; call < 3; ++call) {
+    EXPECT_TRUE(limiter.should_log(suppressed));
+    EXPECT_EQ(suppressed, 0u);
+  }
+  for (size_t call = 0; call < 4; ++call) {
+    EXPECT_FALSE(limiter.should_log(suppressed));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+  // the 5th suppressed call checks the clock, the new interval reports what
+  // was dropped in the old one
+  EXPECT_TRUE(limiter.should_log(suppressed));
+  EXPECT_EQ(suppressed, 4u);
+  EXPECT_TRUE(limiter.should_log(suppressed));
+  EXPECT_EQ(suppressed, 0u);
+  EXPECT_TRUE(limiter.should_log(suppressed));
+  EXPECT_FALSE(limiter.should_log(suppressed));
+}
+
+TEST(LogLimiterTest, ClockReadOnlyWhenDue) {
+  log_limiter limiter(1, 0, std::chrono::seconds(1));
+  uint64_t suppressed(0);
+  EXPECT_TRUE(limiter.should_log(suppressed));
+  for (size_t call = 0; call < 5; ++call) {
+    EXPECT_FALSE(limiter.should_log(suppressed));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+  // the expired interval is not seen until the 8th suppressed call
+  for (size_t call = 5; call < 8; ++call) {
+    EXPECT_FALSE(limiter.should_log(suppressed));
+  }
+  EXPECT_TRUE(limiter.should_log(suppressed));
+  EXPECT_EQ(suppressed, 8u);
+  // and past the doubling checks, every ClockCheck calls
+  for (uint64_t call = 1; call < 2 * log_limiter::ClockCheck; ++call) {
+    limiter.should_log(suppressed);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+  size_t until_logged(0);
+  while (!limiter.should_log(suppressed)) {
+    ++until_logged;
+  }
+  EXPECT_LT(until_logged, log_limiter::ClockCheck);
+}
+
+TEST(LogLimiterTest, Sampled) {
+  log_limiter limiter(0, 4, std::chrono::seconds(60));
+  uint64_t suppressed(0);
+  size_t logged(0);
+  for (size_t call = 0; call < 100; ++call) {
+    if (limiter.should_log(suppressed))
+      ++logged;
+  }
+  EXPECT_EQ(logged, 25u);
+}
+
+TEST(LogLimiterTest, SampledReportsSuppressed) {
+  log_limiter limiter(2, 5, std::chrono::seconds(60));
+  uint64_t suppressed(0);
+  EXPECT_TRUE(limiter.should_log(suppressed));
+  EXPECT_TRUE(limiter.should_log(suppressed));
+  // first beyond the burst is sampled
+  EXPECT_TRUE(limiter.should_log(suppressed));
+  EXPECT_EQ(suppressed, 0u);
+  for (size_t call = 0; call < 4; ++call) {
+    EXPECT_FALSE(limiter.should_log(suppressed));
+  }
+  EXPECT_TRUE(limiter.should_log(suppressed));
+  EXPECT_EQ(suppressed, 4u);
+}
+
+TEST(LogLimiterTest, QuietSiteReportedAtShutdown) {
+  static log_limiter limiter(1, 0, log_limiter::site{"quiet.cpp", 42});
+  uint64_t suppressed(0);
+  EXPECT_TRUE(limiter.should_log(suppressed));
+  for (size_t call = 0; call < 7; ++call) {
+    EXPECT_FALSE(limiter.should_log(suppressed));
+  }
+  uint64_t reported(0);
+  auto report([&](log_limiter::site const &where, const uint64_t count) {
+    if (std::string_view(where._file) == "quiet.cpp" && where._line == 42)
+      reported += count;
+  });
+  log_limiter::report_suppressed(report);
+  EXPECT_EQ(reported, 7u);
+  // counted once only
+  log_limiter::report_suppressed(report);
+  EXPECT_EQ(reported, 7u);
+}
@@ -0,0 +1,102 @@
+#include <chrono>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "near_duplicates.hpp"
+#include "testdefs.hpp"
+
+using firehose::near_duplicate_index;
+using firehose::text_signature;
+using namespace std::chrono;
+
+namespace {
+constexpr std::string_view Campaign =
+    "Claim your free crypto airdrop today before the offer ends, just connect "
+    "your wallet at the link in my profile and collect the reward";
+// campaign with a few words varied per post
+constexpr std::array<std::string_view, 4> Variants = {
+    "Claim your free crypto airdrop now before the offer ends, just connect "
+    "your wallet at the link in my profile and collect the reward",
+    "Claim your free crypto airdrop today before the offer ends, just connect "
+    "your wallet at the link in my bio and collect the reward",
+    "Grab your free crypto airdrop today before the offer ends, just connect "
+    "your wallet at the link in my profile and collect your reward",
+    "Claim your free crypto airdrop today before the promo ends, simply "
+    "connect your wallet at the link in my profile and collect the reward"};
+constexpr std::string_view Unrelated =
+    "Spent the afternoon marking essays and I think the new rubric is working "
+    "better than last year, the students seem to find it much clearer";
+
+text_signature::minhashes signature(std::string_view text) {
+  return text_signature::of(text)._minhashes;
+}
+} // namespace
+
+TEST(NearDuplicatesTest, Signature) {
+  auto campaign(text_signature::of(Campaign));
+  EXPECT_EQ(campaign._shingles, 23u);
+  // case and punctuation do not matter
+  EXPECT_EQ(signature("CLAIM your free crypto airdrop today!! before the offer "
+                      "ends - just connect your wallet at the link in my "
+                      "profile and collect the reward"),
+            campaign._minhashes);
+  for (auto const variant : Variants) {
+    EXPECT_GE(text_signature::agreement(campaign._minhashes,
+                                        signature(variant)),
+              near_duplicate_index::MinAgreement)
+        << variant;
+  }
+  EXPECT_LT(
+      text_signature::agreement(campaign._minhashes, signature(Unrelated)),
+      near_duplicate_index::MinAgreement);
+  EXPECT_EQ(text_signature::of("single")._shingles, 0u);
+}
+
+TEST(NearDuplicatesTest, ClusterFlaggedOnce) {
+  near_duplicate_index index(milliseconds(60000), 1000, 3);
+  EXPECT_TRUE(
+      index.add("did:plc:one", signature(Campaign), TestStart)._flag.empty());
+  // same account again is not a second account
+  EXPECT_TRUE(index.add("did:plc:one", signature(Variants[0]), TestStart)
+                  ._flag.empty());
+  EXPECT_TRUE(
+      index.add("did:plc:two", signature(Unrelated), TestStart)._flag.empty());
+  EXPECT_TRUE(index.add("did:plc:two", signature(Variants[1]), TestStart)
+                  ._flag.empty());
+  auto cluster(index.add("did:plc:three", signature(Variants[2]),
+                         TestStart + seconds(1)));
+  EXPECT_EQ(cluster._accounts, 3u);
+  EXPECT_THAT(cluster._flag,
+              testing::UnorderedElementsAre("did:plc:one", "did:plc:two",
+                                            "did:plc:three"));
+  // members already flagged are not flagged again, a new account is
+  EXPECT_TRUE(index.add("did:plc:two", signature(Variants[3]),
+                        TestStart + seconds(2))
+                  ._flag.empty());
+  cluster = index.add("did:plc:four", signature(Variants[3]),
+                      TestStart + seconds(3));
+  EXPECT_EQ(cluster._accounts, 4u);
+  EXPECT_THAT(cluster._flag, testing::ElementsAre("did:plc:four"));
+}
+
+TEST(NearDuplicatesTest, WindowAndCapBoundMemory) {
+  near_duplicate_index index(milliseconds(1000), 100, 2);
+  for (size_t post = 0; post < 1000; ++post) {
+    index.add("did:plc:" + std::to_string(post),
+              signature("post number " + std::to_string(post) + " of many"),
+              TestStart + milliseconds(post));
+  }
+  EXPECT_EQ(index.posts(), 100u);
+  EXPECT_LE(index.buckets(), 100 * near_duplicate_index::Bands);
+  // an old post is forgotten
+  near_duplicate_index aged(milliseconds(1000), 100, 2);
+  aged.add("did:plc:one", signature(Campaign), TestStart);
+  EXPECT_TRUE(
+      aged.add("did:plc:two", signature(Campaign), TestStart + seconds(2))
+          ._flag.empty());
+  EXPECT_EQ(
+      aged.add("did:plc:three", signature(Campaign), TestStart + seconds(2))
+          ._flag.size(),
+      2u);
+  EXPECT_EQ(aged.posts(), 2u);
+}
@@ -0,0 +1,68 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "common/bluesky/platform.hpp"
+#include "common/pipeline_timing.hpp"
+#include "overload_policy.hpp"
+
+namespace {
+void set_lag(const std::chrono::seconds lag) {
+  pipeline::stage_timer::instance().record_lag(bsky::current_time() - lag);
+}
+
+size_t admitted(const firehose::sheddable work, const size_t attempts) {
+  size_t count(0);
+  for (size_t attempt = 0; attempt < attempts; ++attempt) {
+    if (firehose::overload_policy::instance().admit(work))
+      ++count;
+  }
+  return count;
+}
+} // namespace
+
+TEST(OverloadPolicyTest, InvalidConfig) {
+  YAML::Node settings;
+  settings["keep_one_in"] = 0;
+  EXPECT_THROW(firehose::overload_policy::instance().set_config(settings),
+               std::invalid_argument);
+  settings["keep_one_in"] = 10;
+  settings["shed_lag_ms"] = 1000;
+  settings["recover_lag_ms"] = 2000;
+  EXPECT_THROW(firehose::overload_policy::instance().set_config(settings),
+               std::invalid_argument);
+}
+
+TEST(OverloadPolicyTest, Hysteresis) {
+  auto &policy(firehose::overload_policy::instance());
+  YAML::Node settings;
+  settings["shed_lag_ms"] = 60000;
+  settings["recover_lag_ms"] = 15000;
+  settings["keep_one_in"] = 10;
+  policy.set_config(settings);
+
+  // between the thresholds, not yet overloaded
+  set_lag(std::chrono::seconds(30));
+  EXPECT_EQ(admitted(firehose::sheddable::social_graph, 20), 20u);
+  EXPECT_FALSE(policy.overloaded());
+
+  set_lag(std::chrono::seconds(90));
+  EXPECT_EQ(admitted(firehose::sheddable::facet_metrics, 20), 2u);
+  EXPECT_TRUE(policy.overloaded());
+  // each class is sampled independently
+  EXPECT_EQ(admitted(firehose::sheddable::coordination, 1), 1u);
+
+  // between the thresholds, still overloaded
+  set_lag(std::chrono::seconds(30));
+  EXPECT_EQ(admitted(firehose::sheddable::language_metrics, 20), 2u);
+  EXPECT_TRUE(policy.overloaded());
+
+  set_lag(std::chrono::seconds(5));
+  EXPECT_EQ(admitted(firehose::sheddable::social_graph, 20), 20u);
+  EXPECT_FALSE(policy.overloaded());
+
+  // back between the thresholds, stays recovered
+  set_lag(std::chrono::seconds(30));
+  EXPECT_EQ(admitted(firehose::sheddable::social_graph, 20), 20u);
+  EXPECT_FALSE(policy.overloaded());
+  set_lag(std::chrono::seconds(0));
+}
@@ -94,3 +94,42 @@ TEST(ParseTest, JSONFromCAR) {
       commit["blocks"]["bytes"].template get<std::vector<unsigned char>>());
   ASSERT_TRUE(parser().json_from_car(blocks.cbegin(), blocks.cend()));
 }
+
+TEST(ParseTest, JetstreamMatchesJSON) {
+  const std::vector<std::string> frames(
+      {R"({"did":"did:plc:abc","time_us":1767225600000000,"kind":"commit",)"
+       R"("commit":{"operation":"create","collection":"app.bsky.feed.post",)"
+       R"("rkey":"3lbrev1","cid":"bafyreib2rxk3rh6kzwq","record":{)"
+       R"("$type":"app.bsky.feed.post","text":"say \"café\"\nnow \\ )"
+       R"(😀","embed":{"$type":"app.bsky.embed.external",)"
+       R"("external":{"uri":"https://example.com/a?b=1&c=2","title":"T",)"
+       R"("description":"tab\there"}},"createdAt":"2026-01-01T00:00:00Z"}}})",
+       R"({"did":"did:plc:abc","time_us":1767225600000000,"kind":"commit",)"
+       R"("commit":{"operation":"update",)"
+       R"("collection":"app.bsky.actor.profile",)"
+       R"("rkey":"self","record":{"$type":"app.bsky.actor.profile",)"
+       R"("displayName":"хохол","description":"")"
+       R"(}}})",
+       R"({"did":"did:plc:abc","time_us":1767225600000000,"kind":"identity",)"
+       R"("identity":{"did":"did:plc:abc","handle":"someone.bsky.social"}})"});
+  for (auto const &frame : frames) {
+    nlohmann::json full_json(nlohmann::json::parse(frame));
+    candidate_list expected(parser().get_candidates_from_json(full_json));
+    ASSERT_FALSE(expected.empty());
+    EXPECT_THAT(
+        parser::get_candidates_from_jetstream(frame.c_str(), frame.length()),
+        ::testing::ContainerEq(expected));
+  }
+  // record fields are in JSON form, handles are not
+  std::string const &post(frames.front());
+  candidate_list from_post(
+      parser::get_candidates_from_jetstream(post.c_str(), post.length()));
+  ASSERT_FALSE(from_post.empty());
+  EXPECT_EQ(from_post.front()._value,
+            "\"say \\\"caf\xC3\xA9\\\"\\nnow \\\\ \xF0\x9F\x98\x80\"");
+  std::string const &identity(frames.back());
+  candidate_list from_identity(parser::get_candidates_from_jetstream(
+      identity.c_str(), identity.length()));
+  ASSERT_EQ(from_identity.size(), 1u);
+  EXPECT_EQ(from_identity.front()._value, "someone.bsky.social");
+}
@@ -0,0 +1,116 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "partition.hpp"
+
+namespace {
+const bsky::time_stamp created(std::chrono::milliseconds(1767225600123));
+const std::string Actor("did:plc:actor");
+const std::string Post("at://did:plc:target/app.bsky.feed.post/3lbrev1");
+const std::string Reply("at://did:plc:other/app.bsky.feed.post/3lbrev2");
+
+activity::timed_event round_trip(activity::event &&event, bool &decoded,
+                                 const bool low_history = false) {
+  const std::string encoded(partition::encode_interaction(
+      activity::timed_event(Actor, created, std::move(event)), low_history));
+  activity::timed_event result;
+  decoded = partition::decode_interaction(encoded, result);
+  return result;
+}
+} // namespace
+
+TEST(PartitionTest, OwnerInRange) {
+  std::vector<size_t> owned(4);
+  for (size_t account = 0; account < 10000; ++account) {
+    const uint32_t owner(
+        partition::owner_of("did:plc:" + std::to_string(account), 4));
+    ASSERT_LT(owner, 4u);
+    ++owned[owner];
+  }
+  for (auto const count : owned) {
+    EXPECT_GT(count, 2000u);
+  }
+  EXPECT_EQ(partition::owner_of("did:plc:abc", 1), 0u);
+}
+
+TEST(PartitionTest, StableAcrossCalls) {
+  EXPECT_EQ(partition::owner_of("did:plc:abc", 8),
+            partition::owner_of(std::string("did:plc:abc"), 8));
+  EXPECT_NE(partition::did_hash("did:plc:abc"),
+            partition::did_hash("did:plc:abd"));
+}
+
+TEST(PartitionTest, GrowingOnlyMovesToNewWorker) {
+  for (size_t account = 0; account < 10000; ++account) {
+    std::string const did("did:plc:" + std::to_string(account));
+    const uint32_t before(partition::owner_of(did, 4));
+    const uint32_t after(partition::owner_of(did, 5));
+    if (before != after) {
+      EXPECT_EQ(after, 4u) << did;
+    }
+  }
+}
+
+TEST(PartitionTest, InteractionsRoundTrip) {
+  std::vector<activity::event> interactions(
+      {activity::reply{"app.bsky.feed.post/3lbrev3", atproto::at_uri(Post),
+                       atproto::at_uri(Reply)},
+       activity::repost{"app.bsky.feed.repost/3lbrev4", atproto::at_uri(Post)},
+       activity::quote{"app.bsky.feed.post/3lbrev5", atproto::at_uri(Post)},
+       activity::follow{"app.bsky.graph.follow/3lbrev6", "did:plc:target"},
+       activity::block{"app.bsky.graph.block/3lbrev7", "did:plc:target"},
+       activity::like{"app.bsky.feed.like/3lbrev8", atproto::at_uri(Post)},
+       activity::deleted{"app.bsky.feed.like/3lbrev8", Post},
+       activity::target_alert()});
+  std::set<size_t> covered;
+  for (auto const &interaction : interactions) {
+    bool decoded(false);
+    const activity::timed_event result(
+        round_trip(activity::event(interaction), decoded));
+    ASSERT_TRUE(decoded) << interaction.index();
+    EXPECT_EQ(result._event.index(), interaction.index());
+    EXPECT_EQ(result._did, Actor);
+    EXPECT_EQ(result._created_at, created);
+    EXPECT_TRUE(result._forwarded);
+    EXPECT_FALSE(result._low_history);
+    EXPECT_EQ(partition::targets_of(result._event),
+              partition::targets_of(interaction));
+    covered.insert(interaction.index());
+  }
+
+  bool decoded(false);
+  auto const reply(std::get<activity::reply>(
+      round_trip(activity::event(interactions[0]), decoded)._event));
+  EXPECT_EQ(reply._reply, "app.bsky.feed.post/3lbrev3");
+  EXPECT_EQ(std::string(reply._root), Post);
+  EXPECT_EQ(std::string(reply._parent), Reply);
+  auto const follow(std::get<activity::follow>(
+      round_trip(activity::event(interactions[3]), decoded)._event));
+  EXPECT_EQ(follow._follow, "app.bsky.graph.follow/3lbrev6");
+  EXPECT_EQ(follow._followed, "did:plc:target");
+  auto const deleted(std::get<activity::deleted>(
+      round_trip(activity::event(interactions[6]), decoded)._event));
+  EXPECT_EQ(deleted._path, "app.bsky.feed.like/3lbrev8");
+  EXPECT_EQ(deleted._subject, Post);
+  // the actor's history is judged by its own partition
+  EXPECT_TRUE(
+      round_trip(activity::event(interactions[0]), decoded, true)._low_history);
+
+  // the actor's own events are never forwarded
+  std::vector<activity::event> others(
+      {activity::post{"app.bsky.feed.post/3lbrev9"}, activity::active(),
+       activity::inactive{bsky::down_reason::deactivated},
+       activity::handle{"actor.bsky.social"},
+       activity::profile{"app.bsky.actor.profile/self"},
+       activity::matches{1}, activity::facets{1, 2, 3},
+       activity::near_duplicate{5}, activity::coordinated{3}});
+  for (auto const &other : others) {
+    round_trip(activity::event(other), decoded);
+    EXPECT_FALSE(decoded) << other.index();
+    covered.insert(other.index());
+  }
+  EXPECT_EQ(covered.size(), std::variant_size_v<activity::event>);
+}
@@ -0,0 +1,151 @@
+#include <chrono>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <string>
+
+#include "common/activity/pile_on.hpp"
+#include "testdefs.hpp"
+
+using activity::hyperloglog;
+using activity::pile_on_detector;
+using activity::pile_on_tracker;
+using namespace std::chrono;
+
+namespace {
+constexpr uint64_t Target = 42;
+
+uint64_t hashed(const size_t value) {
+  return pile_on_tracker::mix(std::hash<std::string>()(
+      "did:plc:account" + std::to_string(value)));
+}
+} // namespace
+
+TEST(PileOnTest, HyperLogLogEstimate) {
+  for (const size_t count : {10, 100, 1000, 10000}) {
+    hyperloglog distinct;
+    for (size_t item = 0; item < count; ++item) {
+      // repeats do not count
+      distinct.add(hashed(item));
+      distinct.add(hashed(item));
+    }
+    EXPECT_NEAR(distinct.estimate(), static_cast<double>(count),
+                static_cast<double>(count) * 0.4)
+        << count;
+  }
+  hyperloglog lhs, rhs;
+  for (size_t item = 0; item < 500; ++item) {
+    lhs.add(hashed(item));
+    rhs.add(hashed(item + 250));
+  }
+  lhs.merge(rhs);
+  EXPECT_NEAR(lhs.estimate(), 750.0, 300.0);
+}
+
+TEST(PileOnTest, AlertsOncePerWindow) {
+  pile_on_tracker tracker(milliseconds(60000), 16, 50, 30, 0.5);
+  size_t alerts(0);
+  // 60 new accounts reply in a minute
+  for (size_t actor = 0; actor < 60; ++actor) {
+    auto result(tracker.observe(Target, actor, true,
+                                TestStart + milliseconds(actor * 500)));
+    alerts += result._alert ? 1 : 0;
+    if (actor == 48) {
+      EXPECT_FALSE(result._alert);
+    }
+  }
+  EXPECT_EQ(alerts, 1u);
+  // still going after the window, alerts again
+  for (size_t actor = 60; actor < 120; ++actor) {
+    alerts += tracker
+                  .observe(Target, actor, true,
+                           TestStart + seconds(90) + milliseconds(actor * 100))
+                  ._alert
+                  ? 1
+                  : 0;
+  }
+  EXPECT_EQ(alerts, 2u);
+}
+
+TEST(PileOnTest, NoAlertWithoutAllSignals) {
+  // busy thread among established accounts
+  pile_on_tracker established(milliseconds(60000), 16, 50, 30, 0.5);
+  // one account replying over and over
+  pile_on_tracker repeated(milliseconds(60000), 16, 50, 30, 0.5);
+  // slow trickle of new accounts
+  pile_on_tracker slow(milliseconds(60000), 16, 50, 30, 0.5);
+  for (size_t actor = 0; actor < 200; ++actor) {
+    EXPECT_FALSE(established
+                     .observe(Target, actor, actor % 4 == 0,
+                              TestStart + milliseconds(actor * 100))
+                     ._alert);
+    EXPECT_FALSE(
+        repeated.observe(Target, 7, true, TestStart + milliseconds(actor * 100))
+            ._alert);
+    EXPECT_FALSE(
+        slow.observe(Target, actor, true, TestStart + seconds(actor * 10))
+            ._alert);
+  }
+}
+
+TEST(PileOnTest, FixedTable) {
+  pile_on_tracker tracker(milliseconds(60000), 16, 50, 30, 0.5);
+  EXPECT_EQ(tracker.slots(), 16u);
+  for (uint64_t target = 0; target < 1000; ++target) {
+    tracker.observe(target, 1, true, TestStart);
+  }
+  EXPECT_EQ(tracker.slots(), 16u);
+  EXPECT_GE(tracker.evicted(), 1000u - 16);
+  // a busy target survives a stream of one-off targets
+  size_t alerts(0);
+  for (size_t actor = 0; actor < 100; ++actor) {
+    alerts +=
+        tracker.observe(Target, actor, true, TestStart + seconds(1))._alert ? 1
+                                                                           : 0;
+    tracker.observe(100000 + actor, 1, true, TestStart + seconds(1));
+  }
+  EXPECT_EQ(alerts, 1u);
+}
+
+TEST(PileOnTest, LowHistoryAfterWarmUp) {
+  auto &detector(pile_on_detector::instance());
+  YAML::Node settings;
+  settings["low_history_events"] = 5;
+  settings["warm_up_ms"] = 3600000;
+  detector.set_config(settings);
+  // every account looks new to a process that has just started
+  EXPECT_FALSE(detector.low_history(0, TestStart));
+  EXPECT_FALSE(detector.low_history(0, TestStart + minutes(59)));
+  // warm-up is timed by the events, however fast they are processed
+  EXPECT_TRUE(detector.low_history(4, TestStart + hours(1)));
+  EXPECT_FALSE(detector.low_history(5, TestStart + hours(1)));
+}
+
+TEST(PileOnTest, WindowOnEventTime) {
+  auto &detector(pile_on_detector::instance());
+  YAML::Node settings;
+  settings["window_ms"] = 60000;
+  settings["min_rate"] = 50;
+  settings["min_distinct"] = 30;
+  settings["warm_up_ms"] = 0;
+  detector.set_config(settings);
+  const atproto::at_uri slow_post(
+      "at://did:plc:author/app.bsky.feed.post/3lbrevwbpe22k");
+  const atproto::at_uri busy_post(
+      "at://did:plc:author/app.bsky.feed.post/3lbrevwbpe33k");
+  size_t slow_alerts(0);
+  size_t busy_alerts(0);
+  // a replayed backlog: handled at once, but spread over an hour
+  for (size_t actor = 0; actor < 120; ++actor) {
+    std::string const did("did:plc:account" + std::to_string(actor));
+    slow_alerts += detector.reply(slow_post, did, true,
+                                  TestStart + seconds(actor * 30))
+                       ? 1
+                       : 0;
+    busy_alerts += detector.reply(busy_post, did, true,
+                                  TestStart + milliseconds(actor * 100))
+                       ? 1
+                       : 0;
+  }
+  EXPECT_EQ(slow_alerts, 0u);
+  EXPECT_EQ(busy_alerts, 1u);
+}
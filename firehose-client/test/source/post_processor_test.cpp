@@ -0,0 +1,88 @@
+#include <chrono>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <memory>
+#include <semaphore>
+#include <string>
+#include <thread>
+
+#include "common/controller.hpp"
+#include "post_processor.hpp"
+#include "testdefs.hpp"
+
+namespace {
+// holds up the post-processor until the test lets it through
+class gated_payload {
+public:
+  gated_payload() = default;
+  explicit gated_payload(std::counting_semaphore<> &gate) : _gate(&gate) {}
+  void handle(post_processor<gated_payload> &) {
+    if (_gate)
+      _gate->acquire();
+  }
+  inline pipeline::ingest_time ingested() const { return {}; }
+  inline std::string to_string() const { return {}; }
+
+private:
+  std::counting_semaphore<> *_gate = nullptr;
+};
+
+typedef post_processor<gated_payload> gated_processor;
+
+bool drains_to(gated_processor const &processor, const size_t backlog) {
+  auto const deadline(std::chrono::steady_clock::now() +
+                      std::chrono::seconds(10));
+  while (std::chrono::steady_clock::now() < deadline) {
+    if (processor.backlog() <= backlog)
+      return true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return false;
+}
+
+class PostProcessorTest : public ::testing::Test {
+protected:
+  static void SetUpTestSuite() { add_process_metrics(); }
+  void SetUp() override { controller::instance().start(); }
+};
+} // namespace
+
+TEST_F(PostProcessorTest, WatermarksBelowLimit) {
+  EXPECT_LT(gated_processor::HighWatermark, gated_processor::QueueLimit);
+  EXPECT_LT(gated_processor::LowWatermark, gated_processor::HighWatermark);
+}
+
+// Reads pause once the queue fills to the high watermark, and stay paused
+// until it drains to the low watermark
+TEST_F(PostProcessorTest, ReadsPauseUntilDrained) {
+  std::counting_semaphore<> gate(0);
+  {
+    gated_processor processor;
+    // nothing is left held when the processor stops, even on failure
+    std::shared_ptr<void> open_gate(nullptr, [&gate](void *) {
+      gate.release(static_cast<std::ptrdiff_t>(gated_processor::QueueLimit));
+    });
+    // the first is taken off the queue and held
+    processor.wait_enqueue(gated_payload(gate));
+    ASSERT_TRUE(drains_to(processor, 0));
+    size_t queued(1);
+    while (!processor.saturated() && queued <= gated_processor::QueueLimit) {
+      processor.wait_enqueue(gated_payload(gate));
+      ++queued;
+    }
+    ASSERT_TRUE(processor.saturated());
+    EXPECT_EQ(queued, gated_processor::HighWatermark + 1);
+
+    // draining, but still above the low watermark
+    const size_t partial(
+        (gated_processor::HighWatermark - gated_processor::LowWatermark) / 2);
+    gate.release(static_cast<std::ptrdiff_t>(partial));
+    ASSERT_TRUE(
+        drains_to(processor, gated_processor::HighWatermark - partial));
+    EXPECT_TRUE(processor.saturated());
+
+    gate.release(static_cast<std::ptrdiff_t>(queued - partial - 1));
+    ASSERT_TRUE(drains_to(processor, gated_processor::LowWatermark));
+    EXPECT_FALSE(processor.saturated());
+  }
+}
@@ -0,0 +1,114 @@
+#include <chrono>
+#include <filesystem>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <string>
+
+#include "frame_corpus.hpp"
+#include "nlohmann/json.hpp"
+#include "rule_simulator.hpp"
+#include "testdefs.hpp"
+
+namespace {
+const std::string Poster("did:plc:poster");
+const std::string Other("did:plc:other");
+
+std::string post_frame(std::string const &did, const size_t index,
+                       std::string const &text) {
+  nlohmann::json frame;
+  frame["did"] = did;
+  frame["time_us"] =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          (TestStart + std::chrono::seconds(index)).time_since_epoch())
+          .count();
+  frame["kind"] = "commit";
+  frame["commit"]["operation"] = "create";
+  frame["commit"]["collection"] = "app.bsky.feed.post";
+  frame["commit"]["rkey"] = "3lbrevx" + std::to_string(100000 + index);
+  frame["commit"]["cid"] = "cid" + std::to_string(index);
+  frame["commit"]["record"]["$type"] = "app.bsky.feed.post";
+  frame["commit"]["record"]["text"] = text;
+  return frame.dump();
+}
+
+std::string rules_file(std::string const &name) {
+  return std::string(DataPath) + name;
+}
+
+// Jetstream capture spanning two tasks. "alpha" is only in the current
+// rules, "beta" only in the candidate, "shared" in both.
+corpus::frames capture() {
+  const std::filesystem::path filename(
+      std::filesystem::temp_directory_path() / "rule_sim_test.frames");
+  std::filesystem::remove(filename);
+  {
+    corpus::frame_writer writer(filename.string());
+    for (size_t index = 0; index < rule_sim::FramesPerTask + 88; ++index) {
+      std::string text("nothing to see");
+      if (index % 200 == 7) {
+        text = "alpha here";
+      } else if (index < 4 || (index >= rule_sim::FramesPerTask &&
+                               index < rule_sim::FramesPerTask + 4)) {
+        text = "beta here";
+      } else if (index % 100 == 50) {
+        text = "shared here";
+      }
+      writer.append(
+          post_frame(index < rule_sim::FramesPerTask ? Poster : Other, index,
+                     text));
+    }
+    writer.append(std::string("not a frame"));
+  }
+  corpus::frames frames(corpus::load_frames(filename.string()));
+  std::filesystem::remove(filename);
+  return frames;
+}
+} // namespace
+
+TEST(RuleSimTest, AddedAndRemovedMatches) {
+  corpus::frames frames(capture());
+  work_stealing_pool pool(2);
+  rule_sim::simulator sim(rules_file("rule_sim_current"),
+                          rules_file("rule_sim_candidate"), false, pool);
+  sim.run(frames);
+  rule_sim::sim_results const &results(sim.results());
+
+  EXPECT_EQ(results._frames, rule_sim::FramesPerTask + 89);
+  EXPECT_EQ(results._failed, 1u);
+  ASSERT_TRUE(results._first && results._last);
+  EXPECT_LT(*results._first, *results._last);
+
+  EXPECT_THAT(results._removed, ::testing::SizeIs(1));
+  ASSERT_TRUE(results._removed.contains("alpha"));
+  EXPECT_EQ(results._removed.at("alpha")._hits, 3u);
+  EXPECT_EQ(results._current.at("alpha")._hits, 3u);
+
+  EXPECT_THAT(results._added, ::testing::SizeIs(1));
+  ASSERT_TRUE(results._added.contains("beta"));
+  rule_sim::rule_tally const &added(results._added.at("beta"));
+  EXPECT_EQ(added._hits, 8u);
+  EXPECT_THAT(added._accounts, ::testing::ElementsAre(Other, Poster));
+  // samples from both tasks, capped when merged
+  EXPECT_EQ(added._samples.size(), rule_sim::SamplesPerRule);
+  EXPECT_THAT(added._samples, ::testing::Each(::testing::HasSubstr("beta")));
+
+  // matched either way, neither added nor removed
+  EXPECT_EQ(results._current.at("shared")._hits, 6u);
+  EXPECT_EQ(results._candidate.at("shared")._hits, 6u);
+  EXPECT_FALSE(results._candidate.contains("alpha"));
+}
+
+TEST(RuleSimTest, SamplesCappedPerRule) {
+  rule_sim::rule_tally tally;
+  rule_sim::rule_tally other;
+  for (size_t index = 0; index < rule_sim::SamplesPerRule + 2; ++index) {
+    tally.add(Poster, "mine " + std::to_string(index));
+    other.add(Other, "theirs " + std::to_string(index));
+  }
+  EXPECT_EQ(tally._samples.size(), rule_sim::SamplesPerRule);
+  tally.merge(other);
+  EXPECT_EQ(tally._hits, 2 * (rule_sim::SamplesPerRule + 2));
+  EXPECT_EQ(tally._accounts.size(), 2u);
+  EXPECT_THAT(tally._samples, ::testing::SizeIs(rule_sim::SamplesPerRule));
+  EXPECT_THAT(tally._samples, ::testing::Each(::testing::StartsWith("mine")));
+}
@@ -0,0 +1,131 @@
+#include <chrono>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <string>
+
+#include "subject_index.hpp"
+#include "testdefs.hpp"
+
+using firehose::packed_tid;
+using firehose::subject_index;
+using namespace std::chrono;
+
+namespace {
+// base32-sortable rkey for a record created at the given time
+std::string tid_for(const bsky::time_stamp when, const uint64_t clock = 7) {
+  constexpr std::string_view Alphabet = "234567abcdefghijklmnopqrstuvwxyz";
+  uint64_t value((static_cast<uint64_t>(
+                      duration_cast<microseconds>(when.time_since_epoch())
+                          .count())
+                  << 10) |
+                 clock);
+  std::string result(13, '2');
+  for (size_t index = 13; index > 0; --index) {
+    result[index - 1] = Alphabet[value & 0x1f];
+    value >>= 5;
+  }
+  return result;
+}
+std::string follow(const bsky::time_stamp when, const uint64_t clock = 7) {
+  return "app.bsky.graph.follow/" + tid_for(when, clock);
+}
+} // namespace
+
+TEST(SubjectIndexTest, PackedTid) {
+  // https://atproto.com/specs/tid examples
+  EXPECT_TRUE(packed_tid("3jzfcijpj2z2a").has_value());
+  EXPECT_TRUE(packed_tid("7777777777777").has_value());
+  EXPECT_TRUE(packed_tid("3zzzzzzzzzzzz").has_value());
+  EXPECT_FALSE(packed_tid("3jzfcijpj2z21").has_value());
+  EXPECT_FALSE(packed_tid("3jzfcijpj2z2").has_value());
+  EXPECT_FALSE(packed_tid("zzzzzzzzzzzzz").has_value());
+  EXPECT_FALSE(packed_tid("self").has_value());
+  // microseconds above the 10-bit clock id
+  const bsky::time_stamp when(TestStart + milliseconds(1234));
+  auto tid(packed_tid(tid_for(when)));
+  ASSERT_TRUE(tid.has_value());
+  EXPECT_EQ(microseconds(*tid >> 10),
+            duration_cast<microseconds>(when.time_since_epoch()));
+  EXPECT_EQ(*tid & 0x3ff, 7u);
+}
+
+TEST(SubjectIndexTest, DeleteFindsSubject) {
+  subject_index index(1024, hours(24));
+  const std::string path(follow(TestStart));
+  const std::string like("app.bsky.feed.like/" + tid_for(TestStart));
+  EXPECT_TRUE(index.insert("did:plc:one", path, "did:plc:two", TestStart));
+  EXPECT_TRUE(index.insert("did:plc:one", like,
+                           "at://did:plc:two/app.bsky.feed.post/abc",
+                           TestStart));
+  // same rkey in another repo or collection is another record
+  EXPECT_TRUE(index.insert("did:plc:three", path, "did:plc:four", TestStart));
+  EXPECT_FALSE(
+      index.insert("did:plc:one", "app.bsky.feed.post/" + tid_for(TestStart),
+                   "text", TestStart));
+  EXPECT_FALSE(index.insert("did:plc:one", "app.bsky.graph.follow/self",
+                            "did:plc:two", TestStart));
+  EXPECT_EQ(index.entries(), 3u);
+
+  auto found(index.take("did:plc:one", path, TestStart + minutes(5)));
+  ASSERT_TRUE(found.has_value());
+  EXPECT_EQ(found->_subject, "did:plc:two");
+  EXPECT_EQ(found->_created, TestStart);
+  // taken once only
+  EXPECT_FALSE(index.take("did:plc:one", path, TestStart + minutes(5)));
+  found = index.take("did:plc:three", path, TestStart + minutes(5));
+  ASSERT_TRUE(found.has_value());
+  EXPECT_EQ(found->_subject, "did:plc:four");
+  EXPECT_EQ(index.entries(), 1u);
+  EXPECT_EQ(index.subjects(), 1u);
+}
+
+TEST(SubjectIndexTest, SubjectsShared) {
+  subject_index index(4096, hours(24));
+  for (uint64_t clock = 0; clock < 1000; ++clock) {
+    index.insert("did:plc:account" + std::to_string(clock),
+                 follow(TestStart, clock), "did:plc:popular", TestStart);
+  }
+  EXPECT_EQ(index.subjects(), 1u);
+  for (uint64_t clock = 0; clock < 1000; ++clock) {
+    index.take("did:plc:account" + std::to_string(clock),
+               follow(TestStart, clock), TestStart);
+  }
+  EXPECT_EQ(index.entries(), 0u);
+  EXPECT_EQ(index.subjects(), 0u);
+}
+
+TEST(SubjectIndexTest, BoundedByCapacityAndRetention) {
+  subject_index index(1024, hours(1));
+  EXPECT_EQ(index.capacity(), 1024u);
+  for (size_t record = 0; record < 5000; ++record) {
+    const bsky::time_stamp when(TestStart + milliseconds(record));
+    index.insert("did:plc:one", follow(when),
+                 "did:plc:target" + std::to_string(record), when);
+  }
+  EXPECT_LE(index.entries(), 1024u);
+  EXPECT_LE(index.subjects(), 1024u);
+  EXPECT_GE(index.overwritten(), 5000u - 1024);
+  // the newest record survives, the oldest was overwritten
+  EXPECT_TRUE(index.take("did:plc:one", follow(TestStart + milliseconds(4999)),
+                         TestStart + seconds(5)));
+  EXPECT_FALSE(
+      index.take("did:plc:one", follow(TestStart), TestStart + seconds(5)));
+  // past retention a record is not returned
+  subject_index aged(1024, hours(1));
+  aged.insert("did:plc:one", follow(TestStart), "did:plc:two", TestStart);
+  EXPECT_FALSE(
+      aged.take("did:plc:one", follow(TestStart), TestStart + hours(2)));
+  EXPECT_EQ(aged.entries(), 0u);
+}
+
+TEST(SubjectIndexTest, AgedFromWhenSeen) {
+  subject_index index(1024, hours(1));
+  // the client picks the rkey, its time says nothing about the record
+  const std::string future(follow(TestStart + days(365)));
+  index.insert("did:plc:one", future, "did:plc:two", TestStart);
+  auto found(index.take("did:plc:one", future, TestStart + minutes(5)));
+  ASSERT_TRUE(found.has_value());
+  EXPECT_EQ(found->_created, TestStart);
+  index.insert("did:plc:one", future, "did:plc:two", TestStart);
+  EXPECT_FALSE(index.take("did:plc:one", future, TestStart + hours(2)));
+}
@@ -0,0 +1,62 @@
+#include <chrono>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "common/bluesky/platform.hpp"
+
+using namespace std::chrono;
+
+namespace {
+bsky::time_stamp expected(int y, unsigned m, unsigned d, int h, int min, int s,
+                          int ms) {
+  return sys_days(year(y) / month(m) / day(d)) + hours(h) + minutes(min) +
+         seconds(s) + milliseconds(ms);
+}
+} // namespace
+
+TEST(TimeStampTest, FirehoseFormats) {
+  EXPECT_EQ(bsky::time_stamp_from_rfc_3339("2025-01-31T23:59:58.123Z"),
+            expected(2025, 1, 31, 23, 59, 58, 123));
+  EXPECT_EQ(bsky::time_stamp_from_rfc_3339("2025-01-31T23:59:58Z"),
+            expected(2025, 1, 31, 23, 59, 58, 0));
+  // fraction beyond millisecond precision is truncated
+  EXPECT_EQ(bsky::time_stamp_from_rfc_3339("2024-02-29T00:00:00.987654321Z"),
+            expected(2024, 2, 29, 0, 0, 0, 987));
+  EXPECT_EQ(bsky::time_stamp_from_rfc_3339("2024-02-29T00:00:00.5Z"),
+            expected(2024, 2, 29, 0, 0, 0, 500));
+  EXPECT_EQ(bsky::time_stamp_from_rfc_3339("2025-06-01T12:00:00.000+00:00"),
+            expected(2025, 6, 1, 12, 0, 0, 0));
+  EXPECT_EQ(bsky::time_stamp_from_rfc_3339("2025-06-01T12:00:00.000-03:30"),
+            expected(2025, 6, 1, 15, 30, 0, 0));
+  EXPECT_EQ(bsky::time_stamp_from_rfc_3339("2025-06-01T01:00:00+02:00"),
+            expected(2025, 5, 31, 23, 0, 0, 0));
+}
+
+TEST(TimeStampTest, Rejected) {
+  EXPECT_FALSE(bsky::time_stamp_from_rfc_3339("").has_value());
+  EXPECT_FALSE(bsky::time_stamp_from_rfc_3339("2025-01-31").has_value());
+  EXPECT_FALSE(
+      bsky::time_stamp_from_rfc_3339("2025-01-31T23:59:58").has_value());
+  EXPECT_FALSE(
+      bsky::time_stamp_from_rfc_3339("2025-02-30T00:00:00Z").has_value());
+  EXPECT_FALSE(
+      bsky::time_stamp_from_rfc_3339("2025-01-31T24:00:00Z").has_value());
+  EXPECT_FALSE(
+      bsky::time_stamp_from_rfc_3339("2025-01-31T23:59:60Z").has_value());
+  EXPECT_FALSE(
+      bsky::time_stamp_from_rfc_3339("2025-01-31T23:59:58.Z").has_value());
+  EXPECT_FALSE(
+      bsky::time_stamp_from_rfc_3339("2025-01-31T23:59:58-0300").has_value());
+  EXPECT_FALSE(
+      bsky::time_stamp_from_rfc_3339("2025-1-31T23:59:58Z").has_value());
+}
+
+TEST(TimeStampTest, FallbackAgrees) {
+  for (auto const &value :
+       {"2025-01-31T23:59:58.123Z", "2023-11-07T04:05:06Z",
+        "2025-06-01T12:00:00.000+00:00", "2025-06-01T12:00:00.000-03:00"}) {
+    EXPECT_EQ(bsky::time_stamp_from_iso_8601(value),
+              bsky::time_stamp_from_iso_8601_permissive(value))
+        << value;
+  }
+}
@@ -0,0 +1,90 @@
+#include <filesystem>
+#include <fstream>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "collection_plan.hpp"
+#include "common/bluesky/platform.hpp"
+#include "datasource.hpp"
+#include "matcher.hpp"
+
+namespace {
+const std::string ProfileRule("swastika|abusive|track=true,scope=profile|");
+const std::string AnyRule("Holohoax|abusive|track=true,match=substring|");
+
+void write_rules(std::filesystem::path const &filename,
+                 std::vector<std::string> const &rules) {
+  std::ofstream file(filename, std::ios::trunc);
+  file << "## target,labels,actions,contingent\n";
+  for (auto const &rule : rules) {
+    file << rule << '\n';
+  }
+}
+} // namespace
+
+TEST(WantedCollectionsTest, FollowsRuleScope) {
+  matcher rules;
+  EXPECT_TRUE(rules.wanted_collections().empty());
+
+  rules.add_rule(ProfileRule);
+  EXPECT_THAT(rules.wanted_collections(),
+              ::testing::ElementsAre(std::string(bsky::AppBskyActorProfile)));
+
+  rules.add_rule(AnyRule);
+  EXPECT_THAT(rules.wanted_collections(),
+              ::testing::ElementsAre(std::string(bsky::AppBskyActorProfile),
+                                     std::string(bsky::AppBskyFeedPost)));
+}
+
+TEST(WantedCollectionsTest, SkippedCollectionsDropped) {
+  matcher rules;
+  rules.add_rule(AnyRule);
+  YAML::Node settings;
+  settings["collections"][std::string(bsky::AppBskyFeedPost)] = "skip";
+  firehose::collection_plan::instance().set_config(settings);
+  EXPECT_THAT(rules.wanted_collections(),
+              ::testing::ElementsAre(std::string(bsky::AppBskyActorProfile)));
+
+  settings["collections"][std::string(bsky::AppBskyFeedPost)] = "full";
+  firehose::collection_plan::instance().set_config(settings);
+}
+
+TEST(WantedCollectionsTest, ReloadOnFileChange) {
+  const std::filesystem::path filename(
+      std::filesystem::temp_directory_path() / "wanted_collections_rules");
+  write_rules(filename, {ProfileRule});
+  matcher rules;
+  YAML::Node settings;
+  settings["filename"] = filename.string();
+  rules.set_config(settings);
+  const uint64_t loaded(rules.generation());
+  EXPECT_THAT(rules.wanted_collections(),
+              ::testing::ElementsAre(std::string(bsky::AppBskyActorProfile)));
+  EXPECT_FALSE(rules.reload_if_changed());
+
+  write_rules(filename, {ProfileRule, AnyRule});
+  // file times can be coarse, make sure the change is visible
+  std::filesystem::last_write_time(
+      filename,
+      std::filesystem::last_write_time(filename) + std::chrono::seconds(2));
+  EXPECT_TRUE(rules.reload_if_changed());
+  EXPECT_GT(rules.generation(), loaded);
+  EXPECT_THAT(rules.wanted_collections(),
+              ::testing::ElementsAre(std::string(bsky::AppBskyActorProfile),
+                                     std::string(bsky::AppBskyFeedPost)));
+  EXPECT_FALSE(rules.reload_if_changed());
+  std::filesystem::remove(filename);
+}
+
+TEST(WantedCollectionsTest, OptionsUpdateMessage) {
+  nlohmann::json update(nlohmann::json::parse(jetstream_options_update(
+      {std::string(bsky::AppBskyActorProfile),
+       std::string(bsky::AppBskyFeedPost)})));
+  EXPECT_EQ(update["type"], "options_update");
+  EXPECT_EQ(update["payload"]["wantedCollections"],
+            nlohmann::json::array({bsky::AppBskyActorProfile,
+                                   bsky::AppBskyFeedPost}));
+  // empty DID filter means all DIDs, zero size means no limit
+  EXPECT_TRUE(update["payload"]["wantedDids"].empty());
+  EXPECT_EQ(update["payload"]["maxMessageSizeBytes"], 0);
+}
@@ -0,0 +1,59 @@
+#include <atomic>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+#include "work_stealing_pool.hpp"
+
+namespace {
+// splits a range in half until small, the way car_scanner splits records
+void sum_range(work_stealing_pool &pool, std::atomic<uint64_t> &total,
+               const uint64_t first, const uint64_t last) {
+  if (last - first <= 16) {
+    for (uint64_t value = first; value < last; ++value) {
+      total.fetch_add(value, std::memory_order_relaxed);
+    }
+    return;
+  }
+  const uint64_t middle(first + (last - first) / 2);
+  pool.submit([&pool, &total, first, middle]() {
+    sum_range(pool, total, first, middle);
+  });
+  sum_range(pool, total, middle, last);
+}
+} // namespace
+
+TEST(WorkStealingPoolTest, RunsEverything) {
+  work_stealing_pool pool(4);
+  std::atomic<size_t> count(0);
+  for (size_t task = 0; task < 1000; ++task) {
+    pool.submit([&count]() { count.fetch_add(1); });
+  }
+  pool.wait();
+  EXPECT_EQ(count.load(), 1000u);
+}
+
+TEST(WorkStealingPoolTest, NestedSubmitsAreAwaited) {
+  work_stealing_pool pool(4);
+  std::atomic<uint64_t> total(0);
+  pool.submit([&pool, &total]() { sum_range(pool, total, 0, 100000); });
+  pool.wait();
+  EXPECT_EQ(total.load(), 100000ull * 99999ull / 2);
+  // reusable after wait
+  pool.submit([&pool, &total]() { sum_range(pool, total, 0, 10); });
+  pool.wait();
+  EXPECT_EQ(total.load(), 100000ull * 99999ull / 2 + 45);
+}
+
+TEST(WorkStealingPoolTest, FailureRethrownOnWait) {
+  work_stealing_pool pool(2);
+  std::atomic<size_t> count(0);
+  pool.submit([]() { throw std::runtime_error("bad repo"); });
+  for (size_t task = 0; task < 10; ++task) {
+    pool.submit([&count]() { count.fetch_add(1); });
+  }
+  EXPECT_THROW(pool.wait(), std::runtime_error);
+  EXPECT_EQ(count.load(), 10u);
+  // failure is reported once
+  pool.wait();
+}
@@ -0,0 +1,112 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "zstd_decompressor.hpp"
+
+namespace {
+// Jetstream-like commit, repeated to make a frame larger than one zstd block
+std::string sample_frame(const size_t copies) {
+  std::string frame("[");
+  for (size_t copy = 0; copy < copies; ++copy) {
+    if (copy > 0)
+      frame.push_back(',');
+    frame += R"({"did":"did:plc:abc)" + std::to_string(copy) +
+             R"(","time_us":1767225600000000,"kind":"commit","commit":{)"
+             R"("rev":"3lbrev1","operation":"create",)"
+             R"("collection":"app.bsky.feed.like","rkey":"3lbrev2",)"
+             R"("record":{"$type":"app.bsky.feed.like",)"
+             R"("createdAt":"2026-01-01T00:00:00.000Z"}}})";
+  }
+  frame.push_back(']');
+  return frame;
+}
+
+beast::flat_buffer compress(std::string const &frame,
+                            std::string const &dictionary) {
+  std::string compressed(ZSTD_compressBound(frame.size()), '\0');
+  ZSTD_CCtx *context(ZSTD_createCCtx());
+  const size_t result(
+      dictionary.empty()
+          ? ZSTD_compressCCtx(context, compressed.data(), compressed.size(),
+                              frame.data(), frame.size(), 3)
+          : ZSTD_compress_usingDict(context, compressed.data(),
+                                    compressed.size(), frame.data(),
+                                    frame.size(), dictionary.data(),
+                                    dictionary.size(), 3));
+  ZSTD_freeCCtx(context);
+  EXPECT_FALSE(ZSTD_isError(result));
+  beast::flat_buffer buffer;
+  auto target(buffer.prepare(result));
+  std::memcpy(target.data(), compressed.data(), result);
+  buffer.commit(result);
+  return buffer;
+}
+
+std::string as_string(beast::flat_buffer const &buffer) {
+  return beast::buffers_to_string(buffer.data());
+}
+
+class ZstdDecompressorTest : public ::testing::Test {
+protected:
+  static void SetUpTestSuite() {
+    zstd_decompressor::register_metrics();
+    // raw content dictionary, as good as a trained one for the test
+    _dictionary = sample_frame(4);
+    _dictionary_file =
+        std::filesystem::temp_directory_path() / "zstd_decompressor_test.dict";
+    std::ofstream file(_dictionary_file, std::ios::binary);
+    file << _dictionary;
+  }
+  static void TearDownTestSuite() {
+    std::filesystem::remove(_dictionary_file);
+  }
+
+  static inline std::string _dictionary;
+  static inline std::filesystem::path _dictionary_file;
+};
+} // namespace
+
+TEST_F(ZstdDecompressorTest, RoundTripWithDictionary) {
+  zstd_decompressor decompressor(_dictionary_file.string(), "dictionary");
+  for (size_t copies : {1, 10, 5000}) {
+    const std::string frame(sample_frame(copies));
+    ASSERT_TRUE(decompressor.decompress(compress(frame, _dictionary)));
+    EXPECT_EQ(as_string(decompressor.output()), frame);
+  }
+}
+
+TEST_F(ZstdDecompressorTest, RoundTripWithoutDictionary) {
+  zstd_decompressor decompressor("", "plain");
+  for (size_t copies : {1, 10, 5000}) {
+    const std::string frame(sample_frame(copies));
+    ASSERT_TRUE(decompressor.decompress(compress(frame, "")));
+    EXPECT_EQ(as_string(decompressor.output()), frame);
+  }
+  // frame needs a dictionary this decompressor does not have
+  EXPECT_FALSE(decompressor.decompress(compress(sample_frame(1), _dictionary)));
+}
+
+TEST_F(ZstdDecompressorTest, InvalidFrames) {
+  zstd_decompressor decompressor(_dictionary_file.string(), "invalid");
+  const std::string frame(sample_frame(10));
+  beast::flat_buffer compressed(compress(frame, _dictionary));
+  std::string truncated(as_string(compressed));
+  truncated.resize(truncated.size() / 2);
+  beast::flat_buffer partial;
+  beast::ostream(partial) << truncated;
+  EXPECT_FALSE(decompressor.decompress(partial));
+
+  beast::flat_buffer garbage;
+  beast::ostream(garbage) << frame;
+  EXPECT_FALSE(decompressor.decompress(garbage));
+
+  // context is reset for the next frame
+  ASSERT_TRUE(decompressor.decompress(compressed));
+  EXPECT_EQ(as_string(decompressor.output()), frame);
+
+  EXPECT_THROW(zstd_decompressor("no_such_dictionary.bin", "missing"),
+               std::invalid_argument);
+}
@@ -0,0 +1,115 @@
+#ifndef __frame_synthesizer_hpp__
+#define __frame_synthesizer_hpp__
+/*************************************************************************
+Public Education Forum Moderation Firehose Generator
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+#include "nlohmann/json.hpp"
+#include "yaml-cpp/yaml.h"
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// Builds wire-format subscribeRepos frames - DAG-CBOR header followed by
+// DAG-CBOR message, #commit messages carrying a CAR of the commit and record
+// blocks - from a configurable distribution.
+namespace generator {
+
+typedef std::vector<uint8_t> bytes;
+
+// weighted choice over named alternatives, from a YAML map of name: weight
+class weighted_choice {
+public:
+  weighted_choice() = default;
+  weighted_choice(YAML::Node const &weights,
+                  std::vector<std::pair<std::string, double>> const &defaults);
+
+  template <typename RNG> std::string const &pick(RNG &rng) const {
+    return _names[_distribution(rng)];
+  }
+
+private:
+  std::vector<std::string> _names;
+  mutable std::discrete_distribution<size_t> _distribution;
+};
+
+struct settings {
+  // population of synthetic repos
+  size_t _accounts = 100000;
+  // fraction of post and profile text containing a rule target
+  double _rule_hit_fraction = 0.01;
+  // fraction of commit ops that are deletes
+  double _delete_fraction = 0.05;
+  // per-post feature probabilities
+  double _reply_fraction = 0.3;
+  double _link_facet_fraction = 0.1;
+  double _mention_facet_fraction = 0.1;
+  double _tag_facet_fraction = 0.05;
+  double _external_embed_fraction = 0.1;
+  double _record_embed_fraction = 0.05;
+  double _images_embed_fraction = 0.15;
+  std::vector<std::string> _rule_targets;
+  weighted_choice _message_mix;
+  weighted_choice _collection_mix;
+
+  static settings from_config(YAML::Node const &config);
+};
+
+class frame_synthesizer {
+public:
+  frame_synthesizer(settings const &config, const uint64_t seed);
+
+  // next complete frame, ready to send as a binary websocket message
+  std::string next();
+
+private:
+  bytes commit_message(const int64_t seq, std::string const &time);
+  bytes identity_message(const int64_t seq, std::string const &time);
+  bytes account_message(const int64_t seq, std::string const &time);
+
+  nlohmann::json make_record(std::string const &collection,
+                             std::string const &time);
+  nlohmann::json make_post(std::string const &time);
+  nlohmann::json strong_ref();
+  std::string text(const size_t min_words, const size_t max_words);
+  std::string did();
+  std::string did(const size_t account);
+  std::string tid();
+  bool chance(const double fraction);
+
+  settings const &_config;
+  std::mt19937_64 _rng;
+  uint16_t _clock_id;
+
+  // sequence numbers are unique across all sessions
+  static std::atomic<int64_t> _seq;
+};
+
+// CID v1, dag-cbor codec, sha2-256 multihash
+bytes cid_for_block(bytes const &block);
+// CID as it appears in DAG-CBOR - tag 42, leading multibase zero
+nlohmann::json cid_link(bytes const &cid);
+// CID in display form
+std::string cid_string(bytes const &cid);
+// CARv1 with a single root
+bytes make_car(bytes const &root, std::vector<bytes> const &blocks);
+
+} // namespace generator
+#endif
@@ -0,0 +1,509 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Generator
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "frame_synthesizer.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <openssl/sha.h>
+#include <stdexcept>
+
+namespace generator {
+
+namespace {
+constexpr std::array<const char *, 32> Vocabulary = {
+    "the",      "forum",    "teachers", "school",    "policy",  "union",
+    "board",    "students", "meeting",  "budget",    "vote",    "today",
+    "public",   "district", "class",    "parents",   "reading", "math",
+    "science",  "history",  "library",  "bus",       "lunch",   "grades",
+    "homework", "recess",   "testing",  "principal", "charter", "funding",
+    "classroom", "learning"};
+constexpr std::array<const char *, 5> Languages = {"en", "en", "en", "es",
+                                                   "fr"};
+constexpr std::array<const char *, 4> Domains = {
+    "example.com", "example.org", "news.example.net", "video.example.com"};
+constexpr const char *Base32Sortable = "234567abcdefghijklmnopqrstuvwxyz";
+constexpr const char *Base32Lower = "abcdefghijklmnopqrstuvwxyz234567";
+
+void append_varint(bytes &out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<uint8_t>((value & 0x7F) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+std::string iso_8601_now() {
+  auto now(std::chrono::system_clock::now());
+  std::time_t seconds(std::chrono::system_clock::to_time_t(now));
+  auto millis(std::chrono::duration_cast<std::chrono::milliseconds>(
+                  now.time_since_epoch())
+                  .count() %
+              1000);
+  std::tm utc;
+  gmtime_r(&seconds, &utc);
+  char buffer[32];
+  size_t length(
+      std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &utc));
+  std::snprintf(buffer + length, sizeof(buffer) - length, ".%03dZ",
+                static_cast<int>(millis));
+  return buffer;
+}
+
+std::vector<std::string> load_rule_targets(std::string const &filename) {
+  std::ifstream file(filename);
+  if (!file.is_open())
+    throw std::invalid_argument("Cannot open " + filename);
+  std::vector<std::string> targets;
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.length() < 2 || (line[0] == '#' && line[1] == '#'))
+      continue;
+    std::string target(line.substr(0, line.find('|')));
+    if (!target.empty())
+      targets.emplace_back(std::move(target));
+  }
+  return targets;
+}
+
+// facet byte range covering the first occurrence of a substring
+nlohmann::json facet_index(std::string const &text, std::string const &value) {
+  size_t start(text.find(value));
+  if (start == std::string::npos)
+    start = 0;
+  return {{"byteStart", start},
+          {"byteEnd", std::min(text.length(), start + value.length())}};
+}
+} // namespace
+
+weighted_choice::weighted_choice(
+    YAML::Node const &weights,
+    std::vector<std::pair<std::string, double>> const &defaults) {
+  if (weights) {
+    // a name that is not generated is most likely a typo
+    for (auto const &weight : weights) {
+      const std::string name(weight.first.as<std::string>());
+      if (std::find_if(defaults.cbegin(), defaults.cend(),
+                       [&name](auto const &option) {
+                         return option.first == name;
+                       }) == defaults.cend()) {
+        throw std::invalid_argument("firehose generator cannot generate " +
+                                    name);
+      }
+    }
+  }
+  std::vector<double> values;
+  double total(0.0);
+  for (auto const &option : defaults) {
+    _names.push_back(option.first);
+    // an explicit mix replaces the defaults entirely
+    values.push_back(weights ? weights[option.first].as<double>(0.0)
+                             : option.second);
+    if (values.back() < 0.0) {
+      throw std::invalid_argument("firehose generator weight for " +
+                                  option.first + " is negative");
+    }
+    total += values.back();
+  }
+  if (total <= 0.0) {
+    throw std::invalid_argument(
+        "firehose generator needs a weight > 0 in each mix");
+  }
+  _distribution =
+      std::discrete_distribution<size_t>(values.cbegin(), values.cend());
+}
+
+settings settings::from_config(YAML::Node const &config) {
+  settings result;
+  if (config["accounts"])
+    result._accounts = config["accounts"].as<size_t>();
+  if (config["rule_hit_fraction"])
+    result._rule_hit_fraction = config["rule_hit_fraction"].as<double>();
+  if (config["delete_fraction"])
+    result._delete_fraction = config["delete_fraction"].as<double>();
+  if (config["reply_fraction"])
+    result._reply_fraction = config["reply_fraction"].as<double>();
+  YAML::Node const facets(config["facets"]);
+  if (facets) {
+    result._link_facet_fraction = facets["link"].as<double>(0.0);
+    result._mention_facet_fraction = facets["mention"].as<double>(0.0);
+    result._tag_facet_fraction = facets["tag"].as<double>(0.0);
+  }
+  YAML::Node const embeds(config["embeds"]);
+  if (embeds) {
+    result._external_embed_fraction = embeds["external"].as<double>(0.0);
+    result._record_embed_fraction = embeds["record"].as<double>(0.0);
+    result._images_embed_fraction = embeds["images"].as<double>(0.0);
+  }
+  if (config["rules"]) {
+    result._rule_targets =
+        load_rule_targets(config["rules"].as<std::string>());
+  }
+  if (result._rule_targets.empty()) {
+    result._rule_hit_fraction = 0.0;
+  }
+  if (result._accounts == 0) {
+    throw std::invalid_argument("firehose generator needs accounts > 0");
+  }
+  result._message_mix = weighted_choice(
+      config["mix"], {{"commit", 0.98}, {"identity", 0.01}, {"account", 0.01}});
+  result._collection_mix = weighted_choice(config["collections"],
+                                           {{"app.bsky.feed.like", 0.55},
+                                            {"app.bsky.feed.post", 0.15},
+                                            {"app.bsky.feed.repost", 0.10},
+                                            {"app.bsky.graph.follow", 0.15},
+                                            {"app.bsky.actor.profile", 0.02},
+                                            {"app.bsky.graph.block", 0.03}});
+  return result;
+}
+
+std::atomic<int64_t> frame_synthesizer::_seq(1);
+
+frame_synthesizer::frame_synthesizer(settings const &config,
+                                     const uint64_t seed)
+    : _config(config), _rng(seed),
+      _clock_id(static_cast<uint16_t>(seed & 0x3FF)) {}
+
+std::string frame_synthesizer::next() {
+  const int64_t seq(_seq.fetch_add(1, std::memory_order_relaxed));
+  const std::string time(iso_8601_now());
+  std::string const &kind(_config._message_mix.pick(_rng));
+  bytes message;
+  nlohmann::json header;
+  if (kind == "identity") {
+    header = {{"op", 1}, {"t", "#identity"}};
+    message = identity_message(seq, time);
+  } else if (kind == "account") {
+    header = {{"op", 1}, {"t", "#account"}};
+    message = account_message(seq, time);
+  } else {
+    header = {{"op", 1}, {"t", "#commit"}};
+    message = commit_message(seq, time);
+  }
+  bytes frame(nlohmann::json::to_cbor(header));
+  std::string result;
+  result.reserve(frame.size() + message.size());
+  result.append(frame.cbegin(), frame.cend());
+  result.append(message.cbegin(), message.cend());
+  return result;
+}
+
+bytes frame_synthesizer::commit_message(const int64_t seq,
+                                        std::string const &time) {
+  const std::string repo(did());
+  std::string const &collection(_config._collection_mix.pick(_rng));
+  const std::string rkey(collection == "app.bsky.actor.profile" ? "self"
+                                                                : tid());
+  const std::string rev(tid());
+  const bool is_delete(collection != "app.bsky.actor.profile" &&
+                       chance(_config._delete_fraction));
+
+  nlohmann::json oper = {{"path", collection + '/' + rkey}};
+  std::vector<bytes> blocks;
+  bytes data_cid;
+  if (is_delete) {
+    oper["action"] = "delete";
+    oper["cid"] = nullptr;
+    // MST root is opaque to the client, any valid block will do
+    bytes mst_root(nlohmann::json::to_cbor(
+        {{"e", nlohmann::json::array()}, {"l", nullptr}}));
+    data_cid = cid_for_block(mst_root);
+    blocks.push_back(std::move(mst_root));
+  } else {
+    bytes record(nlohmann::json::to_cbor(make_record(collection, time)));
+    data_cid = cid_for_block(record);
+    oper["action"] = "create";
+    oper["cid"] = cid_link(data_cid);
+    blocks.push_back(std::move(record));
+  }
+
+  nlohmann::json commit = {
+      {"did", repo},
+      {"version", 3},
+      {"data", cid_link(data_cid)},
+      {"rev", rev},
+      {"prev", nullptr},
+      {"sig", nlohmann::json::binary(bytes(64, 0))}};
+  bytes commit_block(nlohmann::json::to_cbor(commit));
+  bytes commit_cid(cid_for_block(commit_block));
+  blocks.insert(blocks.begin(), std::move(commit_block));
+
+  nlohmann::json message = {
+      {"blobs", nlohmann::json::array()},
+      {"blocks", nlohmann::json::binary(make_car(commit_cid, blocks))},
+      {"commit", cid_link(commit_cid)},
+      {"ops", nlohmann::json::array({oper})},
+      {"prev", nullptr},
+      {"rebase", false},
+      {"repo", repo},
+      {"rev", rev},
+      {"seq", seq},
+      {"since", nullptr},
+      {"time", time},
+      {"tooBig", false}};
+  return nlohmann::json::to_cbor(message);
+}
+
+bytes frame_synthesizer::identity_message(const int64_t seq,
+                                          std::string const &time) {
+  std::uniform_int_distribution<size_t> account(0, _config._accounts - 1);
+  const size_t which(account(_rng));
+  nlohmann::json message = {
+      {"did", did(which)},
+      {"handle", "synthetic" + std::to_string(which) + ".bsky.social"},
+      {"seq", seq},
+      {"time", time}};
+  return nlohmann::json::to_cbor(message);
+}
+
+bytes frame_synthesizer::account_message(const int64_t seq,
+                                         std::string const &time) {
+  nlohmann::json message = {
+      {"did", did()}, {"active", chance(0.5)}, {"seq", seq}, {"time", time}};
+  if (!message["active"].template get<bool>()) {
+    message["status"] = chance(0.5) ? "deactivated" : "takendown";
+  }
+  return nlohmann::json::to_cbor(message);
+}
+
+nlohmann::json frame_synthesizer::make_record(std::string const &collection,
+                                              std::string const &time) {
+  if (collection == "app.bsky.feed.post")
+    return make_post(time);
+  if (collection == "app.bsky.actor.profile") {
+    return {{"$type", collection},
+            {"displayName", text(1, 3)},
+            {"description", text(5, 25)}};
+  }
+  nlohmann::json record = {{"$type", collection}, {"createdAt", time}};
+  if (collection == "app.bsky.feed.like" ||
+      collection == "app.bsky.feed.repost") {
+    record["subject"] = strong_ref();
+  } else {
+    // follow, block
+    record["subject"] = did();
+  }
+  return record;
+}
+
+nlohmann::json frame_synthesizer::make_post(std::string const &time) {
+  std::string post_text(text(3, 40));
+  nlohmann::json post = {
+      {"$type", "app.bsky.feed.post"},
+      {"createdAt", time},
+      {"langs",
+       nlohmann::json::array({Languages[_rng() % Languages.size()]})}};
+
+  nlohmann::json facets(nlohmann::json::array());
+  if (chance(_config._link_facet_fraction)) {
+    std::string uri("https://" +
+                    std::string(Domains[_rng() % Domains.size()]) + "/" +
+                    tid());
+    post_text += ' ' + uri;
+    facets.push_back(
+        {{"$type", "app.bsky.richtext.facet"},
+         {"index", facet_index(post_text, uri)},
+         {"features",
+          nlohmann::json::array(
+              {{{"$type", "app.bsky.richtext.facet#link"}, {"uri", uri}}})}});
+  }
+  if (chance(_config._mention_facet_fraction)) {
+    std::uniform_int_distribution<size_t> account(0, _config._accounts - 1);
+    const size_t which(account(_rng));
+    std::string mention("@synthetic" + std::to_string(which) +
+                        ".bsky.social");
+    post_text += ' ' + mention;
+    facets.push_back(
+        {{"$type", "app.bsky.richtext.facet"},
+         {"index", facet_index(post_text, mention)},
+         {"features",
+          nlohmann::json::array({{{"$type", "app.bsky.richtext.facet#mention"},
+                                  {"did", did(which)}}})}});
+  }
+  if (chance(_config._tag_facet_fraction)) {
+    std::string tag(Vocabulary[_rng() % Vocabulary.size()]);
+    post_text += " #" + tag;
+    facets.push_back(
+        {{"$type", "app.bsky.richtext.facet"},
+         {"index", facet_index(post_text, '#' + tag)},
+         {"features",
+          nlohmann::json::array(
+              {{{"$type", "app.bsky.richtext.facet#tag"}, {"tag", tag}}})}});
+  }
+  post["text"] = post_text;
+  if (!facets.empty()) {
+    post["facets"] = facets;
+  }
+
+  if (chance(_config._reply_fraction)) {
+    nlohmann::json parent(strong_ref());
+    post["reply"] = {{"root", chance(0.5) ? parent : strong_ref()},
+                     {"parent", parent}};
+  }
+
+  // at most one embed, in order of precedence
+  if (chance(_config._external_embed_fraction)) {
+    post["embed"] = {
+        {"$type", "app.bsky.embed.external"},
+        {"external",
+         {{"uri", "https://" + std::string(Domains[_rng() % Domains.size()]) +
+                      "/a/" + tid()},
+          {"title", text(2, 8)},
+          {"description", text(5, 20)}}}};
+  } else if (chance(_config._record_embed_fraction)) {
+    post["embed"] = {{"$type", "app.bsky.embed.record"},
+                     {"record", strong_ref()}};
+  } else if (chance(_config._images_embed_fraction)) {
+    nlohmann::json images(nlohmann::json::array());
+    const size_t count(1 + _rng() % 4);
+    for (size_t image = 0; image < count; ++image) {
+      bytes blob(32);
+      for (auto &next : blob)
+        next = static_cast<uint8_t>(_rng());
+      images.push_back({{"alt", text(0, 10)},
+                        {"image",
+                         {{"$type", "blob"},
+                          {"ref", cid_link(cid_for_block(blob))},
+                          {"mimeType", "image/jpeg"},
+                          {"size", 50000 + _rng() % 900000}}}});
+    }
+    post["embed"] = {{"$type", "app.bsky.embed.images"}, {"images", images}};
+  }
+  return post;
+}
+
+nlohmann::json frame_synthesizer::strong_ref() {
+  bytes subject(8);
+  for (auto &next : subject)
+    next = static_cast<uint8_t>(_rng());
+  return {{"uri", "at://" + did() + "/app.bsky.feed.post/" + tid()},
+          {"cid", cid_string(cid_for_block(subject))}};
+}
+
+std::string frame_synthesizer::text(const size_t min_words,
+                                    const size_t max_words) {
+  std::uniform_int_distribution<size_t> length(min_words, max_words);
+  const size_t words(length(_rng));
+  const bool hit(words > 0 && chance(_config._rule_hit_fraction));
+  const size_t hit_at(hit ? _rng() % words : words);
+  std::string result;
+  for (size_t word = 0; word < words; ++word) {
+    if (word > 0)
+      result.push_back(' ');
+    if (word == hit_at) {
+      result.append(
+          _config._rule_targets[_rng() % _config._rule_targets.size()]);
+    } else {
+      result.append(Vocabulary[_rng() % Vocabulary.size()]);
+    }
+  }
+  return result;
+}
+
+std::string frame_synthesizer::did() {
+  std::uniform_int_distribution<size_t> account(0, _config._accounts - 1);
+  return did(account(_rng));
+}
+
+std::string frame_synthesizer::did(const size_t account) {
+  // did:plc identifiers are 24 characters of base32
+  std::string suffix(std::to_string(account));
+  std::string result("did:plc:synthetic");
+  result.append(24 - std::min<size_t>(24, 9 + suffix.length()), 'a');
+  return result + suffix;
+}
+
+// Timestamp identifier - microseconds since epoch and clock id, base32
+// sortable
+std::string frame_synthesizer::tid() {
+  static std::atomic<uint64_t> last(0);
+  uint64_t micros(std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::system_clock::now().time_since_epoch())
+                      .count());
+  // monotonic across all sessions so rkeys and revs do not collide
+  uint64_t previous(last.load(std::memory_order_relaxed));
+  do {
+    if (micros <= previous)
+      micros = previous + 1;
+  } while (!last.compare_exchange_weak(previous, micros,
+                                       std::memory_order_relaxed));
+  uint64_t value(((micros & 0x1FFFFFFFFFFFFFULL) << 10) | _clock_id);
+  std::string result(13, '2');
+  for (size_t index = 13; index > 0; --index) {
+    result[index - 1] = Base32Sortable[value & 0x1F];
+    value >>= 5;
+  }
+  return result;
+}
+
+bool frame_synthesizer::chance(const double fraction) {
+  return std::uniform_real_distribution<double>(0.0, 1.0)(_rng) < fraction;
+}
+
+bytes cid_for_block(bytes const &block) {
+  bytes cid = {0x01, 0x71, 0x12, 0x20};
+  std::array<unsigned char, SHA256_DIGEST_LENGTH> digest;
+  SHA256(block.data(), block.size(), digest.data());
+  cid.insert(cid.end(), digest.cbegin(), digest.cend());
+  return cid;
+}
+
+nlohmann::json cid_link(bytes const &cid) {
+  bytes link(1, 0x00);
+  link.insert(link.end(), cid.cbegin(), cid.cend());
+  return nlohmann::json::binary(std::move(link), 42);
+}
+
+std::string cid_string(bytes const &cid) {
+  std::string result("b");
+  uint32_t buffer(0);
+  int bits(0);
+  for (uint8_t next : cid) {
+    buffer = (buffer << 8) | next;
+    bits += 8;
+    while (bits >= 5) {
+      result.push_back(Base32Lower[(buffer >> (bits - 5)) & 0x1F]);
+      bits -= 5;
+    }
+  }
+  if (bits > 0) {
+    result.push_back(Base32Lower[(buffer << (5 - bits)) & 0x1F]);
+  }
+  return result;
+}
+
+bytes make_car(bytes const &root, std::vector<bytes> const &blocks) {
+  bytes header(nlohmann::json::to_cbor(
+      {{"roots", nlohmann::json::array({cid_link(root)})}, {"version", 1}}));
+  bytes result;
+  append_varint(result, header.size());
+  result.insert(result.end(), header.cbegin(), header.cend());
+  for (auto const &block : blocks) {
+    bytes cid(cid_for_block(block));
+    append_varint(result, cid.size() + block.size());
+    result.insert(result.end(), cid.cbegin(), cid.cend());
+    result.insert(result.end(), block.cbegin(), block.cend());
+  }
+  return result;
+}
+
+} // namespace generator
@@ -0,0 +1,242 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Generator
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "common/config.hpp"
+#include "common/controller.hpp"
+#include "common/log_wrapper.hpp"
+#include "frame_synthesizer.hpp"
+#include "project_defs.hpp"
+#include <boost/asio/spawn.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+namespace beast = boost::beast;         // from <boost/beast.hpp>
+namespace websocket = beast::websocket; // from <boost/beast/websocket.hpp>
+namespace net = boost::asio;            // from <boost/asio.hpp>
+namespace ssl = boost::asio::ssl;       // from <boost/asio/ssl.hpp>
+using tcp = boost::asio::ip::tcp;       // from <boost/asio/ip/tcp.hpp>
+
+namespace {
+// frames sent across all sessions, for throughput logging
+std::atomic<uint64_t> frames_sent(0);
+std::atomic<uint64_t> bytes_sent(0);
+
+void fail(beast::error_code ec, char const *what) {
+  REL_ERROR("generator error: {}: {}", what, ec.message());
+}
+
+// Stream frames to one subscriber at the configured rate until it goes away.
+// Each session has its own synthesizer so sessions do not contend on the RNG.
+void do_session(websocket::stream<ssl::stream<beast::tcp_stream>> &ws,
+                generator::settings const &settings, const uint64_t seed,
+                const double rate, net::yield_context yield) {
+  beast::error_code ec;
+
+  beast::get_lowest_layer(ws).expires_after(std::chrono::seconds(30));
+  ws.next_layer().async_handshake(ssl::stream_base::server, yield[ec]);
+  if (ec)
+    return fail(ec, "ssl_handshake");
+
+  beast::get_lowest_layer(ws).expires_never();
+  ws.set_option(
+      websocket::stream_base::timeout::suggested(beast::role_type::server));
+  ws.binary(true);
+
+  // any subscription target is accepted, the client asks for subscribeRepos
+  ws.async_accept(yield[ec]);
+  if (ec)
+    return fail(ec, "accept");
+  REL_INFO("subscriber connected from {}",
+           beast::get_lowest_layer(ws).socket().remote_endpoint().address()
+               .to_string());
+
+  generator::frame_synthesizer synthesizer(settings, seed);
+  net::steady_timer pacer(ws.get_executor());
+  typedef std::chrono::steady_clock::duration send_interval;
+  const send_interval interval(
+      rate > 0.0 ? std::chrono::duration_cast<send_interval>(
+                       std::chrono::duration<double>(1.0 / rate))
+                 : send_interval::zero());
+  auto next_send(std::chrono::steady_clock::now());
+  while (controller::instance().is_active()) {
+    std::string frame(synthesizer.next());
+    ws.async_write(net::buffer(frame), yield[ec]);
+    if (ec)
+      return fail(ec, "write");
+    frames_sent.fetch_add(1, std::memory_order_relaxed);
+    bytes_sent.fetch_add(frame.length(), std::memory_order_relaxed);
+
+    if (interval != send_interval::zero()) {
+      // pace against an absolute schedule so timer slop does not accumulate
+      next_send += interval;
+      if (next_send > std::chrono::steady_clock::now()) {
+        pacer.expires_at(next_send);
+        pacer.async_wait(yield[ec]);
+      }
+    }
+  }
+  ws.async_close(websocket::close_code::normal, yield[ec]);
+}
+
+void do_listen(net::io_context &ioc, ssl::context &ctx, tcp::endpoint endpoint,
+               generator::settings const &settings, const uint64_t seed,
+               const double rate, net::yield_context yield) {
+  beast::error_code ec;
+  tcp::acceptor acceptor(ioc);
+  acceptor.open(endpoint.protocol(), ec);
+  if (ec)
+    return fail(ec, "open");
+  acceptor.set_option(net::socket_base::reuse_address(true), ec);
+  if (ec)
+    return fail(ec, "set_option");
+  acceptor.bind(endpoint, ec);
+  if (ec)
+    return fail(ec, "bind");
+  acceptor.listen(net::socket_base::max_listen_connections, ec);
+  if (ec)
+    return fail(ec, "listen");
+
+  uint64_t session(0);
+  while (controller::instance().is_active()) {
+    tcp::socket socket(ioc);
+    acceptor.async_accept(socket, yield[ec]);
+    if (ec) {
+      fail(ec, "accept");
+      continue;
+    }
+    ++session;
+    boost::asio::spawn(
+        acceptor.get_executor(),
+        [&ctx, &settings, socket = std::move(socket), seed, session,
+         rate](net::yield_context yield) mutable {
+          websocket::stream<ssl::stream<beast::tcp_stream>> ws(
+              std::move(socket), ctx);
+          do_session(ws, settings, seed + session, rate, yield);
+        },
+        [](std::exception_ptr ex) {
+          if (ex)
+            std::rethrow_exception(ex);
+        });
+  }
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  bool log_ready(false);
+  try {
+    // Check command line arguments.
+    if (argc != 2) {
+      std::cerr << "Usage: firehose_generator <config-file-name>\n";
+      return EXIT_FAILURE;
+    }
+
+    std::shared_ptr<config> settings(std::make_shared<config>(argv[1]));
+    std::string const log_file(
+        settings->get_config()[PROJECT_NAME]["logging"]["filename"]
+            .as<std::string>());
+    spdlog::level::level_enum log_level(spdlog::level::from_str(
+        settings->get_config()[PROJECT_NAME]["logging"]["level"]
+            .as<std::string>()));
+    if (!init_logging(log_file, PROJECT_NAME, log_level)) {
+      return EXIT_FAILURE;
+    }
+    log_ready = true;
+
+    controller::instance().set_config(settings);
+    controller::instance().start();
+
+    REL_INFO("firehose_generator v{}.{}.{}", PROJECT_NAME_VERSION_MAJOR,
+             PROJECT_NAME_VERSION_MINOR, PROJECT_NAME_VERSION_PATCH);
+
+    YAML::Node const generator_config(settings->get_config()[PROJECT_NAME]);
+    generator::settings const frame_settings(
+        generator::settings::from_config(generator_config["frames"]));
+    // frames per second per subscriber, zero for as fast as possible
+    const double rate(generator_config["rate"].as<double>(0.0));
+    const uint64_t seed(generator_config["seed"].as<uint64_t>(1));
+
+    YAML::Node const server_config(generator_config["server"]);
+    const unsigned short port(server_config["port"].as<unsigned short>());
+    const size_t threads(
+        std::max<size_t>(1, server_config["threads"].as<size_t>(1)));
+
+    // The client does not verify the peer, a self-signed certificate is fine
+    ssl::context ctx{ssl::context::tlsv12_server};
+    ctx.set_options(ssl::context::default_workarounds |
+                    ssl::context::no_sslv2 | ssl::context::no_sslv3);
+    ctx.use_certificate_chain_file(
+        server_config["certificate"].as<std::string>());
+    ctx.use_private_key_file(server_config["private_key"].as<std::string>(),
+                             ssl::context::pem);
+
+    net::io_context ioc(static_cast<int>(threads));
+    boost::asio::spawn(ioc,
+                       std::bind(&do_listen, std::ref(ioc), std::ref(ctx),
+                                 tcp::endpoint{net::ip::tcp::v4(), port},
+                                 std::cref(frame_settings), seed, rate,
+                                 std::placeholders::_1),
+                       [](std::exception_ptr ex) {
+                         if (ex)
+                           std::rethrow_exception(ex);
+                       });
+    REL_INFO("serving synthetic firehose on port {} at {} msgs/s", port,
+             rate > 0.0 ? std::to_string(rate) : std::string("max"));
+
+    std::vector<std::thread> runners;
+    runners.reserve(threads - 1);
+    for (size_t runner = 1; runner < threads; ++runner) {
+      runners.emplace_back([&ioc] { ioc.run(); });
+    }
+    std::thread reporter([] {
+      uint64_t last_frames(0);
+      uint64_t last_bytes(0);
+      while (controller::instance().is_active()) {
+        std::this_thread::sleep_for(std::chrono::seconds(10));
+        uint64_t frames(frames_sent.load(std::memory_order_relaxed));
+        uint64_t bytes(bytes_sent.load(std::memory_order_relaxed));
+        REL_INFO("sent {} frames, {:.1f} msgs/s, {:.1f} KB/s", frames,
+                 static_cast<double>(frames - last_frames) / 10.0,
+                 static_cast<double>(bytes - last_bytes) / 10240.0);
+        last_frames = frames;
+        last_bytes = bytes;
+      }
+    });
+    ioc.run();
+    for (auto &runner : runners) {
+      runner.join();
+    }
+    reporter.join();
+  } catch (std::exception const &exc) {
+    if (log_ready) {
+      REL_CRITICAL("Unhandled exception : {}", exc.what());
+    } else {
+      std::cerr << "Unhandled exception : " << exc.what() << '\n';
+    }
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
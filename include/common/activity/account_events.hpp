@@ -19,7 +19,10 @@ http://www.fsf.org/licensing/licenses
 >>> END OF LICENSE >>>
 *************************************************************************/
 
+#include "common/activity/pile_on.hpp"
 #include "common/helpers.hpp"
+#include "common/pipeline_timing.hpp"
+#include <algorithm>
 #include <cache.hpp>
 #include <chrono>
 #include <deque>
@@ -73,6 +76,10 @@ struct profile {
 };
 struct deleted {
   std::string _path;
+  // like/repost subject URI or follow/block subject DID, if known
+  std::string _subject;
+  // time since the record was created, if the subject is known
+  std::chrono::milliseconds _lifetime = std::chrono::milliseconds(0);
 };
 struct matches {
   unsigned short _count;
@@ -82,8 +89,20 @@ struct facets {
   unsigned short _mentions;
   unsigned short _links;
 };
+// post is one of a cluster of near-duplicates from this many accounts
+struct near_duplicate {
+  unsigned short _accounts;
+};
+// one of a group of accounts interacting with the same set of targets
+struct coordinated {
+  unsigned short _targets;
+};
+// a repost, quote or like by this account put content over an alert
+// threshold, in the partition that owns the content
+struct target_alert {};
 typedef std::variant<post, reply, repost, quote, follow, block, like, active,
-                     inactive, handle, profile, deleted, matches, facets>
+                     inactive, handle, profile, deleted, matches, facets,
+                     near_duplicate, coordinated, target_alert>
     event;
 struct timed_event {
   inline timed_event() : _event(active()) {}
@@ -91,21 +110,32 @@ struct timed_event {
                      event &&this_event)
       : _did(did), _created_at(created_at), _event(std::move(this_event)) {}
   inline timed_event(const timed_event &event)
-      : _did(event._did), _created_at(event._created_at), _event(event._event) {
-  }
+      : _did(event._did), _created_at(event._created_at), _event(event._event),
+        _ingested(event._ingested), _forwarded(event._forwarded),
+        _low_history(event._low_history) {}
   inline timed_event &operator=(const timed_event &event) {
     _did = event._did;
     _created_at = event._created_at;
     _event = event._event;
+    _ingested = event._ingested;
+    _forwarded = event._forwarded;
+    _low_history = event._low_history;
     return *this;
   }
   inline timed_event(timed_event &&event)
       : _did(std::move(event._did)), _created_at(std::move(event._created_at)),
-        _event(std::move(event._event)) {}
+        _event(std::move(event._event)), _ingested(event._ingested),
+        _forwarded(event._forwarded), _low_history(event._low_history) {}
 
   did_type _did;
   bsky::time_stamp _created_at;
   event _event;
+  // receipt time of the originating firehose frame, if any
+  pipeline::ingest_time _ingested;
+  // recorded by the actor's partition, only the target-side effects apply
+  bool _forwarded = false;
+  // forwarded copies only, the actor has low history in its own partition
+  bool _low_history = false;
 };
 typedef std::deque<timed_event> events;
 
@@ -223,10 +253,20 @@ public:
     void handle();
 
     void deleted(std::string const &path);
+    void churned(std::string const &path);
+    inline void unliked() { _liked = std::max(_liked - 1, 0); }
+    inline void unreposted() { _reposted = std::max(_reposted - 1, 0); }
+    inline void unfollowed_by() {
+      _followed_by = std::max(_followed_by - 1, 0);
+    }
+    inline void unblocked_by() { _blocked_by = std::max(_blocked_by - 1, 0); }
 
     void add_matches(const unsigned short matches);
     size_t matches() const { return _matches; }
 
+    void near_duplicate(const unsigned short accounts);
+    void coordinated(const unsigned short targets);
+
     std::string _did;
     std::string _handle;
     state _state = state::unknown;
@@ -242,8 +282,8 @@ public:
     // content interactions may have a negative count
     int32_t _posts = 0;
 
-    // these may go negative, depending on the state of the account when
-    // recorded, and subsequent events
+    // counts from before the account was cached are not known, so undoing an
+    // earlier interaction stops at zero
     int32_t _replied_to = 0;
     int32_t _replies = 0;
     int32_t _quoted = 0;
@@ -271,8 +311,13 @@ public:
     size_t _unreposts = 0;
     size_t _unfollows = 0;
     size_t _unblocks = 0;
+    // undone within ChurnWindow of being created
+    size_t _follow_churn = 0;
+    size_t _like_churn = 0;
 
     unsigned short _matches = 0;
+    size_t _near_duplicates = 0;
+    size_t _coordinated = 0;
   };
 
   // per-post facet abuse thresholds - hashtag, links, mentions, total
@@ -316,6 +361,11 @@ public:
   static constexpr size_t UpdateFactor = 10;
   // track account-level deletes, total of individual buckets
   static constexpr size_t DeleteFactor = 25;
+  // follow/unfollow and like/unlike cycling, for deletes whose subject is
+  // known
+  static constexpr std::chrono::hours ChurnWindow = std::chrono::hours(24);
+  static constexpr size_t FollowChurnFactor = 25;
+  static constexpr size_t LikeChurnFactor = 50;
   // output a log every few matches to highlight suspect activity
   static constexpr size_t MatchFactor = 5;
 
@@ -329,6 +379,9 @@ public:
 
   caches::WrappedValue<content_hit_count>
   get_content_item(atproto::at_uri const &uri);
+  // nullptr if not cached, and not counted as a hit
+  caches::WrappedValue<content_hit_count>
+  find_content_item(atproto::at_uri const &uri);
   // Callback on LFU cache eviction
   void on_erase(atproto::at_uri const &uri,
                 caches::WrappedValue<content_hit_count> const &entry);
@@ -345,7 +398,8 @@ private:
 
 // visitor for account-specific logic
 struct augment_account_event {
-  augment_account_event(event_cache &cache, account::statistics &stats);
+  augment_account_event(event_cache &cache, account::statistics &stats,
+                        const bsky::time_stamp when);
   template <typename T> void operator()(T const &value) {}
 
   void operator()(activity::post const &value);
@@ -369,11 +423,52 @@ struct augment_account_event {
 
   void operator()(activity::facets const &value);
 
+  void operator()(activity::near_duplicate const &value);
+  void operator()(activity::coordinated const &value);
+
 private:
-  void reply_to(atproto::at_uri const &uri);
+  // this account, as pile-on detection on its targets sees it
+  bool low_history() const;
 
   account::statistics &_stats;
   event_cache &_cache;
+  // when the event's frame was emitted
+  bsky::time_stamp _when;
+};
+
+// visitor for the effects of an interaction on the account interacted with.
+// Targets outside this process's partition are skipped, the owning partition
+// records them from a forwarded copy of the event. Whether the interacting
+// account has low history, and the event time, feed pile-on detection.
+struct augment_target_event {
+  augment_target_event(event_cache &cache, did_type const &actor,
+                       const bool low_history, const bsky::time_stamp when);
+  template <typename T> void operator()(T const &value) {}
+
+  void operator()(activity::reply const &value);
+  void operator()(activity::repost const &value);
+  void operator()(activity::quote const &value);
+
+  void operator()(activity::block const &value);
+  void operator()(activity::follow const &value);
+
+  void operator()(activity::like const &value);
+
+  // undo the counts of the interaction the deleted record made
+  void operator()(activity::deleted const &value);
+
+  // content alert raised, the actor shares the blame
+  inline bool alerted() const { return _alerted; }
+
+private:
+  void reply_to(atproto::at_uri const &uri);
+  void reply_pile_on(atproto::at_uri const &uri);
+
+  event_cache &_cache;
+  did_type const &_actor;
+  bool _low_history;
+  bsky::time_stamp _when;
+  bool _alerted = false;
 };
 
 } // namespace activity
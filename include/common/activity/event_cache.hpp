@@ -22,6 +22,7 @@ http://www.fsf.org/licensing/licenses
 
 #include "common/activity/account_events.hpp"
 #include <cache.hpp>
+#include <functional>
 #include <lfu_cache_policy.hpp>
 #include <mutex>
 
@@ -44,6 +45,25 @@ public:
 
   void record(timed_event const &value);
   caches::WrappedValue<account> get_account(std::string const &did);
+  // nullptr if not cached
+  caches::WrappedValue<account> find_account(std::string const &did);
+
+  // Partitioned deployment, only accounts owned by this process are cached.
+  // forward sends an interaction with accounts owned elsewhere to their
+  // partitions, with whether the actor has low history here. alert_actor
+  // sends the actor's share of an alert on a local target to the partition
+  // that owns the actor. Set before recording starts.
+  inline void set_partition(
+      std::function<bool(std::string const &)> const &is_local,
+      std::function<void(timed_event const &, const bool)> const &forward,
+      std::function<void(std::string const &)> const &alert_actor) {
+    _is_local = is_local;
+    _forward = forward;
+    _alert_actor = alert_actor;
+  }
+  inline bool is_local(std::string const &did) const {
+    return !_is_local || _is_local(did);
+  }
 
 private:
   // visitor for event-specific logic
@@ -54,6 +74,9 @@ private:
   // LFU cache of recently-active accounts
   std::mutex _cache_lock;
   lfu_cache_t<std::string, account> _account_events;
+  std::function<bool(std::string const &)> _is_local;
+  std::function<void(timed_event const &, const bool)> _forward;
+  std::function<void(std::string const &)> _alert_actor;
 };
 } // namespace activity
 
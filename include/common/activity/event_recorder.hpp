@@ -34,6 +34,13 @@ public:
   std::string ensure_loaded(std::string const &did);
   void update_handle(std::string const &did, std::string const &handle);
   std::string get_handle(std::string const &did);
+  // partitioned deployment, call before the first event is recorded
+  inline void set_partition(
+      std::function<bool(std::string const &)> const &is_local,
+      std::function<void(timed_event const &, const bool)> const &forward,
+      std::function<void(std::string const &)> const &alert_actor) {
+    _events.set_partition(is_local, forward, alert_actor);
+  }
 
 private:
   event_recorder();
@@ -0,0 +1,286 @@
+#ifndef __pile_on_hpp__
+#define __pile_on_hpp__
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "common/bluesky/platform.hpp"
+#include "yaml-cpp/yaml.h"
+#include <prometheus/counter.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace activity {
+
+// HyperLogLog distinct count in 64 one-byte registers, standard error about
+// 13%. Enough to tell a handful of repliers from hundreds in fixed space.
+class hyperloglog {
+public:
+  static constexpr size_t Precision = 6;
+  static constexpr size_t Registers = size_t(1) << Precision;
+
+  // value must be well mixed, see pile_on_tracker::mix
+  inline void add(const uint64_t value) {
+    const size_t index(static_cast<size_t>(value >> (64 - Precision)));
+    // sentinel bit caps the rank for an all-zero remainder
+    const uint8_t rank(static_cast<uint8_t>(
+        std::countl_zero((value << Precision) |
+                         (uint64_t(1) << (Precision - 1))) +
+        1));
+    _registers[index] = std::max(_registers[index], rank);
+  }
+  inline void merge(hyperloglog const &other) {
+    for (size_t index = 0; index < Registers; ++index) {
+      _registers[index] = std::max(_registers[index], other._registers[index]);
+    }
+  }
+  double estimate() const {
+    constexpr double alpha(0.709);
+    constexpr double registers(static_cast<double>(Registers));
+    double sum(0.0);
+    size_t zeros(0);
+    for (auto const rank : _registers) {
+      sum += std::ldexp(1.0, -static_cast<int>(rank));
+      zeros += rank == 0 ? 1 : 0;
+    }
+    const double raw(alpha * registers * registers / sum);
+    // linear counting is more accurate for small sets
+    if (raw <= 2.5 * registers && zeros > 0) {
+      return registers * std::log(registers / static_cast<double>(zeros));
+    }
+    return raw;
+  }
+  inline void clear() { _registers.fill(0); }
+
+private:
+  std::array<uint8_t, Registers> _registers = {};
+};
+
+// Reply or quote rate and distinct interacting accounts per target, over a
+// sliding window. As in rate_observer, the window is approximated by the
+// current fixed window plus the previous one weighted by its overlap.
+// Distinct accounts are counted over both fixed windows.
+//
+// Targets live in a fixed table, two slots per hashed set, so memory is set
+// by the slot count and each observation is O(1). A new target displaces
+// an idle one of the two if there is one, otherwise the less busy. Busy
+// targets are rarely displaced, and those are the ones that matter.
+class pile_on_tracker {
+public:
+  struct observation {
+    // interactions in the sliding window
+    double _rate = 0.0;
+    // estimated distinct accounts, only when the rate threshold is met
+    double _distinct = 0.0;
+    // share of interactions from low-history accounts
+    double _low_history_share = 0.0;
+    bool _alert = false;
+  };
+
+  pile_on_tracker(const std::chrono::milliseconds window, const size_t slots,
+                  const size_t min_rate, const size_t min_distinct,
+                  const double min_low_history_share)
+      : _window(window), _sets(std::max<size_t>(1, slots / 2)),
+        _min_rate(min_rate), _min_distinct(min_distinct),
+        _min_low_history_share(min_low_history_share),
+        _slots(_sets * 2) {}
+
+  // splitmix64 finalizer, std::hash of a string is not guaranteed to mix
+  static inline uint64_t mix(uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+  }
+
+  // Records an interaction with target by actor. Alerts at most once per
+  // window per target, when rate, distinct accounts and low-history share
+  // all reach their thresholds.
+  observation observe(const uint64_t target, const uint64_t actor,
+                      const bool low_history, const bsky::time_stamp now) {
+    window_state &state(slot_for(mix(target), now));
+    if (now >= state._current_start + _window) {
+      // roll forward, a gap of more than one window leaves nothing behind
+      if (now >= state._current_start + _window + _window) {
+        state._previous = 0;
+        state._previous_low_history = 0;
+        state._previous_actors.clear();
+      } else {
+        state._previous = state._current;
+        state._previous_low_history = state._current_low_history;
+        state._previous_actors = state._current_actors;
+      }
+      state._current_start = now;
+      state._current = 0;
+      state._current_low_history = 0;
+      state._current_actors.clear();
+    }
+    ++state._current;
+    state._current_low_history += low_history ? 1 : 0;
+    state._current_actors.add(mix(actor));
+    state._last_seen = now;
+
+    observation result;
+    // share of the previous fixed window inside the sliding window
+    const double overlap(std::clamp(
+        std::chrono::duration<double>(state._current_start + _window - now) /
+            std::chrono::duration<double>(_window),
+        0.0, 1.0));
+    result._rate = overlap * static_cast<double>(state._previous) +
+                   static_cast<double>(state._current);
+    const uint32_t total(state._previous + state._current);
+    result._low_history_share =
+        static_cast<double>(state._previous_low_history +
+                            state._current_low_history) /
+        static_cast<double>(total);
+    if (result._rate < static_cast<double>(_min_rate) ||
+        result._low_history_share < _min_low_history_share)
+      return result;
+    hyperloglog actors(state._current_actors);
+    actors.merge(state._previous_actors);
+    result._distinct = actors.estimate();
+    if (result._distinct >= static_cast<double>(_min_distinct) &&
+        now >= state._alerted_until) {
+      result._alert = true;
+      state._alerted_until = now + _window;
+    }
+    return result;
+  }
+
+  inline size_t slots() const { return _slots.size(); }
+  // targets displaced by another before their window passed
+  inline size_t evicted() const { return _evicted; }
+
+private:
+  struct window_state {
+    // 0 marks an empty slot
+    uint64_t _target = 0;
+    bsky::time_stamp _current_start;
+    bsky::time_stamp _last_seen;
+    bsky::time_stamp _alerted_until;
+    uint32_t _current = 0;
+    uint32_t _previous = 0;
+    uint32_t _current_low_history = 0;
+    uint32_t _previous_low_history = 0;
+    hyperloglog _current_actors;
+    hyperloglog _previous_actors;
+  };
+
+  window_state &slot_for(uint64_t target, const bsky::time_stamp now) {
+    if (target == 0)
+      target = 1;
+    const size_t set(static_cast<size_t>(target % _sets) * 2);
+    window_state &first(_slots[set]);
+    window_state &second(_slots[set + 1]);
+    if (first._target == target)
+      return first;
+    if (second._target == target)
+      return second;
+    window_state &victim(displace_first(first, second, now) ? first : second);
+    if (victim._target != 0 && victim._last_seen + _window > now)
+      ++_evicted;
+    victim = window_state();
+    victim._target = target;
+    // first observation rolls the window, with no previous window
+    victim._current_start = now - _window - _window;
+    return victim;
+  }
+
+  // stale before active, then less busy, then less recently seen
+  bool displace_first(window_state const &first, window_state const &second,
+                      const bsky::time_stamp now) const {
+    const bool first_stale(first._last_seen + _window <= now);
+    const bool second_stale(second._last_seen + _window <= now);
+    if (first_stale != second_stale)
+      return first_stale;
+    const uint32_t first_count(first._current + first._previous);
+    const uint32_t second_count(second._current + second._previous);
+    if (first_count != second_count)
+      return first_count < second_count;
+    return first._last_seen <= second._last_seen;
+  }
+
+  std::chrono::milliseconds _window;
+  size_t _sets;
+  size_t _min_rate;
+  size_t _min_distinct;
+  double _min_low_history_share;
+  std::vector<window_state> _slots;
+  size_t _evicted = 0;
+};
+
+// Pile-ons on a post, many replies or quotes in a short time from many
+// accounts, a large share of them new or with little history here. Off until
+// the pile_on config section sets it up.
+// An account has low history if fewer than low_history_events of its events
+// have been recorded. Counts start when the account is cached, so until
+// warm_up_ms has passed every account would look new, and none is treated
+// as low history. Windows and warm-up run on the time of the frame that
+// carried each event, so a replayed backlog keeps its original spacing.
+// In a partitioned deployment the actor's partition decides, and the flag
+// travels with the forwarded interaction. Called on the event recorder
+// thread only.
+class pile_on_detector {
+public:
+  static pile_on_detector &instance();
+  void set_config(YAML::Node const &settings);
+  void register_metrics();
+
+  // warm-up starts at the first event seen
+  bool low_history(const size_t actor_events, const bsky::time_stamp when);
+  // returns true if the target has a pile-on in progress, newly alerted
+  bool reply(atproto::at_uri const &target, std::string const &actor,
+             const bool low_history, const bsky::time_stamp when);
+  bool quote(atproto::at_uri const &target, std::string const &actor,
+             const bool low_history, const bsky::time_stamp when);
+
+private:
+  pile_on_detector() = default;
+  ~pile_on_detector() = default;
+
+  bool observe(pile_on_tracker &tracker, std::string_view kind,
+               atproto::at_uri const &target, std::string const &actor,
+               const bool low_history, const bsky::time_stamp when);
+
+  std::unique_ptr<pile_on_tracker> _replies;
+  std::unique_ptr<pile_on_tracker> _quotes;
+  size_t _low_history_events = 5;
+  std::chrono::milliseconds _warm_up = std::chrono::milliseconds(0);
+  std::optional<bsky::time_stamp> _warm_from;
+
+  prometheus::Counter *_observed = nullptr;
+  prometheus::Counter *_low_history = nullptr;
+  prometheus::Counter *_evicted = nullptr;
+  size_t _evicted_reported = 0;
+};
+
+} // namespace activity
+
+#endif
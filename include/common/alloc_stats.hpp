@@ -0,0 +1,107 @@
+#ifndef __alloc_stats_hpp__
+#define __alloc_stats_hpp__
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include <prometheus/histogram.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Heap allocation accounting per message, per pipeline stage. Opt-in via
+// ALLOC_STATS build flag, which also links a global operator new/delete hook
+// into the executable. Without the flag scopes compile to nothing.
+//
+// Counts are per-thread and inclusive: a scope nested inside another on the
+// same thread contributes to both.
+namespace alloc_stats {
+
+enum class stage : size_t {
+  content_handler = 0,
+  firehose_payload,
+  event_cache,
+  max_stage
+};
+
+// running totals for this thread, updated by the operator new hook
+struct thread_totals {
+  uint64_t _allocations;
+  uint64_t _bytes;
+};
+extern thread_local thread_totals totals;
+
+inline void on_allocate(const size_t size) {
+  ++totals._allocations;
+  totals._bytes += size;
+}
+
+class recorder {
+public:
+  static recorder &instance();
+
+  // Registers histograms, scope observation is a no-op until done
+  void register_metrics();
+  void record(const stage this_stage, const uint64_t allocations,
+              const uint64_t bytes);
+
+private:
+  recorder() = default;
+  ~recorder() = default;
+
+  static const prometheus::Histogram::BucketBoundaries AllocationBuckets;
+  static const prometheus::Histogram::BucketBoundaries ByteBuckets;
+
+  // per-stage series, indexed by stage
+  std::array<prometheus::Histogram *, static_cast<size_t>(stage::max_stage)>
+      _allocations = {};
+  std::array<prometheus::Histogram *, static_cast<size_t>(stage::max_stage)>
+      _bytes = {};
+};
+
+#if defined(ALLOC_STATS)
+// RAII marker, observes allocations made on this thread during its lifetime
+class scope {
+public:
+  explicit scope(const stage this_stage)
+      : _stage(this_stage), _allocations(totals._allocations),
+        _bytes(totals._bytes) {}
+  ~scope() {
+    recorder::instance().record(_stage, totals._allocations - _allocations,
+                                totals._bytes - _bytes);
+  }
+  scope(scope const &) = delete;
+  scope &operator=(scope const &) = delete;
+
+private:
+  stage _stage;
+  uint64_t _allocations;
+  uint64_t _bytes;
+};
+#else
+class scope {
+public:
+  explicit scope(const stage) {}
+  scope(scope const &) = delete;
+  scope &operator=(scope const &) = delete;
+};
+#endif
+
+} // namespace alloc_stats
+#endif
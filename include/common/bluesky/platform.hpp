@@ -20,9 +20,13 @@ http://www.fsf.org/licensing/licenses
 >>> END OF LICENSE >>>
 *************************************************************************/
 #include <boost/functional/hash.hpp>
+#include <array>
 #include <chrono>
+#include <cstring>
 #include <multiformats/cid.hpp>
 #include <nlohmann/json.hpp>
+#include <optional>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 
@@ -132,6 +136,14 @@ inline bsky::time_stamp current_time() {
 
 // Parse ISO8601 time
 bsky::time_stamp time_stamp_from_iso_8601(std::string const &date_time);
+// Fixed-format RFC 3339 as emitted by the firehose -
+// YYYY-MM-DDTHH:MM:SS[.fraction](Z|+hh:mm|-hh:mm). No allocation. Returns
+// nullopt for anything else, including leap seconds.
+std::optional<bsky::time_stamp>
+time_stamp_from_rfc_3339(std::string_view date_time);
+// Permissive std::chrono::parse fallback for other observed forms
+bsky::time_stamp
+time_stamp_from_iso_8601_permissive(std::string const &date_time);
 
 } // namespace bsky
 
@@ -223,53 +235,107 @@ inline bool operator==(const at_uri &lhs, const at_uri &rhs) {
          lhs._collection == rhs._collection && lhs._rkey == rhs._rkey;
 }
 
-template <typename IteratorType> class cid_decoder {
+// CID held in binary form as it appears on the wire - version, codec and
+// multihash. Fixed size, no allocation, cheap to hash and compare. Convert to
+// the platform's display form only when a string is needed.
+class binary_cid {
 public:
-  cid_decoder(IteratorType begin, IteratorType end)
-      : _begin(begin), _end(end), _current(begin) {}
+  // v1 with sha2-256 is 36 bytes, allow for larger varints and digests
+  static constexpr size_t MaxLength = 48;
+
+  binary_cid() = default;
+  // bytes without the leading multibase zero
+  template <typename IteratorType>
+  binary_cid(IteratorType begin, IteratorType end) {
+    bool truncated(false);
+    read([&]() -> uint8_t {
+      if (begin == end) {
+        truncated = true;
+        return 0;
+      }
+      return static_cast<uint8_t>(*begin++);
+    });
+    if (truncated)
+      throw std::invalid_argument("Truncated CID");
+  }
 
-  // decode CID into the platform's display form
-  std::string as_string() {
-    uint64_t version(read_u64_leb128());
-    uint64_t codec(read_u64_leb128());
+  // Consume exactly one CID from a byte source
+  template <typename NextByte> void read(NextByte &&next_byte) {
+    _length = 0;
+    uint64_t version(read_varint(next_byte));
     uint64_t digest_length(0);
-    if (version == 0x12 && codec == 0x20) {
-      // handle v0 CID - digest is always 32 bytes
-      digest_length = 32;
-      version = 0;
+    if (version == 0x12 && _length == 1) {
+      // v0 is a bare sha2-256 multihash
+      digest_length = read_varint(next_byte);
     } else {
-      // arcane knowledge - DAG-PB wrapper on the 32-byte digest
-      digest_length = 34;
+      read_varint(next_byte); // codec
+      read_varint(next_byte); // multihash function
+      digest_length = read_varint(next_byte);
     }
-    std::vector<uint8_t> digest(digest_length);
-    for (auto next = digest.begin(); next != digest.end(); ++next) {
-      *next = this->get();
+    if (_length + digest_length > MaxLength)
+      throw std::invalid_argument("CID too long");
+    for (uint64_t count = 0; count < digest_length; ++count) {
+      _bytes[_length++] = next_byte();
     }
-    // Caller needs to process according to context
-    Multiformats::Cid cid({version}, {codec}, {digest.cbegin(), digest.cend()});
-    return cid.to_string(Multiformats::Multibase::Protocol::Base32);
   }
 
-private:
-  unsigned char get() const { return *_current++; }
+  inline bool empty() const { return _length == 0; }
+  inline size_t length() const { return _length; }
+  inline uint8_t const *data() const { return _bytes.data(); }
+  inline bool is_v0() const { return _length > 0 && _bytes[0] == 0x12; }
+
+  // display form, multibase base32 for both versions. v0 is not given its
+  // conventional base58btc form, CIDs are compared as base32 strings.
+  std::string to_string() const;
 
-  uint64_t read_u64_leb128() const {
-    unsigned char uchar(0);
-    uint32_t shift(0);
+  inline bool operator==(binary_cid const &rhs) const {
+    return _length == rhs._length &&
+           std::memcmp(_bytes.data(), rhs._bytes.data(), _length) == 0;
+  }
+
+private:
+  template <typename NextByte> uint64_t read_varint(NextByte &next_byte) {
     uint64_t result(0);
-    while (true) {
-      uchar = get();
-      if (!(uchar & 0x80)) {
-        result |= (uchar << shift);
-        return result;
-      } else {
-        result |= ((uchar & 0x7F) << shift);
-      }
+    for (uint32_t shift = 0; shift < 64; shift += 7) {
+      if (_length == MaxLength)
+        throw std::invalid_argument("CID too long");
+      uint8_t next(next_byte());
+      _bytes[_length++] = next;
+      result |= static_cast<uint64_t>(next & 0x7F) << shift;
+      if (!(next & 0x80))
+        break;
+    }
+    return result;
+  }
+
+  std::array<uint8_t, MaxLength> _bytes = {};
+  uint8_t _length = 0;
+};
+
+// tail of the multihash is digest output, already well distributed
+struct binary_cid_hash {
+  inline std::size_t operator()(binary_cid const &cid) const {
+    std::size_t result(0);
+    if (cid.length() >= sizeof(result)) {
+      std::memcpy(&result, cid.data() + cid.length() - sizeof(result),
+                  sizeof(result));
     }
+    return result ^ cid.length();
   }
+};
+
+template <typename IteratorType> class cid_decoder {
+public:
+  cid_decoder(IteratorType begin, IteratorType end)
+      : _begin(begin), _end(end) {}
+
+  // decode CID into the platform's display form
+  std::string as_string() { return binary_cid(_begin, _end).to_string(); }
+  binary_cid as_binary() { return binary_cid(_begin, _end); }
+
+private:
   IteratorType _begin;
   IteratorType _end;
-  mutable IteratorType _current;
 };
 
 } // namespace atproto
@@ -20,10 +20,26 @@ http://www.fsf.org/licensing/licenses
 >>> END OF LICENSE >>>
 *************************************************************************/
 #include "yaml-cpp/yaml.h"
+#include <chrono>
 #include <string>
 
 std::string build_db_connection_string(YAML::Node const &config_section);
 
+// value of an optional setting, or fallback if it is not in the section
+template <typename T>
+T setting_or(YAML::Node const &config_section, std::string const &name,
+             T const &fallback) {
+  return config_section[name].IsDefined() ? config_section[name].as<T>()
+                                          : fallback;
+}
+// durations are configured as a count of milliseconds
+inline std::chrono::milliseconds
+setting_or(YAML::Node const &config_section, std::string const &name,
+           const std::chrono::milliseconds fallback) {
+  return std::chrono::milliseconds(
+      setting_or<int64_t>(config_section, name, fallback.count()));
+}
+
 class config {
 public:
   config() = delete;
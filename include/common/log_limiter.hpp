@@ -0,0 +1,134 @@
+#ifndef __log_limiter_hpp__
+#define __log_limiter_hpp__
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Throttle for a single high-volume log call site. Each interval allows a
+// burst of calls through, then lets 1 in N through (if sampling is enabled)
+// and counts the rest as suppressed. The suppressed count is handed back on
+// the next call that is allowed through, sampled or in a later interval, for
+// a summary. Calls within the burst touch only one relaxed atomic - no clock
+// read. Beyond the burst the clock is read only for a sampled call or a
+// window check, which falls on the 1st, 2nd, 4th ... suppressed call of an
+// interval and every ClockCheck calls after that. An expired interval is
+// therefore noticed at the next check, before the suppressed count doubles.
+//
+// Limiters for log call sites enrol in a process-wide list, so that counts
+// not yet reported when a site goes quiet can be logged at shutdown.
+class log_limiter {
+public:
+  typedef std::chrono::steady_clock clock;
+  static constexpr std::chrono::seconds DefaultInterval =
+      std::chrono::seconds(60);
+  static constexpr uint64_t ClockCheck = 64;
+
+  // where the limited log call is, for the shutdown summary
+  struct site {
+    const char *_file;
+    int _line;
+  };
+
+  // sample_one_in == 0 means drop everything beyond the burst
+  constexpr log_limiter(const uint32_t burst, const uint32_t sample_one_in = 0,
+                        const std::chrono::seconds interval = DefaultInterval)
+      : _burst(burst), _sample_one_in(sample_one_in),
+        _interval(std::chrono::duration_cast<clock::duration>(interval)
+                      .count()) {}
+  // enrolled for the shutdown summary, must have static storage duration
+  log_limiter(const uint32_t burst, const uint32_t sample_one_in,
+              site const &where)
+      : log_limiter(burst, sample_one_in) {
+    _where = where;
+    _next = _sites.load(std::memory_order_relaxed);
+    while (!_sites.compare_exchange_weak(_next, this,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+    }
+  }
+
+  // true if the call should be logged. If true, suppressed receives the number
+  // of calls dropped at this site since the last summary.
+  inline bool should_log(uint64_t &suppressed) {
+    suppressed = 0;
+    uint64_t seen(_seen.fetch_add(1, std::memory_order_relaxed));
+    if (seen < _burst)
+      return true;
+
+    const uint64_t over(seen - _burst);
+    const bool sampled(_sample_one_in > 0 && over % _sample_one_in == 0);
+    if (!sampled && (over & (over - 1)) != 0 && over % ClockCheck != 0) {
+      _suppressed.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    // over budget - start a new interval if this one has expired. One thread
+    // wins the roll, others carry on in the old interval.
+    int64_t now(clock::now().time_since_epoch().count());
+    int64_t started(_interval_start.load(std::memory_order_relaxed));
+    if (started == 0) {
+      // first time over budget, interval clock starts now
+      _interval_start.compare_exchange_strong(started, now,
+                                              std::memory_order_relaxed);
+    } else if (now - started >= _interval &&
+               _interval_start.compare_exchange_strong(
+                   started, now, std::memory_order_relaxed)) {
+      _seen.store(1, std::memory_order_relaxed);
+      suppressed = _suppressed.exchange(0, std::memory_order_relaxed);
+      return true;
+    }
+    if (sampled) {
+      suppressed = _suppressed.exchange(0, std::memory_order_relaxed);
+      return true;
+    }
+    _suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  // Calls at each enrolled site dropped since its last summary, which are
+  // then counted as reported. For use at shutdown.
+  template <typename REPORTER> static void report_suppressed(REPORTER report) {
+    for (log_limiter *limiter = _sites.load(std::memory_order_acquire);
+         limiter; limiter = limiter->_next) {
+      const uint64_t suppressed(
+          limiter->_suppressed.exchange(0, std::memory_order_relaxed));
+      if (suppressed > 0) {
+        report(limiter->_where, suppressed);
+      }
+    }
+  }
+
+private:
+  const uint64_t _burst;
+  const uint64_t _sample_one_in;
+  const int64_t _interval;
+  std::atomic<uint64_t> _seen = 0;
+  std::atomic<uint64_t> _suppressed = 0;
+  std::atomic<int64_t> _interval_start = 0;
+  site _where = {nullptr, 0};
+  log_limiter *_next = nullptr;
+
+  static inline std::atomic<log_limiter *> _sites = nullptr;
+};
+
+#endif
@@ -20,9 +20,13 @@ http://www.fsf.org/licensing/licenses
 >>> END OF LICENSE >>>
 *************************************************************************/
 
+#include "common/log_limiter.hpp"
 #include <spdlog/spdlog.h>
 
 extern std::shared_ptr<spdlog::logger> logger;
+bool init_logging(std::string const &log_file, std::string const &project_name,
+                  spdlog::level::level_enum log_level);
+void stop_logging();
 
 // wrappers for spdLog to make release/debug logging easier
 #if DISABLE_LOGGING
@@ -39,6 +43,11 @@ extern std::shared_ptr<spdlog::logger> logger;
 #define REL_WARNING(a_fmt, ...)
 #define REL_ERROR(a_fmt, ...)
 #define REL_CRITICAL(a_fmt, ...)
+
+#define REL_INFO_LIMITED(a_burst, a_sample, a_fmt, ...)
+#define REL_WARNING_LIMITED(a_burst, a_sample, a_fmt, ...)
+#define REL_ERROR_LIMITED(a_burst, a_sample, a_fmt, ...)
+#define REL_INFO_SAMPLED(a_sample, a_fmt, ...)
 #else
 // Debug build only
 #if _DEBUG || defined(_FULL_LOGGING)
@@ -101,9 +110,40 @@ extern std::shared_ptr<spdlog::logger> logger;
     logger->critical(a_fmt __VA_OPT__(, ) __VA_ARGS__);                        \
   }
 
-bool init_logging(std::string const &log_file, std::string const &project_name,
-                  spdlog::level::level_enum log_level);
-void stop_logging();
+// Throttled logging for call sites that can fire once per firehose message.
+// a_burst calls per interval are logged, then 1 in a_sample (0 = none), with a
+// count of what was dropped logged ahead of the next call that gets through,
+// and at shutdown for sites that went quiet. The limiter is a function-local
+// static, so each call site has its own. It is reached only while the level
+// is enabled, so calls made while the level is off are not counted: after a
+// runtime level change the site carries on with the budget and interval it
+// had, which may long since have expired.
+#define REL_LIMITED_IMPL(a_level, a_method, a_burst, a_sample, a_fmt, ...)    \
+  if (logger->level() <= a_level) {                                            \
+    static log_limiter site_limiter(a_burst, a_sample,                         \
+                                    log_limiter::site{__FILE__, __LINE__});    \
+    uint64_t site_suppressed(0);                                               \
+    if (site_limiter.should_log(site_suppressed)) {                            \
+      if (site_suppressed > 0) {                                               \
+        logger->a_method("suppressed {} messages from {}:{}", site_suppressed, \
+                         __FILE__, __LINE__);                                  \
+      }                                                                        \
+      logger->a_method(a_fmt __VA_OPT__(, ) __VA_ARGS__);                      \
+    }                                                                          \
+  }
+#define REL_INFO_LIMITED(a_burst, a_sample, a_fmt, ...)                        \
+  REL_LIMITED_IMPL(spdlog::level::info, info, a_burst, a_sample,               \
+                   a_fmt __VA_OPT__(, ) __VA_ARGS__)
+#define REL_WARNING_LIMITED(a_burst, a_sample, a_fmt, ...)                     \
+  REL_LIMITED_IMPL(spdlog::level::warn, warn, a_burst, a_sample,               \
+                   a_fmt __VA_OPT__(, ) __VA_ARGS__)
+#define REL_ERROR_LIMITED(a_burst, a_sample, a_fmt, ...)                       \
+  REL_LIMITED_IMPL(spdlog::level::err, error, a_burst, a_sample,               \
+                   a_fmt __VA_OPT__(, ) __VA_ARGS__)
+// pure 1-in-N sampling
+#define REL_INFO_SAMPLED(a_sample, a_fmt, ...)                                 \
+  REL_INFO_LIMITED(0, a_sample, a_fmt __VA_OPT__(, ) __VA_ARGS__)
+
 #endif
 
 #endif
\ No newline at end of file
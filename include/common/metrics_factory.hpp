@@ -36,9 +36,13 @@ public:
   void set_config(std::shared_ptr<config> &settings,
                   std::string const &project_name);
 
-  void add_counter(std::string const &name, std::string const &help);
-  void add_gauge(std::string const &name, std::string const &help);
-  void add_histogram(std::string const &name, std::string const &help);
+  // returns the new family, for callers that resolve series up front
+  prometheus::Family<prometheus::Counter> &
+  add_counter(std::string const &name, std::string const &help);
+  prometheus::Family<prometheus::Gauge> &add_gauge(std::string const &name,
+                                                   std::string const &help);
+  prometheus::Family<prometheus::Histogram> &
+  add_histogram(std::string const &name, std::string const &help);
 
   prometheus::Family<prometheus::Counter> &
   get_counter(std::string const &name) const;
@@ -21,6 +21,7 @@ http://www.fsf.org/licensing/licenses
 #include "blockingconcurrentqueue.h"
 #include "common/bluesky/client.hpp"
 #include "common/moderation/ozone_adapter.hpp"
+#include "common/pipeline_timing.hpp"
 
 #include "common/bluesky/platform.hpp"
 #include "yaml-cpp/yaml.h"
@@ -79,10 +80,13 @@ typedef std::variant<no_content, filter_matches, link_redirection,
     report_content;
 struct account_report {
   inline account_report() : _content(no_content()) {}
-  inline account_report(std::string const &did, report_content content)
-      : _did(did), _content(content) {}
+  inline account_report(std::string const &did, report_content content,
+                        pipeline::ingest_time ingested = {})
+      : _did(did), _content(content), _ingested(ingested) {}
   std::string _did;
   report_content _content;
+  // receipt time of the originating firehose frame, if any
+  pipeline::ingest_time _ingested;
 };
 
 class report_agent;
@@ -0,0 +1,82 @@
+#ifndef __pipeline_timing_hpp__
+#define __pipeline_timing_hpp__
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "common/bluesky/platform.hpp"
+#include <prometheus/gauge.h>
+#include <prometheus/histogram.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+
+// Latency of firehose frames and derived work items through the moderation
+// pipeline. Each frame is stamped on receipt from the websocket, and the stamp
+// is copied into every work item derived from it. Each stage observes elapsed
+// time when it dequeues the item.
+namespace pipeline {
+
+typedef std::chrono::steady_clock clock;
+// default-constructed value means the item did not originate from a frame
+typedef clock::time_point ingest_time;
+
+enum class stage : size_t {
+  post_processor = 0,
+  event_recorder,
+  action_router,
+  report_agent,
+  list_manager,
+  max_stage
+};
+
+class stage_timer {
+public:
+  static stage_timer &instance();
+
+  // Registers histogram and gauge, stage observation is a no-op until done
+  void register_metrics();
+
+  inline static ingest_time now() { return clock::now(); }
+  void record(const stage this_stage, const ingest_time ingested);
+  // firehose lag is observed from the message time on the post-processor
+  // thread, or from time_us as Jetstream frames are decoded. Other components
+  // can read the most recent value.
+  void record_lag(const bsky::time_stamp emitted_at);
+  inline std::chrono::milliseconds lag() const {
+    return std::chrono::milliseconds(_lag_ms.load(std::memory_order_relaxed));
+  }
+
+private:
+  stage_timer() = default;
+  ~stage_timer() = default;
+
+  // bucket boundaries in milliseconds. report_agent and list_manager are rate
+  // limited so long tail is expected there.
+  static const prometheus::Histogram::BucketBoundaries LatencyBuckets;
+
+  // one series per stage, indexed by stage
+  std::array<prometheus::Histogram *, static_cast<size_t>(stage::max_stage)>
+      _latency = {};
+  prometheus::Gauge *_lag = nullptr;
+  std::atomic<int64_t> _lag_ms = 0;
+};
+
+} // namespace pipeline
+#endif
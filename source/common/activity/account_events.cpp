@@ -36,10 +36,18 @@ BOOST_FUSION_ADAPT_STRUCT(
     (unsigned short, _updates), (unsigned short, _activations),
     (unsigned short, _profiles), (unsigned short, _handles), (size_t, _unposts),
     (size_t, _unlikes), (size_t, _unreposts), (size_t, _unfollows),
-    (size_t, _unblocks), (unsigned short, _matches))
+    (size_t, _unblocks), (size_t, _follow_churn), (size_t, _like_churn),
+    (unsigned short, _matches),
+    (size_t, _near_duplicates), (size_t, _coordinated))
 
 namespace activity {
 
+namespace {
+// threshold alerts are per-account and can arrive in storms during pile-ons
+constexpr uint32_t AlertLogBurst = 50;
+constexpr uint32_t AlertLogSample = 20;
+} // namespace
+
 account::account(did_type const &did)
     : _content_hits(std::make_shared<
                     lfu_cache_at_uri_t<atproto::at_uri, content_hit_count>>(
@@ -54,7 +62,9 @@ account::account(did_type const &did)
 void account::statistics::tags(const size_t count) {
   if (count > activity::account::TagFacetThreshold) {
     if (alert_needed(++_tags, FacetFactor)) {
-      REL_INFO("Account flagged tag-facets {}/() {}", _did, _handle, _tags);
+      REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                       "Account flagged tag-facets {}/() {}", _did, _handle,
+                       _tags);
       metrics_factory::instance()
           .get_counter("realtime_alerts")
           .Get({{"account", "tag_facets"}})
@@ -66,7 +76,9 @@ void account::statistics::tags(const size_t count) {
 void account::statistics::links(const size_t count) {
   if (count > activity::account::LinkFacetThreshold) {
     if (alert_needed(++_links, FacetFactor)) {
-      REL_INFO("Account flagged link-facets {}/{} {}", _did, _handle, _links);
+      REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                       "Account flagged link-facets {}/{} {}", _did, _handle,
+                       _links);
       metrics_factory::instance()
           .get_counter("realtime_alerts")
           .Get({{"account", "link_facets"}})
@@ -78,8 +90,9 @@ void account::statistics::links(const size_t count) {
 void account::statistics::mentions(const size_t count) {
   if (count > activity::account::MentionFacetThreshold) {
     if (alert_needed(++_mentions, FacetFactor)) {
-      REL_INFO("Account flagged mention-facets {}/{} {}", _did, _handle,
-               _mentions);
+      REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                       "Account flagged mention-facets {}/{} {}", _did, _handle,
+                       _mentions);
       metrics_factory::instance()
           .get_counter("realtime_alerts")
           .Get({{"account", "mention_facets"}})
@@ -91,7 +104,9 @@ void account::statistics::mentions(const size_t count) {
 void account::statistics::facets(const size_t count) {
   if (count > activity::account::TotalFacetThreshold) {
     if (alert_needed(++_facets, FacetFactor)) {
-      REL_INFO("Account flagged total-facets {}/{} {}", _did, _handle, _facets);
+      REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                       "Account flagged total-facets {}/{} {}", _did, _handle,
+                       _facets);
       metrics_factory::instance()
           .get_counter("realtime_alerts")
           .Get({{"account", "all_facets"}})
@@ -103,11 +118,13 @@ void account::statistics::facets(const size_t count) {
 
 void account::statistics::record(event_cache &parent_cache,
                                  timed_event const &event) {
-  std::visit(augment_account_event(parent_cache, *this), event._event);
+  std::visit(augment_account_event(parent_cache, *this, event._created_at),
+             event._event);
   if (alert_needed(++_event_count, EventFactor)) {
     std::ostringstream oss;
     restc_cpp::SerializeToJson(*this, oss);
-    REL_INFO("Account flagged events: {}", oss.str());
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged events: {}", oss.str());
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "event_volume"}})
@@ -124,7 +141,8 @@ void account::statistics::alert() {
   if (alert_needed(++_alert_count, AlertFactor)) {
     std::ostringstream oss;
     restc_cpp::SerializeToJson(*this, oss);
-    REL_INFO("Account flagged alerts: {}", oss.str());
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged alerts: {}", oss.str());
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "alerts"}})
@@ -134,7 +152,8 @@ void account::statistics::alert() {
 
 void account::statistics::post(atproto::at_uri const &) {
   if (alert_needed(++_posts, PostFactor)) {
-    REL_INFO("Account flagged posts {}/{} {}", _did, _handle, _posts);
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged posts {}/{} {}", _did, _handle, _posts);
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "posts"}})
@@ -145,7 +164,9 @@ void account::statistics::post(atproto::at_uri const &) {
 
 void account::statistics::replied_to() {
   if (alert_needed(++_replied_to, RepliedToFactor)) {
-    REL_INFO("Account flagged replied-to {}/{} {}", _did, _handle, _replied_to);
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged replied-to {}/{} {}", _did, _handle,
+                     _replied_to);
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "replied_to"}})
@@ -155,7 +176,9 @@ void account::statistics::replied_to() {
 }
 void account::statistics::reply() {
   if (alert_needed(++_replies, ReplyFactor)) {
-    REL_INFO("Account flagged replies {}/{} {}", _did, _handle, _replies);
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged replies {}/{} {}", _did, _handle,
+                     _replies);
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "replies"}})
@@ -165,7 +188,8 @@ void account::statistics::reply() {
 }
 void account::statistics::quoted() {
   if (alert_needed(++_quoted, QuotedFactor)) {
-    REL_INFO("Account flagged quoted {}/{} {}", _did, _handle, _quoted);
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged quoted {}/{} {}", _did, _handle, _quoted);
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "quoted"}})
@@ -175,7 +199,8 @@ void account::statistics::quoted() {
 }
 void account::statistics::quote() {
   if (alert_needed(++_quotes, QuoteFactor)) {
-    REL_INFO("Account flagged quotes {}/{} {}", _did, _handle, _quotes);
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged quotes {}/{} {}", _did, _handle, _quotes);
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "quotes"}})
@@ -184,9 +209,10 @@ void account::statistics::quote() {
   }
 }
 void account::statistics::reposted() {
-  ++_reposted;
   if (alert_needed(++_reposted, RepostedFactor)) {
-    REL_INFO("Account flagged reposted {}/{} {}", _did, _handle, _reposted);
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged reposted {}/{} {}", _did, _handle,
+                     _reposted);
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "reposted"}})
@@ -196,7 +222,9 @@ void account::statistics::reposted() {
 }
 void account::statistics::repost() {
   if (alert_needed(++_reposts, RepostFactor)) {
-    REL_INFO("Account flagged reposts {}/{} {}", _did, _handle, _reposts);
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged reposts {}/{} {}", _did, _handle,
+                     _reposts);
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "reposts"}})
@@ -206,7 +234,8 @@ void account::statistics::repost() {
 }
 void account::statistics::liked() {
   if (alert_needed(++_liked, LikedFactor)) {
-    REL_INFO("Account flagged liked {}/{} {}", _did, _handle, _liked);
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged liked {}/{} {}", _did, _handle, _liked);
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "liked"}})
@@ -216,7 +245,8 @@ void account::statistics::liked() {
 }
 void account::statistics::like() {
   if (alert_needed(++_likes, LikeFactor)) {
-    REL_INFO("Account flagged likes {}/{} {}", _did, _handle, _likes);
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged likes {}/{} {}", _did, _handle, _likes);
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "likes"}})
@@ -269,13 +299,22 @@ account::get_content_item(const atproto::at_uri &uri) {
   return content_hits;
 }
 
+caches::WrappedValue<content_hit_count>
+account::find_content_item(atproto::at_uri const &uri) {
+  if (!_content_hits->Cached(uri))
+    return {};
+  return _content_hits->Get(uri);
+}
+
 // toxic string filter matches, flag verbose accounts
 void account::statistics::add_matches(const unsigned short matches) {
   size_t old_matches(_matches);
   _matches += matches;
   if ((old_matches == 0) ||
       (old_matches / MatchFactor != _matches / MatchFactor)) {
-    REL_INFO("Account flagged matches {}/{} {}", _did, _handle, _matches);
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged matches {}/{} {}", _did, _handle,
+                     _matches);
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "match_alert"}})
@@ -284,15 +323,43 @@ void account::statistics::add_matches(const unsigned short matches) {
   }
 }
 
+// posted into a near-duplicate cluster, the detector has already applied
+// its threshold so every one counts
+void account::statistics::near_duplicate(const unsigned short accounts) {
+  ++_near_duplicates;
+  REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                   "Account flagged near-duplicate {}/{} cluster {} total {}",
+                   _did, _handle, accounts, _near_duplicates);
+  metrics_factory::instance()
+      .get_counter("realtime_alerts")
+      .Get({{"account", "near_duplicate"}})
+      .Increment();
+  alert();
+}
+
+// one of a coordinated group, the detector has already applied its threshold
+void account::statistics::coordinated(const unsigned short targets) {
+  ++_coordinated;
+  REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                   "Account flagged coordinated {}/{} targets {} total {}",
+                   _did, _handle, targets, _coordinated);
+  metrics_factory::instance()
+      .get_counter("realtime_alerts")
+      .Get({{"account", "coordinated"}})
+      .Increment();
+  alert();
+}
+
 // account-level updates - flag if frequent
 void account::statistics::updated() {
   size_t old_updates(_updates);
   ++_updates;
   if (old_updates / UpdateFactor != _updates / UpdateFactor) {
-    REL_INFO("Account flagged updates {}/{} {} profile={}, handle={}, "
-             "(in)activation={}, active-state={}",
-             _did, _handle, _updates, _profiles, _handles, _activations,
-             to_string(_state));
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged updates {}/{} {} profile={}, handle={}, "
+                     "(in)activation={}, active-state={}",
+                     _did, _handle, _updates, _profiles, _handles, _activations,
+                     to_string(_state));
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "updates"}})
@@ -305,8 +372,9 @@ void account::statistics::activation(const bool active) {
   size_t old_activations(_activations);
   ++_activations;
   if (old_activations / UpdateFactor != _activations / UpdateFactor) {
-    REL_INFO("Account flagged activations {}/{} {}", _did, _handle,
-             _activations);
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged activations {}/{} {}", _did, _handle,
+                     _activations);
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "activations"}})
@@ -319,7 +387,9 @@ void account::statistics::handle() {
   size_t old_handles(_handles);
   ++_handles;
   if (old_handles / UpdateFactor != _handles / UpdateFactor) {
-    REL_INFO("Account flagged handles {}/{} {}", _did, _handle, _handles);
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged handles {}/{} {}", _did, _handle,
+                     _handles);
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "handles"}})
@@ -332,7 +402,9 @@ void account::statistics::profile() {
   size_t old_profiles(_profiles);
   ++_profiles;
   if (old_profiles / UpdateFactor != _profiles / UpdateFactor) {
-    REL_INFO("Account flagged profiles {}/{} {}", _did, _handle, _profiles);
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged profiles {}/{} {}", _did, _handle,
+                     _profiles);
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "profiles"}})
@@ -342,7 +414,9 @@ void account::statistics::profile() {
   updated();
 }
 
-// TODO unwind content in the account's cache that gets deleted
+// TODO unwind posts in the account's cache that get deleted. Likes, reposts,
+// follows and blocks are undone by augment_target_event if the subject is
+// known.
 void account::statistics::deleted(std::string const &path) {
   if (starts_with(path, bsky::AppBskyFeedLike)) {
     ++_unlikes;
@@ -360,10 +434,11 @@ void account::statistics::deleted(std::string const &path) {
   }
   size_t deletes(_unlikes + _unposts + _unreposts + _unblocks + _unfollows);
   if ((deletes - 1) / DeleteFactor != deletes / DeleteFactor) {
-    REL_INFO("Account flagged deletes {}/{} {} likes {} posts {} reposts {} "
-             "blocks {} follows",
-             _did, _handle, _unlikes, _unposts, _unreposts, _unblocks,
-             _unfollows);
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged deletes {}/{} {} likes {} posts {} "
+                     "reposts {} blocks {} follows",
+                     _did, _handle, _unlikes, _unposts, _unreposts, _unblocks,
+                     _unfollows);
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "deletes"}})
@@ -372,9 +447,38 @@ void account::statistics::deleted(std::string const &path) {
   }
 }
 
+// record undone soon after it was created, the shape of follow-back farming
+// and like cycling
+void account::statistics::churned(std::string const &path) {
+  if (starts_with(path, bsky::AppBskyGraphFollow)) {
+    if (alert_needed(++_follow_churn, FollowChurnFactor)) {
+      REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                       "Account flagged follow-churn {}/{} {}", _did, _handle,
+                       _follow_churn);
+      metrics_factory::instance()
+          .get_counter("realtime_alerts")
+          .Get({{"account", "follow_churn"}})
+          .Increment();
+      alert();
+    }
+  } else if (starts_with(path, bsky::AppBskyFeedLike)) {
+    if (alert_needed(++_like_churn, LikeChurnFactor)) {
+      REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                       "Account flagged like-churn {}/{} {}", _did, _handle,
+                       _like_churn);
+      metrics_factory::instance()
+          .get_counter("realtime_alerts")
+          .Get({{"account", "like_churn"}})
+          .Increment();
+      alert();
+    }
+  }
+}
+
 void account::statistics::blocks() {
   if (alert_needed(++_blocks, BlocksFactor)) {
-    REL_INFO("Account flagged blocks {}/{} {}", _did, _handle, _blocks);
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged blocks {}/{} {}", _did, _handle, _blocks);
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "blocks"}})
@@ -384,7 +488,9 @@ void account::statistics::blocks() {
 }
 void account::statistics::blocked_by() {
   if (alert_needed(++_blocked_by, BlockedByFactor)) {
-    REL_INFO("Account flagged blocked-by {}/{} {}", _did, _handle, _blocked_by);
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged blocked-by {}/{} {}", _did, _handle,
+                     _blocked_by);
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "blocked_by"}})
@@ -394,7 +500,9 @@ void account::statistics::blocked_by() {
 }
 void account::statistics::follows() {
   if (alert_needed(++_follows, FollowsFactor)) {
-    REL_INFO("Account flagged follows {}/{} {}", _did, _handle, _follows);
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged follows {}/{} {}", _did, _handle,
+                     _follows);
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "follows"}})
@@ -404,8 +512,9 @@ void account::statistics::follows() {
 }
 void account::statistics::followed_by() {
   if (alert_needed(++_followed_by, FollowedByFactor)) {
-    REL_INFO("Account flagged followed-by {}/{} {}", _did, _handle,
-             _followed_by);
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged followed-by {}/{} {}", _did, _handle,
+                     _followed_by);
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "followed_by"}})
@@ -415,8 +524,13 @@ void account::statistics::followed_by() {
 }
 
 augment_account_event::augment_account_event(event_cache &cache,
-                                             account::statistics &stats)
-    : _stats(stats), _cache(cache) {}
+                                             account::statistics &stats,
+                                             const bsky::time_stamp when)
+    : _stats(stats), _cache(cache), _when(when) {}
+
+bool augment_account_event::low_history() const {
+  return pile_on_detector::instance().low_history(_stats._event_count, _when);
+}
 
 void augment_account_event::augment_account_event::operator()(
     activity::post const &value) {
@@ -426,40 +540,24 @@ void augment_account_event::augment_account_event::operator()(
 void augment_account_event::augment_account_event::operator()(
     activity::reply const &value) {
   // record interactions with parent/root
-  reply_to(value._parent);
-  reply_to(value._root);
+  augment_target_event target(_cache, _stats._did, low_history(), _when);
+  target(value);
   _stats.reply();
 }
 void augment_account_event::augment_account_event::operator()(
     activity::repost const &value) {
-  auto post_account(_cache.get_account(value._post._authority));
-  post_account->get_statistics().reposted();
-  auto content(post_account->get_content_item(value._post));
-  if (alert_needed(++content->_reposts, account::ContentRepostFactor)) {
-    content->alert();
-    REL_INFO("Account flagged content-reposts {}/{} {}", value._post._authority,
-             post_account->get_statistics()._handle, content->_reposts);
-    metrics_factory::instance()
-        .get_counter("realtime_alerts")
-        .Get({{"account", "content-reposts"}})
-        .Increment();
+  augment_target_event target(_cache, _stats._did, low_history(), _when);
+  target(value);
+  if (target.alerted()) {
     _stats.alert();
   }
   _stats.repost();
 }
 void augment_account_event::augment_account_event::operator()(
     activity::quote const &value) {
-  auto post_account(_cache.get_account(value._post._authority));
-  post_account->get_statistics().quoted();
-  auto content(post_account->get_content_item(value._post));
-  if (alert_needed(++content->_quotes, account::ContentQuoteFactor)) {
-    content->alert();
-    REL_INFO("Account flagged content-quotes {}/{} {}", value._post._authority,
-             post_account->get_statistics()._handle, content->_quotes);
-    metrics_factory::instance()
-        .get_counter("realtime_alerts")
-        .Get({{"account", "content-quotes"}})
-        .Increment();
+  augment_target_event target(_cache, _stats._did, low_history(), _when);
+  target(value);
+  if (target.alerted()) {
     _stats.alert();
   }
   _stats.quote();
@@ -468,8 +566,8 @@ void augment_account_event::augment_account_event::operator()(
 void augment_account_event::augment_account_event::operator()(
     activity::block const &value) {
   _stats.blocks();
-  auto target(_cache.get_account(value._blocked));
-  target->get_statistics().blocked_by();
+  augment_target_event target(_cache, _stats._did, low_history(), _when);
+  target(value);
   // report and label if account blocked moderation service
   if (value._blocked ==
       bsky::moderation::report_agent::instance().service_did()) {
@@ -481,24 +579,15 @@ void augment_account_event::augment_account_event::operator()(
 void augment_account_event::augment_account_event::operator()(
     activity::follow const &value) {
   _stats.follows();
-  auto target(_cache.get_account(value._followed));
-  target->get_statistics().followed_by();
+  augment_target_event target(_cache, _stats._did, low_history(), _when);
+  target(value);
 }
 
 void augment_account_event::augment_account_event::operator()(
     activity::like const &value) {
-  auto liked_account(_cache.get_account(value._content._authority));
-  liked_account->get_statistics().liked();
-  auto content(liked_account->get_content_item(value._content));
-  if (alert_needed(++content->_likes, account::ContentLikeFactor)) {
-    content->alert();
-    REL_INFO("Account flagged content-likes {}/{} {}",
-             value._content._authority, liked_account->get_statistics()._handle,
-             content->_likes);
-    metrics_factory::instance()
-        .get_counter("realtime_alerts")
-        .Get({{"account", "content-likes"}})
-        .Increment();
+  augment_target_event target(_cache, _stats._did, low_history(), _when);
+  target(value);
+  if (target.alerted()) {
     _stats.alert();
   }
   _stats.like();
@@ -524,6 +613,13 @@ void augment_account_event::augment_account_event::operator()(
 void augment_account_event::augment_account_event::operator()(
     activity::deleted const &value) {
   _stats.deleted(value._path);
+  if (value._subject.empty())
+    return;
+  augment_target_event target(_cache, _stats._did, low_history(), _when);
+  target(value);
+  if (value._lifetime < account::ChurnWindow) {
+    _stats.churned(value._path);
+  }
 }
 
 void augment_account_event::augment_account_event::operator()(
@@ -544,15 +640,174 @@ void augment_account_event::operator()(activity::facets const &value) {
   _stats.facets(value._tags + value._mentions + value._links);
 }
 
-void augment_account_event::augment_account_event::reply_to(
-    atproto::at_uri const &uri) {
+void augment_account_event::operator()(
+    activity::near_duplicate const &value) {
+  _stats.near_duplicate(value._accounts);
+}
+
+void augment_account_event::operator()(activity::coordinated const &value) {
+  _stats.coordinated(value._targets);
+}
+
+augment_target_event::augment_target_event(event_cache &cache,
+                                           did_type const &actor,
+                                           const bool low_history,
+                                           const bsky::time_stamp when)
+    : _cache(cache), _actor(actor), _low_history(low_history), _when(when) {}
+
+void augment_target_event::operator()(activity::reply const &value) {
+  reply_to(value._parent);
+  reply_to(value._root);
+  // a direct reply has the same parent and root, count it once
+  reply_pile_on(value._parent);
+  if (!(value._root == value._parent)) {
+    reply_pile_on(value._root);
+  }
+}
+
+void augment_target_event::operator()(activity::repost const &value) {
+  if (!_cache.is_local(value._post._authority))
+    return;
+  auto post_account(_cache.get_account(value._post._authority));
+  post_account->get_statistics().reposted();
+  auto content(post_account->get_content_item(value._post));
+  if (alert_needed(++content->_reposts, account::ContentRepostFactor)) {
+    content->alert();
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged content-reposts {}/{} {}",
+                     value._post._authority,
+                     post_account->get_statistics()._handle, content->_reposts);
+    metrics_factory::instance()
+        .get_counter("realtime_alerts")
+        .Get({{"account", "content-reposts"}})
+        .Increment();
+    _alerted = true;
+  }
+}
+
+void augment_target_event::operator()(activity::quote const &value) {
+  if (!_cache.is_local(value._post._authority))
+    return;
+  auto post_account(_cache.get_account(value._post._authority));
+  post_account->get_statistics().quoted();
+  auto content(post_account->get_content_item(value._post));
+  if (alert_needed(++content->_quotes, account::ContentQuoteFactor)) {
+    content->alert();
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged content-quotes {}/{} {}",
+                     value._post._authority,
+                     post_account->get_statistics()._handle, content->_quotes);
+    metrics_factory::instance()
+        .get_counter("realtime_alerts")
+        .Get({{"account", "content-quotes"}})
+        .Increment();
+    _alerted = true;
+  }
+  // the post is marked, its author is on the receiving end
+  if (pile_on_detector::instance().quote(value._post, _actor, _low_history,
+                                         _when)) {
+    content->alert();
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged quote pile-on {}/{} {}",
+                     value._post._authority,
+                     post_account->get_statistics()._handle,
+                     std::string(value._post));
+    metrics_factory::instance()
+        .get_counter("realtime_alerts")
+        .Get({{"account", "quote-pile-on"}})
+        .Increment();
+  }
+}
+
+void augment_target_event::operator()(activity::block const &value) {
+  if (!_cache.is_local(value._blocked))
+    return;
+  auto target(_cache.get_account(value._blocked));
+  target->get_statistics().blocked_by();
+}
+
+void augment_target_event::operator()(activity::follow const &value) {
+  if (!_cache.is_local(value._followed))
+    return;
+  auto target(_cache.get_account(value._followed));
+  target->get_statistics().followed_by();
+}
+
+void augment_target_event::operator()(activity::like const &value) {
+  if (!_cache.is_local(value._content._authority))
+    return;
+  auto liked_account(_cache.get_account(value._content._authority));
+  liked_account->get_statistics().liked();
+  auto content(liked_account->get_content_item(value._content));
+  if (alert_needed(++content->_likes, account::ContentLikeFactor)) {
+    content->alert();
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged content-likes {}/{} {}",
+                     value._content._authority,
+                     liked_account->get_statistics()._handle, content->_likes);
+    metrics_factory::instance()
+        .get_counter("realtime_alerts")
+        .Get({{"account", "content-likes"}})
+        .Increment();
+    _alerted = true;
+  }
+}
+
+// Undo only what is still cached, a subject evicted or never seen here has
+// nothing to undo and must not be brought back by the delete.
+void augment_target_event::operator()(activity::deleted const &value) {
+  if (starts_with(value._path, bsky::AppBskyFeedLike)) {
+    atproto::at_uri const content_uri(value._subject);
+    if (!_cache.is_local(content_uri._authority))
+      return;
+    auto liked_account(_cache.find_account(content_uri._authority));
+    if (!liked_account)
+      return;
+    liked_account->get_statistics().unliked();
+    auto content(liked_account->find_content_item(content_uri));
+    if (content && content->_likes > 0) {
+      --content->_likes;
+    }
+  } else if (starts_with(value._path, bsky::AppBskyFeedRepost)) {
+    atproto::at_uri const content_uri(value._subject);
+    if (!_cache.is_local(content_uri._authority))
+      return;
+    auto post_account(_cache.find_account(content_uri._authority));
+    if (!post_account)
+      return;
+    post_account->get_statistics().unreposted();
+    auto content(post_account->find_content_item(content_uri));
+    if (content && content->_reposts > 0) {
+      --content->_reposts;
+    }
+  } else if (starts_with(value._path, bsky::AppBskyGraphFollow)) {
+    if (!_cache.is_local(value._subject))
+      return;
+    auto target(_cache.find_account(value._subject));
+    if (target) {
+      target->get_statistics().unfollowed_by();
+    }
+  } else if (starts_with(value._path, bsky::AppBskyGraphBlock)) {
+    if (!_cache.is_local(value._subject))
+      return;
+    auto target(_cache.find_account(value._subject));
+    if (target) {
+      target->get_statistics().unblocked_by();
+    }
+  }
+}
+
+void augment_target_event::reply_to(atproto::at_uri const &uri) {
+  if (!_cache.is_local(uri._authority))
+    return;
   auto account(_cache.get_account(uri._authority));
   account->get_statistics().replied_to();
   auto content(account->get_content_item(uri));
   if (alert_needed(++content->_replies, account::ContentReplyFactor)) {
     content->alert();
-    REL_INFO("Account flagged content-replies {}/{} {}", uri._authority,
-             account->get_statistics()._handle, content->_replies);
+    REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                     "Account flagged content-replies {}/{} {}", uri._authority,
+                     account->get_statistics()._handle, content->_replies);
     metrics_factory::instance()
         .get_counter("realtime_alerts")
         .Get({{"account", "content-replies"}})
@@ -561,4 +816,22 @@ void augment_account_event::augment_account_event::reply_to(
   }
 }
 
+// many replies from many accounts, often new ones, in a short time
+void augment_target_event::reply_pile_on(atproto::at_uri const &uri) {
+  if (!_cache.is_local(uri._authority))
+    return;
+  if (!pile_on_detector::instance().reply(uri, _actor, _low_history, _when))
+    return;
+  // the post is marked, its author is on the receiving end
+  auto account(_cache.get_account(uri._authority));
+  account->get_content_item(uri)->alert();
+  REL_INFO_LIMITED(AlertLogBurst, AlertLogSample,
+                   "Account flagged reply pile-on {}/{} {}", uri._authority,
+                   account->get_statistics()._handle, std::string(uri));
+  metrics_factory::instance()
+      .get_counter("realtime_alerts")
+      .Get({{"account", "reply-pile-on"}})
+      .Increment();
+}
+
 } // namespace activity
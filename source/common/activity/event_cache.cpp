@@ -19,6 +19,7 @@ http://www.fsf.org/licensing/licenses
 *************************************************************************/
 
 #include "common/activity/event_recorder.hpp"
+#include "common/alloc_stats.hpp"
 #include "common/metrics_factory.hpp"
 #include <functional>
 
@@ -33,12 +34,36 @@ event_cache::event_cache()
                         std::placeholders::_2))) {}
 
 void event_cache::record(timed_event const &value) {
+  alloc_stats::scope allocations(alloc_stats::stage::event_cache);
+  if (value._forwarded) {
+    metrics_factory::instance()
+        .get_counter("realtime_alerts")
+        .Get({{"events", "forwarded"}})
+        .Increment();
+    if (std::holds_alternative<target_alert>(value._event)) {
+      // the target is owned elsewhere, the actor is ours
+      get_account(value._did)->get_statistics().alert();
+      return;
+    }
+    augment_target_event target(*this, value._did, value._low_history,
+                                value._created_at);
+    std::visit(target, value._event);
+    if (target.alerted() && _alert_actor) {
+      _alert_actor(value._did);
+    }
+    return;
+  }
   metrics_factory::instance()
       .get_counter("realtime_alerts")
       .Get({{"events", "total"}})
       .Increment();
   // look up the account, add if not known yet
   caches::WrappedValue<account> source(get_account(value._did));
+  if (_forward) {
+    // history as it was before this event, as the local targets see it
+    _forward(value, pile_on_detector::instance().low_history(
+                        source->event_count(), value._created_at));
+  }
   source->record(*this, value);
 
   std::visit(augment_event{}, value._event);
@@ -56,6 +81,14 @@ caches::WrappedValue<account> event_cache::get_account(std::string const &did) {
   return _account_events.Get(did);
 }
 
+caches::WrappedValue<account>
+event_cache::find_account(std::string const &did) {
+  std::lock_guard guard(_cache_lock);
+  if (!_account_events.Cached(did))
+    return {};
+  return _account_events.Get(did);
+}
+
 // Callback for tracked account removal
 void event_cache::on_erase(std::string const &did,
                            caches::WrappedValue<account> const &account) {
@@ -34,6 +34,8 @@ event_recorder::event_recorder() : _queue(MaxBacklog) {
           .get_gauge("process_operation")
           .Get({{"events", "backlog"}})
           .Decrement();
+      pipeline::stage_timer::instance().record(pipeline::stage::event_recorder,
+                                               my_payload._ingested);
 
       // record the activity
       _events.record(my_payload);
@@ -0,0 +1,133 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "common/activity/pile_on.hpp"
+#include "common/config.hpp"
+#include "common/log_wrapper.hpp"
+#include "common/metrics_factory.hpp"
+#include <functional>
+#include <stdexcept>
+
+namespace activity {
+
+pile_on_detector &pile_on_detector::instance() {
+  static pile_on_detector my_instance;
+  return my_instance;
+}
+
+void pile_on_detector::set_config(YAML::Node const &settings) {
+  if (!settings.IsDefined())
+    return;
+  const std::chrono::milliseconds window(
+      setting_or(settings, "window_ms", std::chrono::milliseconds(600000)));
+  const size_t targets(setting_or<size_t>(settings, "targets", 65536));
+  const size_t min_rate(setting_or<size_t>(settings, "min_rate", 50));
+  const size_t min_distinct(setting_or<size_t>(settings, "min_distinct", 30));
+  const double min_low_history_share(
+      setting_or(settings, "min_low_history_share", 0.5));
+  const size_t low_history_events(
+      setting_or(settings, "low_history_events", _low_history_events));
+  const std::chrono::milliseconds warm_up(
+      setting_or(settings, "warm_up_ms", std::chrono::milliseconds(3600000)));
+  if (window.count() <= 0 || targets < 2 || min_rate == 0 ||
+      min_low_history_share < 0.0 || min_low_history_share > 1.0 ||
+      warm_up.count() < 0) {
+    throw std::invalid_argument(
+        "pile_on needs window_ms > 0, targets >= 2, min_rate > 0, "
+        "min_low_history_share in [0, 1] and warm_up_ms >= 0");
+  }
+  _low_history_events = low_history_events;
+  _warm_up = warm_up;
+  _warm_from.reset();
+  // replies are far more common than quotes, share the table between them
+  const size_t quote_targets(std::max<size_t>(2, targets / 4));
+  _replies = std::make_unique<pile_on_tracker>(
+      window, targets - quote_targets, min_rate, min_distinct,
+      min_low_history_share);
+  _quotes = std::make_unique<pile_on_tracker>(
+      window, quote_targets, min_rate, min_distinct, min_low_history_share);
+  REL_INFO("Pile-on detection: {} interactions from {} accounts within {} ms, "
+           "{:.2f} low-history after {} ms warm-up, {} targets",
+           min_rate, min_distinct, window.count(), min_low_history_share,
+           warm_up.count(), targets);
+}
+
+void pile_on_detector::register_metrics() {
+  auto &outcomes(metrics_factory::instance().add_counter(
+      "pile_on", "Reply and quote pile-on detection by outcome"));
+  _observed = &outcomes.Add({{"interaction", "observed"}});
+  _low_history = &outcomes.Add({{"interaction", "low_history"}});
+  _evicted = &outcomes.Add({{"target", "evicted"}});
+}
+
+bool pile_on_detector::low_history(const size_t actor_events,
+                                   const bsky::time_stamp when) {
+  if (!_replies)
+    return false;
+  if (!_warm_from) {
+    _warm_from = when + _warm_up;
+  }
+  return actor_events < _low_history_events && when >= *_warm_from;
+}
+
+bool pile_on_detector::reply(atproto::at_uri const &target,
+                             std::string const &actor,
+                             const bool low_history,
+                             const bsky::time_stamp when) {
+  if (!_replies)
+    return false;
+  return observe(*_replies, "reply", target, actor, low_history, when);
+}
+
+bool pile_on_detector::quote(atproto::at_uri const &target,
+                             std::string const &actor,
+                             const bool low_history,
+                             const bsky::time_stamp when) {
+  if (!_quotes)
+    return false;
+  return observe(*_quotes, "quote", target, actor, low_history, when);
+}
+
+bool pile_on_detector::observe(pile_on_tracker &tracker,
+                               std::string_view kind,
+                               atproto::at_uri const &target,
+                               std::string const &actor,
+                               const bool low_history,
+                               const bsky::time_stamp when) {
+  auto result(tracker.observe(atproto::at_uri_hash()(target),
+                              std::hash<std::string>()(actor), low_history,
+                              when));
+  if (_observed) {
+    _observed->Increment();
+    if (low_history)
+      _low_history->Increment();
+    const size_t evicted(_replies->evicted() + _quotes->evicted());
+    _evicted->Increment(static_cast<double>(evicted - _evicted_reported));
+    _evicted_reported = evicted;
+  }
+  if (result._alert) {
+    REL_INFO("Pile-on {} {} rate {:.0f} distinct {:.0f} low-history {:.2f}",
+             kind, std::string(target), result._rate, result._distinct,
+             result._low_history_share);
+  }
+  return result._alert;
+}
+
+} // namespace activity
@@ -0,0 +1,68 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "common/alloc_stats.hpp"
+#include "common/metrics_factory.hpp"
+
+namespace alloc_stats {
+
+// constant-initialized so it is safe to touch from operator new on any thread
+thread_local thread_totals totals = {0, 0};
+
+const prometheus::Histogram::BucketBoundaries recorder::AllocationBuckets = {
+    0, 1, 2, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 10000};
+const prometheus::Histogram::BucketBoundaries recorder::ByteBuckets = {
+    0,     64,     256,    1024,   4096,    16384,
+    65536, 262144, 1048576, 4194304, 16777216};
+
+recorder &recorder::instance() {
+  static recorder my_instance;
+  return my_instance;
+}
+
+void recorder::register_metrics() {
+  metrics_factory::instance().add_histogram(
+      "message_allocations", "Heap allocations per message by pipeline stage");
+  metrics_factory::instance().add_histogram(
+      "message_allocated_bytes",
+      "Heap bytes allocated per message by pipeline stage");
+  auto &allocations(
+      metrics_factory::instance().get_histogram("message_allocations"));
+  auto &bytes(
+      metrics_factory::instance().get_histogram("message_allocated_bytes"));
+  constexpr std::array<const char *, static_cast<size_t>(stage::max_stage)>
+      labels = {"content_handler", "firehose_payload", "event_cache"};
+  for (size_t index = 0; index < labels.size(); ++index) {
+    _allocations[index] =
+        &allocations.Add({{"stage", labels[index]}}, AllocationBuckets);
+    _bytes[index] = &bytes.Add({{"stage", labels[index]}}, ByteBuckets);
+  }
+}
+
+void recorder::record(const stage this_stage, const uint64_t allocations,
+                      const uint64_t bytes) {
+  const size_t index(static_cast<size_t>(this_stage));
+  if (!_allocations[index])
+    return;
+  _allocations[index]->Observe(static_cast<double>(allocations));
+  _bytes[index]->Observe(static_cast<double>(bytes));
+}
+
+} // namespace alloc_stats
@@ -90,8 +90,104 @@ embed_type embed_type_from_string(std::string_view embed_type_str) {
   return embed_type::invalid;
 }
 
-// Parse ISO8601 time permissively
+namespace {
+// fixed-width decimal field, false if any character is not a digit
+template <size_t Width>
+inline bool parse_digits(const char *text, unsigned &value) {
+  value = 0;
+  for (size_t index = 0; index < Width; ++index) {
+    unsigned digit(static_cast<unsigned>(text[index]) - '0');
+    if (digit > 9)
+      return false;
+    value = value * 10 + digit;
+  }
+  return true;
+}
+} // namespace
+
+std::optional<bsky::time_stamp>
+time_stamp_from_rfc_3339(std::string_view date_time) {
+  // YYYY-MM-DDTHH:MM:SS is the minimum, plus 'Z' or offset
+  constexpr size_t DateTimeLength = 19;
+  if (date_time.length() < DateTimeLength + 1)
+    return std::nullopt;
+  const char *text(date_time.data());
+  unsigned year, month, day, hour, minute, second;
+  if (!parse_digits<4>(text, year) || text[4] != '-' ||
+      !parse_digits<2>(text + 5, month) || text[7] != '-' ||
+      !parse_digits<2>(text + 8, day) || (text[10] != 'T' && text[10] != 't') ||
+      !parse_digits<2>(text + 11, hour) || text[13] != ':' ||
+      !parse_digits<2>(text + 14, minute) || text[16] != ':' ||
+      !parse_digits<2>(text + 17, second)) {
+    return std::nullopt;
+  }
+  if (hour > 23 || minute > 59 || second > 59)
+    return std::nullopt;
+  const std::chrono::year_month_day date{
+      std::chrono::year(static_cast<int>(year)), std::chrono::month(month),
+      std::chrono::day(day)};
+  if (!date.ok())
+    return std::nullopt;
+
+  // fraction, millisecond precision kept and the rest truncated
+  size_t position(DateTimeLength);
+  unsigned millis(0);
+  if (text[position] == '.') {
+    ++position;
+    size_t digits(0);
+    while (position < date_time.length()) {
+      unsigned digit(static_cast<unsigned>(text[position]) - '0');
+      if (digit > 9)
+        break;
+      if (digits < 3)
+        millis = millis * 10 + digit;
+      ++digits;
+      ++position;
+    }
+    if (digits == 0)
+      return std::nullopt;
+    for (; digits < 3; ++digits)
+      millis *= 10;
+  }
+
+  // UTC offset
+  std::chrono::minutes offset(0);
+  const size_t remaining(date_time.length() - position);
+  if (remaining == 1 && (text[position] == 'Z' || text[position] == 'z')) {
+    // UTC
+  } else if (remaining == 6 &&
+             (text[position] == '+' || text[position] == '-') &&
+             text[position + 3] == ':') {
+    unsigned offset_hours, offset_minutes;
+    if (!parse_digits<2>(text + position + 1, offset_hours) ||
+        !parse_digits<2>(text + position + 4, offset_minutes) ||
+        offset_hours > 23 || offset_minutes > 59) {
+      return std::nullopt;
+    }
+    offset = std::chrono::hours(offset_hours) +
+             std::chrono::minutes(offset_minutes);
+    if (text[position] == '-')
+      offset = -offset;
+  } else {
+    return std::nullopt;
+  }
+
+  return std::chrono::sys_days(date) + std::chrono::hours(hour) +
+         std::chrono::minutes(minute) + std::chrono::seconds(second) +
+         std::chrono::milliseconds(millis) - offset;
+}
+
 bsky::time_stamp time_stamp_from_iso_8601(std::string const &date_time) {
+  // nearly every firehose time is in the fixed format
+  std::optional<bsky::time_stamp> fast(time_stamp_from_rfc_3339(date_time));
+  if (fast.has_value())
+    return *fast;
+  return time_stamp_from_iso_8601_permissive(date_time);
+}
+
+// Parse ISO8601 time permissively
+bsky::time_stamp
+time_stamp_from_iso_8601_permissive(std::string const &date_time) {
   std::istringstream is(date_time);
   bsky::parse_time_stamp tp;
   // is >> date::parse<bsky::parse_time_stamp, char>(UtcDefault, tp);
@@ -136,6 +232,34 @@ bsky::time_stamp time_stamp_from_iso_8601(std::string const &date_time) {
 
 namespace atproto {
 
+std::string binary_cid::to_string() const {
+  if (is_v0()) {
+    // v0 has no version or codec on the wire, multihash is 0x12 0x20 digest
+    Multiformats::Cid cid({0}, {0x20}, {_bytes.cbegin() + 2,
+                                        _bytes.cbegin() + _length});
+    return cid.to_string(Multiformats::Multibase::Protocol::Base32);
+  }
+  // multibase prefix then RFC 4648 lower case base32, no padding
+  constexpr const char *Base32Lower = "abcdefghijklmnopqrstuvwxyz234567";
+  std::string result;
+  result.reserve(1 + (_length * 8 + 4) / 5);
+  result.push_back('b');
+  uint32_t buffer(0);
+  int bits(0);
+  for (size_t index = 0; index < _length; ++index) {
+    buffer = (buffer << 8) | _bytes[index];
+    bits += 8;
+    while (bits >= 5) {
+      result.push_back(Base32Lower[(buffer >> (bits - 5)) & 0x1F]);
+      bits -= 5;
+    }
+  }
+  if (bits > 0) {
+    result.push_back(Base32Lower[(buffer << (5 - bits)) & 0x1F]);
+  }
+  return result;
+}
+
 at_uri::at_uri(std::string const &uri_str) {
   if (uri_str.empty()) {
     _empty = true;
@@ -50,6 +50,12 @@ bool init_logging(std::string const &log_file, std::string const &project_name,
 
 void stop_logging() {
   if (logger_started) {
+    // counts from throttled sites that have gone quiet since their last log
+    log_limiter::report_suppressed(
+        [](log_limiter::site const &where, const uint64_t suppressed) {
+          logger->info("suppressed {} messages from {}:{}", suppressed,
+                       where._file, where._line);
+        });
     // make sure all logs are output
     logger->flush();
   }
@@ -38,8 +38,8 @@ void metrics_factory::set_config(std::shared_ptr<config> &settings,
   _exposer->RegisterCollectable(_registry);
 }
 
-void metrics_factory::add_counter(std::string const &name,
-                                  std::string const &help) {
+prometheus::Family<prometheus::Counter> &
+metrics_factory::add_counter(std::string const &name, std::string const &help) {
   auto &counter(
       prometheus::BuildCounter().Name(name).Help(help).Register(*_registry));
   if (!_counters.insert({name, {help, counter}}).second) {
@@ -47,10 +47,11 @@ void metrics_factory::add_counter(std::string const &name,
     REL_ERROR(error);
     throw std::invalid_argument(error.c_str());
   }
+  return counter;
 }
 
-void metrics_factory::add_gauge(std::string const &name,
-                                std::string const &help) {
+prometheus::Family<prometheus::Gauge> &
+metrics_factory::add_gauge(std::string const &name, std::string const &help) {
   auto &gauge(
       prometheus::BuildGauge().Name(name).Help(help).Register(*_registry));
   if (!_gauges.insert({name, {help, gauge}}).second) {
@@ -58,10 +59,12 @@ void metrics_factory::add_gauge(std::string const &name,
     REL_ERROR(error);
     throw std::invalid_argument(error.c_str());
   }
+  return gauge;
 }
 
-void metrics_factory::add_histogram(std::string const &name,
-                                    std::string const &help) {
+prometheus::Family<prometheus::Histogram> &
+metrics_factory::add_histogram(std::string const &name,
+                               std::string const &help) {
   auto &histogram(
       prometheus::BuildHistogram().Name(name).Help(help).Register(*_registry));
   if (!_histograms.insert({name, {help, histogram}}).second) {
@@ -69,6 +72,7 @@ void metrics_factory::add_histogram(std::string const &name,
     REL_ERROR(error);
     throw std::invalid_argument(error.c_str());
   }
+  return histogram;
 }
 
 prometheus::Family<prometheus::Counter> &
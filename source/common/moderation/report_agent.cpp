@@ -79,6 +79,8 @@ void report_agent::start(YAML::Node const &settings,
               .get_gauge("process_operation")
               .Get({{"report_agent", "backlog"}})
               .Decrement();
+          pipeline::stage_timer::instance().record(
+              pipeline::stage::report_agent, report._ingested);
 
           // Track all reported accounts
           if (bsky::moderation::ozone_adapter::instance().track_account(
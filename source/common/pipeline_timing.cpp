@@ -0,0 +1,72 @@
+/*************************************************************************
+Public Education Forum Moderation Firehose Client
+Copyright (c) Steve Townsend 2026
+
+>>> SOURCE LICENSE >>>
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation (www.fsf.org); either version 3 of the
+License, or (at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+A copy of the GNU General Public License is available at
+http://www.fsf.org/licensing/licenses
+>>> END OF LICENSE >>>
+*************************************************************************/
+
+#include "common/pipeline_timing.hpp"
+#include "common/metrics_factory.hpp"
+
+namespace pipeline {
+
+const prometheus::Histogram::BucketBoundaries stage_timer::LatencyBuckets = {
+    1, 5, 10, 25, 50, 100, 250, 500, 1000, 5000, 30000, 120000, 600000};
+
+stage_timer &stage_timer::instance() {
+  static stage_timer my_instance;
+  return my_instance;
+}
+
+void stage_timer::register_metrics() {
+  metrics_factory::instance().add_histogram(
+      "pipeline_latency",
+      "Milliseconds from firehose frame receipt to pipeline stage");
+  metrics_factory::instance().add_gauge(
+      "firehose_lag", "Milliseconds from firehose message time to processing");
+  auto &latency(metrics_factory::instance().get_histogram("pipeline_latency"));
+  _latency[static_cast<size_t>(stage::post_processor)] =
+      &latency.Add({{"stage", "post_processor"}}, LatencyBuckets);
+  _latency[static_cast<size_t>(stage::event_recorder)] =
+      &latency.Add({{"stage", "event_recorder"}}, LatencyBuckets);
+  _latency[static_cast<size_t>(stage::action_router)] =
+      &latency.Add({{"stage", "action_router"}}, LatencyBuckets);
+  _latency[static_cast<size_t>(stage::report_agent)] =
+      &latency.Add({{"stage", "report_agent"}}, LatencyBuckets);
+  _latency[static_cast<size_t>(stage::list_manager)] =
+      &latency.Add({{"stage", "list_manager"}}, LatencyBuckets);
+  _lag = &metrics_factory::instance().get_gauge("firehose_lag").Add({});
+}
+
+void stage_timer::record(const stage this_stage, const ingest_time ingested) {
+  prometheus::Histogram *histogram(_latency[static_cast<size_t>(this_stage)]);
+  if (!histogram || ingested == ingest_time())
+    return;
+  histogram->Observe(static_cast<double>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() -
+                                                            ingested)
+          .count()));
+}
+
+void stage_timer::record_lag(const bsky::time_stamp emitted_at) {
+  int64_t lag_ms((bsky::current_time() - emitted_at).count());
+  _lag_ms.store(lag_ms, std::memory_order_relaxed);
+  if (_lag) {
+    _lag->Set(static_cast<double>(lag_ms));
+  }
+}
+
+} // namespace pipeline